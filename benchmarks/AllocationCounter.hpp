@@ -0,0 +1,18 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Counts heap allocations made by the benchmark process, so the
+ * benchmarks can report allocations per record.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace jpi_edm::bench {
+
+/// Number of calls to the global operator new since the process started
+std::uint64_t allocationCount();
+
+} // namespace jpi_edm::bench
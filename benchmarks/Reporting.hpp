@@ -0,0 +1,24 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Counters the benchmarks report alongside their timings.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace jpi_edm::bench {
+
+/// Report records/s, records per iteration and heap allocations per record
+inline void reportPerRecord(benchmark::State &state, std::uint64_t records, std::uint64_t allocations)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(records));
+    state.counters["records"] = static_cast<double>(records) / static_cast<double>(state.iterations());
+    state.counters["allocs/record"] = records ? static_cast<double>(allocations) / static_cast<double>(records) : 0.0;
+}
+
+} // namespace jpi_edm::bench
@@ -0,0 +1,145 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief The sample files the benchmarks run against.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ByteReader.hpp"
+#include "FlightFile.hpp"
+#include "MappedFile.hpp"
+#include "SampleFiles.hpp"
+
+namespace jpi_edm::bench {
+
+namespace {
+
+std::string headerLine(const std::string &payload)
+{
+    unsigned int checksum = 0;
+    for (unsigned char ch : payload) {
+        checksum ^= ch;
+    }
+    std::ostringstream line;
+    line << '$' << payload << '*' << std::uppercase << std::setfill('0') << std::setw(2) << std::hex
+         << (checksum & 0xFF) << "\r\n";
+    return line.str();
+}
+
+// Rewrite the flight number at the start of a flight header, and the
+// header's checksum byte after it, keeping whichever checksum style the
+// original used.
+void renumberFlightHeader(uint8_t *header, std::size_t headerSize, unsigned int flightNumber)
+{
+    BinaryChecksum before;
+    before.add(header, headerSize);
+    bool usesSum = header[headerSize] == static_cast<uint8_t>(-before.sum);
+
+    header[0] = static_cast<uint8_t>(flightNumber >> 8);
+    header[1] = static_cast<uint8_t>(flightNumber & 0xff);
+
+    BinaryChecksum after;
+    after.add(header, headerSize);
+    header[headerSize] = usesSum ? static_cast<uint8_t>(-after.sum) : after.xorSum;
+}
+
+void buildEnlargedSample(const std::string &source, int copies, const std::string &dest)
+{
+    auto file = FlightFile::open(source);
+    FlightFile parser;
+    auto index = parser.buildFlightIndex(file);
+    if (index.empty()) {
+        throw std::runtime_error("No flights to enlarge in " + source);
+    }
+    const uint8_t *bytes = file.data();
+    auto flightsStart = static_cast<std::size_t>(index.front().headerOffset);
+    auto flightsEnd = static_cast<std::size_t>(index.back().endOffset);
+
+    unsigned int firstNumber = static_cast<unsigned int>(index.front().flightNumber);
+    if (firstNumber + index.size() * static_cast<std::size_t>(copies) > 0xffff) {
+        throw std::runtime_error("Too many copies for 16-bit flight numbers");
+    }
+
+    // The ASCII headers, with the $D records repeated for every copy
+    std::vector<long> dataWords;
+    std::string headers;
+    std::istringstream lines(std::string(reinterpret_cast<const char *>(bytes), flightsStart));
+    std::string line;
+    bool wroteFlights = false;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 2, "$D") != 0) {
+            headers += line + "\n";
+            continue;
+        }
+        dataWords.push_back(std::stol(line.substr(line.find(',', line.find(',') + 1) + 1)));
+        if (!wroteFlights && dataWords.size() == index.size()) {
+            unsigned int number = firstNumber;
+            for (int copy = 0; copy < copies; ++copy) {
+                for (long words : dataWords) {
+                    headers += headerLine("D, " + std::to_string(number++) + ", " + std::to_string(words));
+                }
+            }
+            wroteFlights = true;
+        }
+    }
+
+    std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+    out << headers;
+    unsigned int number = firstNumber;
+    std::vector<uint8_t> block(bytes + flightsStart, bytes + flightsEnd);
+    for (int copy = 0; copy < copies; ++copy) {
+        for (const auto &entry : index) {
+            auto headerStart = static_cast<std::size_t>(entry.headerOffset) - flightsStart;
+            auto headerSize = static_cast<std::size_t>(entry.dataOffset - entry.headerOffset) - 1;
+            renumberFlightHeader(block.data() + headerStart, headerSize, number++);
+        }
+        out.write(reinterpret_cast<const char *>(block.data()), static_cast<std::streamsize>(block.size()));
+    }
+    auto footerSize = static_cast<std::streamsize>(file.size() - flightsEnd);
+    out.write(reinterpret_cast<const char *>(bytes + flightsEnd), footerSize);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write " + dest);
+    }
+}
+
+} // namespace
+
+std::string samplePath(const std::string &name) { return std::string(JPIEDM_SAMPLE_DIR) + "/" + name; }
+
+std::string enlargedSamplePath(const std::string &name, int copies)
+{
+    static std::map<std::pair<std::string, int>, std::string> built;
+    auto &path = built[{name, copies}];
+    if (path.empty()) {
+        auto dest = std::filesystem::temp_directory_path() / ("jpiedm_bench_" + std::to_string(copies) + "x_" + name);
+        buildEnlargedSample(samplePath(name), copies, dest.string());
+        path = dest.string();
+    }
+    return path;
+}
+
+std::string generatedSamplePath(const std::string &name, const edmgen::GeneratorOptions &options)
+{
+    static std::map<std::string, std::string> built;
+    auto &path = built[name];
+    if (path.empty()) {
+        auto dest = std::filesystem::temp_directory_path() / ("jpiedm_bench_generated_" + name + ".jpi");
+        edmgen::EdmGenerator(options).writeFile(dest.string());
+        path = dest.string();
+    }
+    return path;
+}
+
+} // namespace jpi_edm::bench
@@ -0,0 +1,34 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief The sample files the benchmarks run against.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "EdmGenerator.hpp"
+
+namespace jpi_edm::bench {
+
+/// Path to one of the tests/it samples
+std::string samplePath(const std::string &name);
+
+/**
+ * Path to a copy of a tests/it sample whose flights are repeated `copies`
+ * times, renumbered, with the $D headers and flight header checksums
+ * rewritten to match. Written to the temp directory the first time it's asked
+ * for in a run.
+ */
+std::string enlargedSamplePath(const std::string &name, int copies);
+
+/**
+ * Path to a synthetic file written by edmgen::EdmGenerator, for sizes and
+ * mixes of flights the samples don't cover. Written to the temp directory
+ * the first time `name` is asked for in a run.
+ */
+std::string generatedSamplePath(const std::string &name, const edmgen::GeneratorOptions &options);
+
+} // namespace jpi_edm::bench
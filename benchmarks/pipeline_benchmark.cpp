@@ -0,0 +1,296 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Benchmarks for each stage of the parsing pipeline, from the ASCII
+ * headers through to parseedmlog's CSV, on the tests/it samples, on
+ * enlarged copies of them, and on a generated archive with many flights.
+ *
+ * The header parse and flight header size detection are private to
+ * FlightFile, so they're measured through the cheapest public calls that
+ * run them: detectFlights() stops after the headers, and flights() stops
+ * after detecting the header size.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include "AllocationCounter.hpp"
+#include "CsvExporter.hpp"
+#include "EdmGenerator.hpp"
+#include "FlightFile.hpp"
+#include "FlightIterator.hpp"
+#include "MappedFile.hpp"
+#include "Reporting.hpp"
+#include "SampleFiles.hpp"
+
+using namespace jpi_edm;
+
+namespace {
+
+struct Sample {
+    std::string name;
+    int copies{1}; ///< more than 1 means an enlarged copy of the sample
+    std::optional<edmgen::GeneratorOptions> generated{}; ///< set for a generated file, named `name`
+};
+
+MappedFile openSample(const Sample &sample)
+{
+    if (sample.generated) {
+        return FlightFile::open(bench::generatedSamplePath(sample.name, *sample.generated));
+    }
+    if (sample.copies > 1) {
+        return FlightFile::open(bench::enlargedSamplePath(sample.name, sample.copies));
+    }
+    return FlightFile::open(bench::samplePath(sample.name));
+}
+
+// Records in the file, counted once up front so benchmarks that don't see
+// the records can still report per-record figures
+std::uint64_t countRecords(const MappedFile &file)
+{
+    FlightFile parser;
+    std::uint64_t records = 0;
+    for (const auto &entry : parser.buildFlightIndex(file)) {
+        records += entry.recordCount();
+    }
+    return records;
+}
+
+// Throws away whatever is written to it, but only after it's been formatted
+class NullBuffer : public std::streambuf
+{
+  protected:
+    int overflow(int ch) override { return traits_type::not_eof(ch); }
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+void BM_ParseFileHeaders(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    std::uint64_t flights = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        auto info = parser.detectFlights(file);
+        flights += info.size();
+        benchmark::DoNotOptimize(info);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(flights));
+}
+
+void BM_DetectFlightHeaderSize(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    for (auto _ : state) {
+        FlightFile parser;
+        auto range = parser.flights(file);
+        benchmark::DoNotOptimize(range);
+    }
+}
+
+void BM_BuildFlightIndex(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        auto before = bench::allocationCount();
+        for (const auto &entry : parser.buildFlightIndex(file)) {
+            records += entry.recordCount();
+        }
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+void BM_Verify(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        auto before = bench::allocationCount();
+        auto report = parser.verify(file);
+        allocations += bench::allocationCount() - before;
+        for (const auto &flight : report.flights) {
+            records += flight.checksums.recordCount;
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+// Skips every flight but the last by framing, then decodes that one
+void BM_SkipToLastFlight(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    int lastFlight = FlightFile().detectFlights(file).back().flightNumber;
+    for (auto _ : state) {
+        FlightFile parser;
+        parser.processFile(file, lastFlight);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+}
+
+void BM_CallbackApi(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        parser.setFlightRecordCompletionCb([&records](std::shared_ptr<FlightMetricsRecord> rec) {
+            benchmark::DoNotOptimize(rec);
+            ++records;
+        });
+        auto before = bench::allocationCount();
+        parser.processFile(file);
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+void BM_RecordViewApi(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        parser.setFlightRecordViewCb([&records](const FlightRecordView &view) {
+            benchmark::DoNotOptimize(view.metrics());
+            ++records;
+        });
+        auto before = bench::allocationCount();
+        parser.processFile(file);
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+// The view API again, decoding only the engine 1 EGTs and CHTs
+void BM_SelectedMetrics(benchmark::State &state, const Sample &sample)
+{
+    MetricSet selection;
+    for (auto id : {EGT11, EGT12, EGT13, EGT14, CHT11, CHT12, CHT13, CHT14}) {
+        selection.insert(id);
+    }
+    auto file = openSample(sample);
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        parser.setMetricSelection(selection);
+        parser.setFlightRecordViewCb([&records](const FlightRecordView &view) {
+            benchmark::DoNotOptimize(view.metrics());
+            ++records;
+        });
+        auto before = bench::allocationCount();
+        parser.processFile(file);
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+void BM_IteratorApi(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        FlightFile parser;
+        auto before = bench::allocationCount();
+        for (const auto &flight : parser.flights(file)) {
+            for (const auto &rec : flight) {
+                benchmark::DoNotOptimize(rec);
+                ++records;
+            }
+        }
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+void BM_RenderCsv(benchmark::State &state, const Sample &sample)
+{
+    auto file = openSample(sample);
+    auto recordsPerPass = countRecords(file);
+    NullBuffer discard;
+    std::ostream out(&discard);
+    std::uint64_t allocations = 0;
+    for (auto _ : state) {
+        auto before = bench::allocationCount();
+        parseedmlog::csv::printFlightData(file, std::nullopt, out, false);
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, recordsPerPass * state.iterations(), allocations);
+}
+
+const Sample SMALL{"930_6cyl.jpi"};
+const Sample TWIN{"960_4cyl_twin.jpi"};
+const Sample TWIN_X16{"960_4cyl_twin.jpi", 16};
+
+// 200 one-hour flights from a twin with GPS, a tenth of each in fast mode
+edmgen::GeneratorOptions generatedArchive()
+{
+    edmgen::GeneratorOptions options;
+    options.version = V5;
+    options.twin = true;
+    options.gps = true;
+    options.flights = 200;
+    options.fastFraction = 0.1;
+    return options;
+}
+
+const Sample ARCHIVE{"v5_twin_gps_200_flights", 1, generatedArchive()};
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ParseFileHeaders, 930_6cyl, SMALL);
+BENCHMARK_CAPTURE(BM_ParseFileHeaders, 960_4cyl_twin_x16, TWIN_X16);
+BENCHMARK_CAPTURE(BM_ParseFileHeaders, generated_archive, ARCHIVE);
+
+BENCHMARK_CAPTURE(BM_DetectFlightHeaderSize, 930_6cyl, SMALL);
+BENCHMARK_CAPTURE(BM_DetectFlightHeaderSize, 960_4cyl_twin, TWIN);
+
+BENCHMARK_CAPTURE(BM_BuildFlightIndex, 960_4cyl_twin, TWIN);
+BENCHMARK_CAPTURE(BM_BuildFlightIndex, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_BuildFlightIndex, generated_archive, ARCHIVE)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SkipToLastFlight, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SkipToLastFlight, generated_archive, ARCHIVE)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_Verify, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Verify, generated_archive, ARCHIVE)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_CallbackApi, 930_6cyl, SMALL)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CallbackApi, 960_4cyl_twin, TWIN)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CallbackApi, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_RecordViewApi, 930_6cyl, SMALL)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_RecordViewApi, 960_4cyl_twin, TWIN)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_RecordViewApi, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SelectedMetrics, 960_4cyl_twin, TWIN)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SelectedMetrics, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_IteratorApi, 930_6cyl, SMALL)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IteratorApi, 960_4cyl_twin, TWIN)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IteratorApi, 960_4cyl_twin_x16, TWIN_X16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IteratorApi, generated_archive, ARCHIVE)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_RenderCsv, 930_6cyl, SMALL)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_RenderCsv, 960_4cyl_twin, TWIN)->Unit(benchmark::kMillisecond);
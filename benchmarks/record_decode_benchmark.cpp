@@ -0,0 +1,177 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Record decode benchmarks, reporting records/s and heap allocations
+ * per record.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Checksum.hpp"
+#include "Flight.hpp"
+#include "FlightFile.hpp"
+#include "MappedFile.hpp"
+#include "RecordDecoder.hpp"
+#include "Reporting.hpp"
+#include "SampleFiles.hpp"
+
+using namespace jpi_edm;
+
+namespace {
+
+// Parse a whole file, optionally with a (trivial) per-record callback.
+void BM_DecodeFile(benchmark::State &state, const std::string &name, bool withRecordCb)
+{
+    auto file = FlightFile::open(bench::samplePath(name));
+    std::uint64_t records = 0;
+    std::uint64_t allocations = 0;
+
+    for (auto _ : state) {
+        FlightFile parser;
+        parser.setFlightCompletionCb([&](unsigned long stdRecs, unsigned long fastRecs) {
+            records += stdRecs + fastRecs;
+        });
+        if (withRecordCb) {
+            parser.setFlightRecordCompletionCb(
+                [](std::shared_ptr<FlightMetricsRecord> rec) { benchmark::DoNotOptimize(rec); });
+        }
+
+        auto before = bench::allocationCount();
+        parser.processFile(file);
+        allocations += bench::allocationCount() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    bench::reportPerRecord(state, records, allocations);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_DecodeFile, 930_6cyl, std::string("930_6cyl.jpi"), false);
+BENCHMARK_CAPTURE(BM_DecodeFile, 960_4cyl_twin, std::string("960_4cyl_twin.jpi"), false);
+BENCHMARK_CAPTURE(BM_DecodeFile, 960_4cyl_twin_with_record_cb, std::string("960_4cyl_twin.jpi"), true);
+
+namespace {
+
+// One record's worth of deltas touching every field the protocol version maps.
+std::map<int, int> sampleRecordValues(const Flight &flight)
+{
+    std::map<int, int> values;
+    int delta = 1;
+    for (const auto &[bitIdx, metric] : flight.m_bit2MetricMap) {
+        values[bitIdx] = (delta % 2) ? delta : -delta;
+        ++delta;
+    }
+    return values;
+}
+
+std::shared_ptr<Metadata> sampleMetadata()
+{
+    auto metadata = std::make_shared<Metadata>();
+    metadata->m_configInfo.edm_model = 930;
+    metadata->m_configInfo.firmware_version = 200;
+    metadata->m_configInfo.numCylinders = 6;
+    metadata->m_protoHeader.value = 2;
+    return metadata;
+}
+
+// The way records used to be handed to updateMetrics: a fresh std::map per record.
+void BM_UpdateMetrics_Map(benchmark::State &state)
+{
+    Flight flight(sampleMetadata());
+    auto sample = sampleRecordValues(flight);
+    std::uint64_t allocations = 0;
+
+    for (auto _ : state) {
+        auto before = bench::allocationCount();
+        std::map<int, int> values;
+        for (const auto &[bitIdx, value] : sample) {
+            values[bitIdx] = value;
+        }
+        flight.updateMetrics(values);
+        allocations += bench::allocationCount() - before;
+    }
+    bench::reportPerRecord(state, state.iterations(), allocations);
+}
+
+void BM_UpdateMetrics_Deltas(benchmark::State &state)
+{
+    Flight flight(sampleMetadata());
+    auto sample = sampleRecordValues(flight);
+    std::uint64_t allocations = 0;
+
+    for (auto _ : state) {
+        auto before = bench::allocationCount();
+        RecordDeltas deltas;
+        for (const auto &[bitIdx, value] : sample) {
+            deltas.set(bitIdx, value);
+        }
+        flight.updateMetrics(deltas);
+        allocations += bench::allocationCount() - before;
+    }
+    bench::reportPerRecord(state, state.iterations(), allocations);
+}
+
+} // namespace
+
+BENCHMARK(BM_UpdateMetrics_Map);
+BENCHMARK(BM_UpdateMetrics_Deltas);
+
+namespace {
+
+// Just the record decoder: field and sign maps and values, without accumulating
+// anything into a Flight. Records are found from the flight index.
+void BM_DecodeRecords(benchmark::State &state, const std::string &name)
+{
+    auto file = FlightFile::open(bench::samplePath(name));
+    FlightFile parser;
+    auto index = parser.buildFlightIndex(file);
+    std::uint64_t records = 0;
+    RecordDeltas values;
+
+    for (auto _ : state) {
+        for (const auto &entry : index) {
+            const RecordCodec &codec = recordCodec(entry.recordMaskSize);
+            auto pos = static_cast<std::size_t>(entry.dataOffset);
+            while (pos < static_cast<std::size_t>(entry.endOffset)) {
+                pos += codec.decode(file.data() + pos, file.size() - pos, records, values).length;
+                benchmark::DoNotOptimize(values);
+                ++records;
+            }
+        }
+    }
+    bench::reportPerRecord(state, records, 0);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_DecodeRecords, 930_6cyl, std::string("930_6cyl.jpi"));
+BENCHMARK_CAPTURE(BM_DecodeRecords, 960_4cyl_twin, std::string("960_4cyl_twin.jpi"));
+
+namespace {
+
+// Checksums state.range(0) bytes at a time, with the dispatched kernel or the scalar loop
+void BM_SumBytes(benchmark::State &state, bool vectorized)
+{
+    std::vector<uint8_t> data(static_cast<std::size_t>(state.range(0)));
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    for (auto _ : state) {
+        auto sums = vectorized ? sumBytes(data.data(), data.size()) : sumBytesScalar(data.data(), data.size());
+        benchmark::DoNotOptimize(sums);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+    state.SetLabel(vectorized ? sumBytesKernel() : "scalar");
+}
+
+} // namespace
+
+// 40 bytes is a typical data record, 28 the largest flight header, 64K a whole flight
+BENCHMARK_CAPTURE(BM_SumBytes, scalar, false)->Arg(28)->Arg(40)->Arg(64 << 10);
+BENCHMARK_CAPTURE(BM_SumBytes, dispatched, true)->Arg(28)->Arg(40)->Arg(64 << 10);
@@ -0,0 +1,626 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Writes synthetic EDM files, for testing and benchmarking the parser
+ * on files much larger than the real samples.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "ByteReader.hpp"
+#include "EdmGenerator.hpp"
+#include "FileHeaders.hpp"
+#include "Metrics.hpp"
+#include "ProtocolConstants.hpp"
+
+using namespace jpi_edm;
+
+namespace edmgen {
+
+namespace {
+
+// $C flag bits, as FileHeaders.cpp reads them
+constexpr uint32_t FLAG_BATTERY = 0x00000001;
+constexpr uint32_t FLAG_FIRST_CHT = 0x00000004;
+constexpr uint32_t FLAG_FIRST_EGT = 0x00000800;
+constexpr uint32_t FLAG_OIL = 0x00100000;
+constexpr uint32_t FLAG_OAT = 0x02000000;
+constexpr uint32_t FLAG_RPM = 0x04000000;
+constexpr uint32_t FLAG_FF = 0x08000000;
+constexpr uint32_t FLAG_TEMP_IN_F = 0x10000000;
+constexpr uint32_t FLAG_MAP = 0x40000000;
+
+// Where the flights start, in the units the flight headers use (1/6000 degree)
+constexpr int32_t START_LAT = 225720;  // 37.62 N
+constexpr int32_t START_LNG = -734220; // 122.37 W
+
+// The handshake delta that sets a LAT/LNG baseline, see Flight::updateMetrics()
+constexpr int GPS_BASELINE_DELTA = 100;
+
+constexpr std::time_t SECONDS_BETWEEN_FLIGHTS = 60 * 60;
+
+// How each simulated metric behaves, in raw (unscaled) units
+struct MetricSpec {
+    MetricId metricId;
+    int start; // where the walk heads for first
+    int low;
+    int high;
+    int step;
+    bool increasing{false};
+};
+
+// clang-format off
+const MetricSpec METRIC_SPECS[] = {
+    {EGT11, 1300, 1200, 1500, 12}, {EGT12, 1310, 1200, 1500, 12}, {EGT13, 1290, 1200, 1500, 12},
+    {EGT14, 1320, 1200, 1500, 12}, {EGT15, 1280, 1200, 1500, 12}, {EGT16, 1305, 1200, 1500, 12},
+    {EGT17, 1295, 1200, 1500, 12}, {EGT18, 1315, 1200, 1500, 12}, {EGT19, 1285, 1200, 1500, 12},
+    {CHT11, 350, 300, 420, 3}, {CHT12, 355, 300, 420, 3}, {CHT13, 345, 300, 420, 3},
+    {CHT14, 360, 300, 420, 3}, {CHT15, 340, 300, 420, 3}, {CHT16, 352, 300, 420, 3},
+    {CHT17, 348, 300, 420, 3}, {CHT18, 358, 300, 420, 3}, {CHT19, 342, 300, 420, 3},
+    {EGT21, 1300, 1200, 1500, 12}, {EGT22, 1310, 1200, 1500, 12}, {EGT23, 1290, 1200, 1500, 12},
+    {EGT24, 1320, 1200, 1500, 12}, {EGT25, 1280, 1200, 1500, 12}, {EGT26, 1305, 1200, 1500, 12},
+    {EGT27, 1295, 1200, 1500, 12}, {EGT28, 1315, 1200, 1500, 12}, {EGT29, 1285, 1200, 1500, 12},
+    {CHT21, 350, 300, 420, 3}, {CHT22, 355, 300, 420, 3}, {CHT23, 345, 300, 420, 3},
+    {CHT24, 360, 300, 420, 3}, {CHT25, 340, 300, 420, 3}, {CHT26, 352, 300, 420, 3},
+    {CHT27, 348, 300, 420, 3}, {CHT28, 358, 300, 420, 3}, {CHT29, 342, 300, 420, 3},
+    {OILT1, 185, 170, 210, 1}, {OILT2, 188, 170, 210, 1},
+    {OILP1, 60, 50, 75, 1},    {OILP2, 62, 50, 75, 1},
+    {MAP1, 245, 150, 300, 3},  {MAP2, 245, 150, 300, 3},
+    {RPM1, 2400, 2100, 2700, 20}, {RPM2, 2400, 2100, 2700, 20},
+    {FF11, 125, 80, 180, 3},   {FF21, 125, 80, 180, 3},
+    {FUSD11, 0, 0, 10000, 1, true}, {FUSD21, 0, 0, 10000, 1, true},
+    {HP1, 65, 40, 85, 1},
+    {VOLT1, 141, 135, 145, 1},
+    {OAT, 45, 20, 70, 1},
+};
+
+const MetricSpec GPS_SPECS[] = {
+    {ALT, 4500, 3500, 8500, 20},
+    {SPD, 140, 100, 170, 2},
+    {LAT, 0, -600000, 600000, 3},
+    {LNG, 0, -600000, 600000, 3},
+};
+
+const MetricId ENGINE1_CYLINDERS[][MAX_CYLINDERS_PER_ENGINE] = {
+    {EGT11, EGT12, EGT13, EGT14, EGT15, EGT16, EGT17, EGT18, EGT19},
+    {CHT11, CHT12, CHT13, CHT14, CHT15, CHT16, CHT17, CHT18, CHT19},
+};
+
+const MetricId ENGINE2_CYLINDERS[][MAX_CYLINDERS_PER_ENGINE] = {
+    {EGT21, EGT22, EGT23, EGT24, EGT25, EGT26, EGT27, EGT28, EGT29},
+    {CHT21, CHT22, CHT23, CHT24, CHT25, CHT26, CHT27, CHT28, CHT29},
+};
+// clang-format on
+
+// Which cylinder (1-based) a metric belongs to, or 0 if it isn't per cylinder
+int cylinderOf(MetricId metricId)
+{
+    for (const auto *table : {ENGINE1_CYLINDERS, ENGINE2_CYLINDERS}) {
+        for (int row = 0; row < 2; ++row) {
+            for (int cyl = 0; cyl < MAX_CYLINDERS_PER_ENGINE; ++cyl) {
+                if (table[row][cyl] == metricId) {
+                    return cyl + 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+const char *versionName(EDMVersion version)
+{
+    switch (version) {
+    case V1:
+        return "V1";
+    case V2:
+        return "V2";
+    case V3:
+        return "V3";
+    case V4:
+        return "V4";
+    case V5:
+        return "V5";
+    }
+    return "unknown";
+}
+
+std::string headerLine(const std::string &payload)
+{
+    unsigned int checksum = 0;
+    for (unsigned char ch : payload) {
+        checksum ^= ch;
+    }
+    std::ostringstream line;
+    line << '$' << payload << '*' << std::uppercase << std::setfill('0') << std::setw(2) << std::hex
+         << (checksum & BYTE_MASK) << "\r\n";
+    return line.str();
+}
+
+std::tm utcTime(std::time_t time)
+{
+    std::tm result{};
+#ifdef _WIN32
+    gmtime_s(&result, &time);
+#else
+    gmtime_r(&time, &result);
+#endif
+    return result;
+}
+
+// Whether decoding would be in fast mode for record `recordIdx`. Each cycle
+// is a stretch of standard records followed by fastRunLength fast ones.
+struct FastSchedule {
+    unsigned long stdRun{0};
+    unsigned long fastRun{0};
+
+    FastSchedule(double fraction, unsigned long runLength)
+    {
+        if (fraction <= 0.0) {
+            stdRun = 1;
+        } else {
+            fastRun = runLength;
+            stdRun = static_cast<unsigned long>(static_cast<double>(runLength) * (1.0 - fraction) / fraction + 0.5);
+        }
+    }
+
+    [[nodiscard]] bool isFast(unsigned long recordIdx) const
+    {
+        return fastRun > 0 && recordIdx % (stdRun + fastRun) >= stdRun;
+    }
+
+    [[nodiscard]] unsigned long fastCount(unsigned long records) const
+    {
+        if (fastRun == 0) {
+            return 0;
+        }
+        unsigned long cycle = stdRun + fastRun;
+        unsigned long rest = records % cycle;
+        return (records / cycle) * fastRun + (rest > stdRun ? rest - stdRun : 0);
+    }
+};
+
+// Random numbers that come out the same on every platform, unlike the
+// standard distributions
+class Random
+{
+  public:
+    explicit Random(std::uint64_t seed) : m_engine(seed) {}
+
+    /// 0 to bound - 1
+    unsigned long below(unsigned long bound) { return static_cast<unsigned long>(m_engine() % bound); }
+
+    /// -range to range
+    int within(int range) { return static_cast<int>(below(2 * static_cast<unsigned long>(range) + 1)) - range; }
+
+  private:
+    std::mt19937_64 m_engine;
+};
+
+// One record's field values before they're packed
+struct RecordFields {
+    std::bitset<MAX_METRIC_FIELDS> present;
+    std::bitset<MAX_METRIC_FIELDS> negative;
+    std::array<uint8_t, MAX_METRIC_FIELDS> magnitude{};
+
+    void set(int bitIdx, int magnitudeValue, bool isNegative)
+    {
+        present.set(bitIdx);
+        negative.set(bitIdx, isNegative);
+        magnitude[bitIdx] = static_cast<uint8_t>(magnitudeValue);
+    }
+};
+
+// Appends bytes followed by their checksum. Always the negated sum, as in
+// the real files: the XOR of a header, its checksum and the start of a
+// record, whose population map is repeated, would also look like the XOR of
+// a larger header, and the parser would detect the wrong header size.
+class ChecksumWriter
+{
+  public:
+    explicit ChecksumWriter(std::vector<uint8_t> &bytes) : m_bytes(bytes) {}
+
+    void put(uint8_t byte)
+    {
+        m_bytes.push_back(byte);
+        m_checksum.add(byte);
+    }
+
+    void finish() { m_bytes.push_back(static_cast<uint8_t>(-m_checksum.sum)); }
+
+  private:
+    std::vector<uint8_t> &m_bytes;
+    BinaryChecksum m_checksum;
+};
+
+// Pack a data record the way decodeRecord() reads it, with population maps
+// maskSize bytes wide
+void putRecord(std::vector<uint8_t> &bytes, const RecordFields &fields, int maskSize)
+{
+    ChecksumWriter out(bytes);
+    const int mapBytes = maskSize * BITS_PER_BYTE;
+
+    std::array<uint8_t, RECORD_MASK_SIZE * BITS_PER_BYTE> fieldBytes{};
+    std::array<uint8_t, RECORD_MASK_SIZE * BITS_PER_BYTE> signBytes{};
+    uint16_t popMap = 0;
+    for (int bitIdx = 0; bitIdx < MAX_METRIC_FIELDS; ++bitIdx) {
+        if (fields.present[bitIdx]) {
+            int byteIdx = bitIdx / BITS_PER_BYTE;
+            fieldBytes[byteIdx] |= static_cast<uint8_t>(1 << (bitIdx % BITS_PER_BYTE));
+            if (fields.negative[bitIdx]) {
+                signBytes[byteIdx] |= static_cast<uint8_t>(1 << (bitIdx % BITS_PER_BYTE));
+            }
+            popMap |= static_cast<uint16_t>(1 << byteIdx);
+        }
+    }
+
+    for (int copy = 0; copy < 2; ++copy) {
+        if (maskSize == RECORD_MASK_SIZE) {
+            out.put(static_cast<uint8_t>(popMap >> 8));
+        }
+        out.put(static_cast<uint8_t>(popMap & BYTE_MASK));
+    }
+    out.put(0); // repeat count
+    for (int i = 0; i < mapBytes; ++i) {
+        if (popMap & (1 << i)) {
+            out.put(fieldBytes[i]);
+        }
+    }
+    for (int i = 0; i < mapBytes; ++i) {
+        if ((popMap & (1 << i)) && i != EGT_HIGHBYTE_IDX_1 && i != EGT_HIGHBYTE_IDX_2) {
+            out.put(signBytes[i]);
+        }
+    }
+    for (int bitIdx = 0; bitIdx < MAX_METRIC_FIELDS; ++bitIdx) {
+        if (fields.present[bitIdx]) {
+            out.put(fields.magnitude[bitIdx]);
+        }
+    }
+    out.finish();
+}
+
+bool checksumMatches(const uint8_t *bytes, std::size_t length)
+{
+    BinaryChecksum checksum;
+    checksum.add(bytes, length);
+    return checksum.matches(bytes[length]);
+}
+
+} // namespace
+
+EdmGenerator::EdmGenerator(const GeneratorOptions &options) : m_options(options)
+{
+    std::stringstream msg;
+    bool isTwinVersion = (options.version == V2 || options.version == V5);
+    if (options.version == V3) {
+        msg << "No EDM model reports itself as " << versionName(options.version);
+    } else if (options.twin != isTwinVersion) {
+        msg << versionName(options.version) << " recorders are " << (isTwinVersion ? "twin" : "single")
+            << " engine only";
+    } else if (options.gps && !(options.version == V4 || options.version == V5)) {
+        msg << versionName(options.version) << " recorders don't log GPS data";
+    } else if (options.cylinders < 1 || options.cylinders > ConfigInfo::MAX_CYLS) {
+        msg << "Cylinder count must be 1 to " << ConfigInfo::MAX_CYLS;
+    } else if (options.flights < 0 ||
+               options.firstFlightNumber + static_cast<unsigned long>(options.flights) > 0x10000UL) {
+        msg << "Flight numbers have to fit in 16 bits";
+    } else if (options.recordsPerFlight < 1) {
+        msg << "Flights need at least one record";
+    } else if (!(options.fastFraction >= 0.0 && options.fastFraction <= 1.0) || options.fastRunLength < 1) {
+        msg << "Fast fraction must be 0 to 1, with runs of at least one record";
+    } else if (options.interval < 1 || options.interval > 0xFFFF) {
+        msg << "Record interval must be 1 to 65535 seconds";
+    }
+    if (!msg.str().empty()) {
+        throw std::invalid_argument(msg.str());
+    }
+
+    m_configFlags = FLAG_BATTERY | FLAG_OIL | FLAG_OAT | FLAG_RPM | FLAG_FF | FLAG_TEMP_IN_F | FLAG_MAP;
+    for (int cyl = 0; cyl < options.cylinders; ++cyl) {
+        m_configFlags |= (FLAG_FIRST_CHT << cyl) | (FLAG_FIRST_EGT << cyl);
+    }
+    unsigned long flagsLow = m_configFlags & CONFIG_FLAGS_LOWER_16_BITS_MASK;
+    unsigned long flagsHigh = m_configFlags >> 16;
+
+    // A representative model, firmware and build for each version
+    switch (options.version) {
+    case V1:
+        m_configValues = {830, flagsLow, flagsHigh, 1536, 24802, 340};
+        break;
+    case V2:
+        m_configValues = {EDM_MODEL_760_TWIN, flagsLow, flagsHigh, 1552, 281};
+        break;
+    case V4:
+        m_configValues = {930, flagsLow, flagsHigh, 1560, 16610, 123, 140, 2011, 6};
+        m_hasProtoHeader = true;
+        break;
+    default:
+        m_configValues = {EDM_MODEL_960_TWIN, flagsLow, flagsHigh, 1056, 16610, 120, 140, 2014, 5};
+        m_hasProtoHeader = true;
+        break;
+    }
+
+    // Work out the flight header size the way the parser expects it
+    Metadata metadata;
+    metadata.m_configInfo.apply(m_configValues);
+    metadata.m_protoHeader.value = m_hasProtoHeader ? 2 : 0;
+    m_recordMaskSize = metadata.RecordMaskSize();
+    switch (metadata.GuessFlightHeaderVersion()) {
+    case HEADER_V1:
+        m_flightHeaderSize = MIN_FLIGHT_HEADER_SIZE;
+        break;
+    case HEADER_V2:
+        m_flightHeaderSize = MIN_FLIGHT_HEADER_SIZE + 2 * 2;
+        break;
+    case HEADER_V3:
+        m_flightHeaderSize = MIN_FLIGHT_HEADER_SIZE + 3 * 2;
+        break;
+    case HEADER_V4:
+        m_flightHeaderSize = MAX_FLIGHT_HEADER_SIZE;
+        break;
+    }
+
+    // Every metric the version records that we have a simulation for
+    const auto &bitMap = Metrics::getBitToMetricMap(options.version);
+    auto findMetric = [&bitMap](MetricId metricId) -> const Metric * {
+        for (const auto &[bitIdx, metric] : bitMap) {
+            if (metric.getMetricId() == metricId) {
+                return &metric;
+            }
+        }
+        return nullptr;
+    };
+    auto addChannel = [&](const MetricSpec &spec) {
+        const Metric *metric = findMetric(spec.metricId);
+        if (!metric) {
+            return;
+        }
+        int cylinder = cylinderOf(spec.metricId);
+        if (cylinder > options.cylinders || (!options.twin && Metrics::isSecondEngineMetric(spec.metricId))) {
+            return;
+        }
+        Channel channel;
+        channel.metricId = spec.metricId;
+        channel.lowBitIdx = metric->getLowByteBitIdx();
+        channel.highBitIdx = metric->getHighByteBitIdx().value_or(-1);
+        channel.initialValue = static_cast<int>(metric->getInitialValue());
+        channel.low = spec.low;
+        channel.high = spec.high;
+        channel.step = spec.step;
+        channel.increasing = spec.increasing;
+        m_channels.push_back(channel);
+    };
+    for (int cyl = 0; cyl < options.cylinders; ++cyl) {
+        for (const auto *table : {ENGINE1_CYLINDERS, ENGINE2_CYLINDERS}) {
+            if (table == ENGINE2_CYLINDERS && !options.twin) {
+                continue;
+            }
+            for (int row = 0; row < 2; ++row) {
+                if (!findMetric(table[row][cyl])) {
+                    msg << versionName(options.version) << " recorders only log " << cyl << " cylinders per engine";
+                    throw std::invalid_argument(msg.str());
+                }
+            }
+        }
+    }
+    for (const auto &spec : METRIC_SPECS) {
+        addChannel(spec);
+    }
+    if (options.gps) {
+        for (const auto &spec : GPS_SPECS) {
+            addChannel(spec);
+        }
+    }
+
+    // The flight plan: numbers, start times and record counts
+    FastSchedule schedule(options.fastFraction, options.fastRunLength);
+    std::time_t startTime = options.startTime;
+    for (int i = 0; i < options.flights; ++i) {
+        GeneratedFlight flight;
+        flight.flightNumber = options.firstFlightNumber + static_cast<unsigned int>(i);
+        flight.startTime = startTime;
+        flight.fastRecCount = schedule.fastCount(options.recordsPerFlight);
+        flight.stdRecCount = options.recordsPerFlight - flight.fastRecCount;
+        m_flights.push_back(flight);
+
+        startTime += static_cast<std::time_t>(flight.stdRecCount) * options.interval +
+                     static_cast<std::time_t>(flight.fastRecCount) + SECONDS_BETWEEN_FLIGHTS;
+    }
+}
+
+std::vector<uint8_t> EdmGenerator::generateFlight(std::size_t flightIdx) const
+{
+    const GeneratedFlight &plan = m_flights[flightIdx];
+    Random random(m_options.seed * 0x9E3779B97F4A7C15ULL + flightIdx);
+    FastSchedule schedule(m_options.fastFraction, m_options.fastRunLength);
+
+    // The records first, since the header may need adjusting to suit them
+    std::vector<uint8_t> records;
+    std::vector<int> values;
+    for (const auto &channel : m_channels) {
+        values.push_back(channel.metricId == LAT || channel.metricId == LNG ? 0 : channel.initialValue);
+    }
+    bool wasFast = false;
+    for (unsigned long recordIdx = 0; recordIdx < m_options.recordsPerFlight; ++recordIdx) {
+        RecordFields fields;
+
+        bool isFast = schedule.isFast(recordIdx);
+        if (isFast != wasFast) {
+            fields.set(MARK_IDX, isFast ? MARK_START : MARK_END, false);
+            wasFast = isFast;
+        }
+
+        for (std::size_t i = 0; i < m_channels.size(); ++i) {
+            const Channel &channel = m_channels[i];
+            int &value = values[i];
+            bool isGps = (channel.metricId == LAT || channel.metricId == LNG);
+            int limit = channel.highBitIdx >= 0 ? 0xFFFF : BYTE_MASK;
+
+            int delta = 0;
+            if (isGps && recordIdx == 0) {
+                delta = GPS_BASELINE_DELTA; // doesn't move the position
+            } else if (value < channel.low) {
+                delta = std::min(channel.low - value, limit);
+            } else if (value > channel.high) {
+                delta = -std::min(value - channel.high, limit);
+            } else if (random.below(2)) {
+                int change = channel.increasing ? static_cast<int>(random.below(channel.step + 1))
+                                                : random.within(channel.step);
+                delta = std::clamp(value + change, channel.low, channel.high) - value;
+            }
+            if (delta == 0) {
+                continue;
+            }
+
+            int magnitude = std::abs(delta);
+            // A negative value has to have a non-zero low byte to carry its sign
+            if (delta < 0 && (magnitude & BYTE_MASK) == 0) {
+                --magnitude;
+                delta = -magnitude;
+            }
+            if (!(isGps && recordIdx == 0)) {
+                value += delta;
+            }
+            fields.set(channel.lowBitIdx, magnitude & BYTE_MASK, delta < 0);
+            if (magnitude > BYTE_MASK) {
+                fields.set(channel.highBitIdx, magnitude >> 8, false);
+            }
+        }
+        putRecord(records, fields, m_recordMaskSize);
+    }
+
+    // The flight header: number, flags, a block of data words (which can
+    // hold the start position), the interval, and the start date and time
+    std::tm start = utcTime(plan.startTime);
+    std::vector<uint16_t> words;
+    words.push_back(static_cast<uint16_t>(plan.flightNumber));
+    words.push_back(static_cast<uint16_t>(m_configFlags & CONFIG_FLAGS_LOWER_16_BITS_MASK));
+    words.push_back(static_cast<uint16_t>(m_configFlags >> 16));
+    std::vector<uint16_t> data(static_cast<std::size_t>(m_flightHeaderSize - 12) / 2, 0);
+    if (m_options.gps) {
+        auto lat = static_cast<uint32_t>(START_LAT);
+        auto lng = static_cast<uint32_t>(START_LNG);
+        data[HEADER_DATA_GPS_LAT_HIGH_IDX] = static_cast<uint16_t>(lat >> 16);
+        data[HEADER_DATA_GPS_LAT_LOW_IDX] = static_cast<uint16_t>(lat & 0xFFFF);
+        data[HEADER_DATA_GPS_LNG_HIGH_IDX] = static_cast<uint16_t>(lng >> 16);
+        data[HEADER_DATA_GPS_LNG_LOW_IDX] = static_cast<uint16_t>(lng & 0xFFFF);
+    }
+    words.insert(words.end(), data.begin(), data.end());
+    words.push_back(static_cast<uint16_t>(m_options.interval));
+    words.push_back(static_cast<uint16_t>(start.tm_mday | ((start.tm_mon + 1) << DATE_MONTH_SHIFT) |
+                                          ((start.tm_year - DATE_YEAR_OFFSET) << DATE_YEAR_SHIFT)));
+    words.push_back(static_cast<uint16_t>((start.tm_sec / TIME_SECONDS_SCALE) | (start.tm_min << TIME_MINUTES_SHIFT) |
+                                          (start.tm_hour << TIME_HOURS_SHIFT)));
+
+    // The parser finds the header size by trying the largest first, so make
+    // sure none of the larger sizes happen to checksum too
+    const std::size_t firstDataWord = 3;
+    std::vector<uint8_t> flight;
+    for (uint32_t tweak = 0;; ++tweak) {
+        if (tweak > 0xFFFF) {
+            std::stringstream msg;
+            msg << "Couldn't make flight " << plan.flightNumber << "'s header size unambiguous";
+            throw std::runtime_error(msg.str());
+        }
+        words[firstDataWord] = static_cast<uint16_t>(tweak);
+        flight.clear();
+        ChecksumWriter header(flight);
+        for (uint16_t word : words) {
+            header.put(static_cast<uint8_t>(word >> 8));
+            header.put(static_cast<uint8_t>(word & BYTE_MASK));
+        }
+        header.finish();
+        flight.insert(flight.end(), records.begin(), records.end());
+
+        bool ambiguous = false;
+        for (int size = m_flightHeaderSize + HEADER_SIZE_STEP; size <= MAX_FLIGHT_HEADER_SIZE;
+             size += HEADER_SIZE_STEP) {
+            if (static_cast<std::size_t>(size) < flight.size() && checksumMatches(flight.data(), size)) {
+                ambiguous = true;
+            }
+        }
+        if (!ambiguous) {
+            break;
+        }
+    }
+    return flight;
+}
+
+void EdmGenerator::writeHeaders(std::ostream &out, const std::vector<long> &flightWords) const
+{
+    std::tm download = utcTime(m_flights.empty() ? m_options.startTime : m_flights.back().startTime);
+
+    out << headerLine("U," + m_options.tailNumber);
+    out << headerLine("A, 150, 120, 500, 500, 60, 1650, 245, 999999999");
+    out << headerLine("F,0,50,34,2921,2921");
+    std::ostringstream timestamp;
+    timestamp << "T, " << download.tm_mon + 1 << ", " << download.tm_mday << ", " << download.tm_year % 100 << ", "
+              << download.tm_hour << ", " << download.tm_min << ", " << m_flights.size();
+    out << headerLine(timestamp.str());
+
+    std::ostringstream config;
+    config << "C";
+    for (auto value : m_configValues) {
+        config << "," << value;
+    }
+    out << headerLine(config.str());
+    if (m_hasProtoHeader) {
+        out << headerLine("P, 2");
+    }
+    for (std::size_t i = 0; i < m_flights.size(); ++i) {
+        out << headerLine("D, " + std::to_string(m_flights[i].flightNumber) + ", " + std::to_string(flightWords[i]));
+    }
+    // The parser doesn't use $L's value
+    out << headerLine("L, " + std::to_string(m_flights.size()));
+}
+
+void EdmGenerator::write(std::ostream &out) const
+{
+    // $D gives each flight's length in words, counting from the start of its
+    // header; the parser stops at the first record that starts past it.
+    std::vector<long> flightWords;
+    for (std::size_t i = 0; i < m_flights.size(); ++i) {
+        auto words = static_cast<long>(generateFlight(i).size() / 2) + 1;
+        if (words > MAX_FLIGHT_DATA_WORDS) {
+            std::stringstream msg;
+            msg << "Flight " << m_flights[i].flightNumber << " is too long for a $D record (" << words
+                << " words); use fewer records per flight";
+            throw std::runtime_error(msg.str());
+        }
+        flightWords.push_back(words);
+    }
+
+    writeHeaders(out, flightWords);
+    for (std::size_t i = 0; i < m_flights.size(); ++i) {
+        auto flight = generateFlight(i);
+        out.write(reinterpret_cast<const char *>(flight.data()), static_cast<std::streamsize>(flight.size()));
+    }
+}
+
+void EdmGenerator::writeFile(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::stringstream msg;
+        msg << "Couldn't open " << path << " for writing";
+        throw std::runtime_error(msg.str());
+    }
+    write(out);
+    out.close();
+    if (!out) {
+        std::stringstream msg;
+        msg << "Failed to write " << path;
+        throw std::runtime_error(msg.str());
+    }
+}
+
+} // namespace edmgen
@@ -0,0 +1,101 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Writes synthetic EDM files, for testing and benchmarking the parser
+ * on files much larger than the real samples.
+ *
+ * The files have the same ASCII headers ($U, $A, $F, $T, $C, $P, $D, $L)
+ * with XOR checksums as a real download, followed by binary flights: a
+ * flight header and then delta-encoded data records, each with a checksum.
+ * Metric values are random walks around plausible figures. Everything comes
+ * from the seed, so the same options always produce the same bytes.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Metadata.hpp"
+#include "MetricId.hpp"
+
+namespace edmgen {
+
+struct GeneratorOptions {
+    jpi_edm::EDMVersion version{jpi_edm::V4};
+    bool twin{false};  ///< must match the version: V2 and V5 are twins, the others aren't
+    int cylinders{6};  ///< per engine
+    bool gps{false};   ///< start position in the flight headers, plus LAT/LNG/ALT/SPD (V4 and V5 only)
+    int flights{1};
+    unsigned long recordsPerFlight{600};
+    double fastFraction{0.0};         ///< share of each flight's records in fast (1 second) mode, 0 to 1
+    unsigned long fastRunLength{60};  ///< records in each stretch of fast mode
+    unsigned int interval{6};         ///< seconds between standard records
+    unsigned int firstFlightNumber{1};
+    std::time_t startTime{1735732800}; ///< when the first flight starts (2025-01-01 12:00 UTC)
+    std::uint64_t seed{1};
+    std::string tailNumber{"N12345"};
+};
+
+/// What the generator will write for one flight
+struct GeneratedFlight {
+    unsigned int flightNumber{0};
+    std::time_t startTime{0};
+    unsigned long stdRecCount{0};
+    unsigned long fastRecCount{0};
+};
+
+class EdmGenerator
+{
+  public:
+    /**
+     * @throws std::invalid_argument if the options don't describe a file an
+     *         EDM could have written, e.g. GPS on a V1 recorder or more
+     *         cylinders than the version has metrics for
+     */
+    explicit EdmGenerator(const GeneratorOptions &options);
+
+    /// The flights write() produces, in file order
+    [[nodiscard]] const std::vector<GeneratedFlight> &flights() const { return m_flights; }
+
+    /**
+     * Write the whole file. Each flight is generated twice: once to size it
+     * for its $D header, and again to write it, so memory use doesn't grow
+     * with the file.
+     *
+     * @throws std::runtime_error if a flight is too long for a $D record
+     */
+    void write(std::ostream &out) const;
+    void writeFile(const std::string &path) const;
+
+  private:
+    // One simulated metric and where it goes in a data record
+    struct Channel {
+        jpi_edm::MetricId metricId{};
+        int lowBitIdx{0};
+        int highBitIdx{-1}; // -1 if the value is a single byte
+        int initialValue{0}; // raw value a Flight starts from, before any records
+        int low{0};          // the range the random walk stays in, in raw units
+        int high{0};
+        int step{0};         // largest change in one record
+        bool increasing{false};
+    };
+
+    [[nodiscard]] std::vector<uint8_t> generateFlight(std::size_t flightIdx) const;
+    void writeHeaders(std::ostream &out, const std::vector<long> &flightWords) const;
+
+    GeneratorOptions m_options;
+    std::vector<unsigned long> m_configValues; // the $C record
+    bool m_hasProtoHeader{false};
+    int m_flightHeaderSize{0};
+    int m_recordMaskSize{0}; // population map width: one byte for V1 and V2, two after that
+    uint32_t m_configFlags{0};
+    std::vector<Channel> m_channels;
+    std::vector<GeneratedFlight> m_flights;
+};
+
+} // namespace edmgen
@@ -0,0 +1,142 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Writes synthetic EDM files for scale testing.
+ *
+ * Example: a 2,000 flight, 4 cylinder twin archive with GPS, a tenth of it
+ * in fast mode:
+ *
+ *     edmgen -V 5 -t -c 4 -g -n 2000 -r 3600 -x 10 archive.jpi
+ */
+
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include "getopt.h"
+#else
+#include <unistd.h>
+#endif
+
+#include "EdmGenerator.hpp"
+
+namespace {
+
+void showHelp(char *progName)
+{
+    std::cout << "Usage: " << progName << " [options] outfile" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "    -h              print this help" << std::endl;
+    std::cout << "    -V <version>    EDM protocol version: 1, 2, 4 or 5 (default 4)" << std::endl;
+    std::cout << "    -t              twin engine (versions 2 and 5)" << std::endl;
+    std::cout << "    -c <count>      cylinders per engine (default 6)" << std::endl;
+    std::cout << "    -g              include GPS data (versions 4 and 5)" << std::endl;
+    std::cout << "    -n <count>      number of flights (default 1)" << std::endl;
+    std::cout << "    -r <count>      records per flight (default 600)" << std::endl;
+    std::cout << "    -x <percent>    percentage of records in fast mode (default 0)" << std::endl;
+    std::cout << "    -f <flightno>   first flight number (default 1)" << std::endl;
+    std::cout << "    -s <seed>       random seed (default 1)" << std::endl;
+}
+
+std::optional<unsigned long> parseNumber(const char *arg, const char *what)
+{
+    try {
+        size_t idx = 0;
+        unsigned long value = std::stoul(arg, &idx);
+        if (idx == std::strlen(arg) && arg[0] != '-') {
+            return value;
+        }
+    } catch (const std::exception &) {
+    }
+    std::cerr << "Error: " << what << " must be a non-negative integer: " << arg << std::endl;
+    return std::nullopt;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    edmgen::GeneratorOptions options;
+    bool versionGiven = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "hV:tc:gn:r:x:f:s:")) != -1) {
+        std::optional<unsigned long> value;
+        if (optarg) {
+            const char *names[] = {"Version", "Cylinder count", "Flight count", "Record count",
+                                   "Fast percentage", "Flight number", "Seed"};
+            const char *opts = "Vcnrxfs";
+            const char *pos = std::strchr(opts, c);
+            if (pos) {
+                value = parseNumber(optarg, names[pos - opts]);
+                if (!value) {
+                    return 1;
+                }
+            }
+        }
+
+        switch (c) {
+        case 'h':
+            showHelp(argv[0]);
+            return 0;
+        case 'V':
+            if (*value != 1 && *value != 2 && *value != 4 && *value != 5) {
+                std::cerr << "Error: Version must be 1, 2, 4 or 5" << std::endl;
+                return 1;
+            }
+            options.version = static_cast<jpi_edm::EDMVersion>(1 << (*value - 1));
+            versionGiven = true;
+            break;
+        case 't':
+            options.twin = true;
+            break;
+        case 'c':
+            options.cylinders = static_cast<int>(*value);
+            break;
+        case 'g':
+            options.gps = true;
+            break;
+        case 'n':
+            options.flights = static_cast<int>(*value);
+            break;
+        case 'r':
+            options.recordsPerFlight = *value;
+            break;
+        case 'x':
+            options.fastFraction = static_cast<double>(*value) / 100.0;
+            break;
+        case 'f':
+            options.firstFlightNumber = static_cast<unsigned int>(*value);
+            break;
+        case 's':
+            options.seed = *value;
+            break;
+        default:
+            showHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind != argc - 1) {
+        showHelp(argv[0]);
+        return 1;
+    }
+
+    // A twin is a version 5 unless told otherwise
+    if (options.twin && !versionGiven) {
+        options.version = jpi_edm::V5;
+    }
+
+    try {
+        edmgen::EdmGenerator generator(options);
+        generator.writeFile(argv[optind]);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
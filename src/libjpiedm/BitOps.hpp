@@ -0,0 +1,65 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Bit counting and set-bit iteration over 64 bit words.
+ *
+ * Record field maps are mostly empty, so the decoders walk just the set
+ * bits rather than testing every one of the MAX_METRIC_FIELDS positions.
+ * These compile to single instructions (tzcnt/bsf, popcnt) where the
+ * compiler has them.
+ */
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace jpi_edm {
+
+/// Index of the lowest set bit; word must not be 0
+inline int countTrailingZeros(uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long idx = 0;
+    _BitScanForward64(&idx, word);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+inline int popCount(uint64_t word)
+{
+#if defined(_MSC_VER)
+    return static_cast<int>(std::bitset<64>(word).count());
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+/// Calls fn(bitIdx) for each set bit of word, lowest first
+template <typename Fn> inline void forEachSetBit(uint64_t word, Fn &&fn)
+{
+    for (; word != 0; word &= word - 1) {
+        fn(countTrailingZeros(word));
+    }
+}
+
+/// Calls fn(bitIdx) for each set bit of bits, lowest first
+template <std::size_t N, typename Fn> inline void forEachSetBit(const std::bitset<N> &bits, Fn &&fn)
+{
+    static_assert(N % 64 == 0, "whole 64 bit words only");
+    const std::bitset<N> lowWord(~0ULL);
+    for (std::size_t base = 0; base < N; base += 64) {
+        uint64_t word = ((bits >> base) & lowWord).to_ullong();
+        forEachSetBit(word, [&fn, base](int bitIdx) { fn(static_cast<int>(base) + bitIdx); });
+    }
+}
+
+} // namespace jpi_edm
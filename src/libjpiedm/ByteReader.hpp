@@ -0,0 +1,116 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Bounds-checked cursor over a contiguous, in-memory byte span.
+ *
+ * The binary parts of an EDM file (flight headers and data records) are
+ * decoded from spans of bytes rather than one istream::read() at a time.
+ * ByteReader keeps the cursor and the bounds checks in one place so the
+ * decoders don't have to.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Checksum.hpp"
+
+namespace jpi_edm {
+
+/**
+ * Running additive and XOR checksum over a run of bytes.
+ *
+ * EDM binary blocks are terminated with a single checksum byte that is
+ * either the negated byte sum or the byte XOR of the block, depending on
+ * the model, so both are accumulated.
+ */
+struct BinaryChecksum {
+    uint8_t sum{0};
+    uint8_t xorSum{0};
+
+    void add(uint8_t byte)
+    {
+        sum = static_cast<uint8_t>(sum + byte);
+        xorSum ^= byte;
+    }
+
+    void add(const uint8_t *data, std::size_t len)
+    {
+        auto sums = sumBytes(data, len);
+        sum = static_cast<uint8_t>(sum + sums.sum);
+        xorSum ^= sums.xorSum;
+    }
+
+    [[nodiscard]] bool matches(uint8_t checksum) const
+    {
+        return checksum == static_cast<uint8_t>(-sum) || checksum == xorSum;
+    }
+};
+
+class ByteReader
+{
+  public:
+    ByteReader(const uint8_t *data, std::size_t size) : m_data(data), m_size(size) {}
+
+    [[nodiscard]] const uint8_t *data() const { return m_data; }
+    [[nodiscard]] std::size_t size() const { return m_size; }
+    [[nodiscard]] std::size_t position() const { return m_pos; }
+    [[nodiscard]] std::size_t remaining() const { return m_size - m_pos; }
+    [[nodiscard]] bool has(std::size_t len) const { return len <= remaining(); }
+    [[nodiscard]] const uint8_t *current() const { return m_data + m_pos; }
+
+    void seek(std::size_t pos)
+    {
+        if (pos > m_size) {
+            throw std::runtime_error("ByteReader: seek past end of buffer");
+        }
+        m_pos = pos;
+    }
+
+    void skip(std::size_t len)
+    {
+        require(len);
+        m_pos += len;
+    }
+
+    // Returns a pointer to the next len bytes and advances past them.
+    const uint8_t *read(std::size_t len)
+    {
+        require(len);
+        const uint8_t *p = m_data + m_pos;
+        m_pos += len;
+        return p;
+    }
+
+    uint8_t readU8()
+    {
+        require(1);
+        return m_data[m_pos++];
+    }
+
+    // EDM binary fields are big-endian (network order)
+    uint16_t readU16BE()
+    {
+        require(2);
+        auto val = static_cast<uint16_t>((static_cast<uint16_t>(m_data[m_pos]) << 8) | m_data[m_pos + 1]);
+        m_pos += 2;
+        return val;
+    }
+
+  private:
+    void require(std::size_t len) const
+    {
+        if (!has(len)) {
+            throw std::runtime_error("ByteReader: read past end of buffer");
+        }
+    }
+
+    const uint8_t *m_data{nullptr};
+    std::size_t m_size{0};
+    std::size_t m_pos{0};
+};
+
+} // namespace jpi_edm
@@ -0,0 +1,128 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Positioned byte sources that the FlightFile parser reads from.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "ByteSource.hpp"
+#include "ProtocolConstants.hpp"
+
+namespace jpi_edm {
+
+// =============================================================================
+// MemoryByteSource
+// =============================================================================
+
+ByteReader MemoryByteSource::peek(std::size_t len)
+{
+    if (m_pos < m_base || static_cast<std::size_t>(m_pos - m_base) >= m_size) {
+        return ByteReader(nullptr, 0);
+    }
+    auto pos = static_cast<std::size_t>(m_pos - m_base);
+    return ByteReader(m_data + pos, std::min(len, m_size - pos));
+}
+
+// =============================================================================
+// StreamByteSource
+// =============================================================================
+
+StreamByteSource::StreamByteSource(std::istream &stream) : m_stream(stream)
+{
+    auto pos = m_stream.tellg();
+    if (pos == -1) {
+        // Not seekable (e.g. a pipe); sequential reads still work.
+        m_seekable = false;
+        pos = 0;
+    }
+    m_pos = pos;
+}
+
+StreamByteSource::~StreamByteSource()
+{
+    if (!m_seekable) {
+        return;
+    }
+    try {
+        m_stream.clear();
+        m_stream.seekg(m_pos, std::ios_base::beg);
+    } catch (...) {
+        // never throw from a destructor
+    }
+}
+
+ByteReader StreamByteSource::peek(std::size_t len)
+{
+    if (m_end - m_begin < len) {
+        fill(len);
+    }
+    return ByteReader(m_buffer.data() + m_begin, std::min(len, m_end - m_begin));
+}
+
+void StreamByteSource::consume(std::size_t len)
+{
+    m_pos += static_cast<std::streamoff>(len);
+    std::size_t buffered = m_end - m_begin;
+    if (len <= buffered) {
+        m_begin += len;
+        return;
+    }
+
+    // Consuming past what's buffered; drop the buffer and reposition the stream.
+    m_begin = m_end = 0;
+    if (m_seekable) {
+        m_stream.clear();
+        m_stream.seekg(m_pos, std::ios_base::beg);
+    } else {
+        m_stream.ignore(static_cast<std::streamsize>(len - buffered));
+    }
+}
+
+void StreamByteSource::seek(std::streamoff pos)
+{
+    // Stay within the buffer if we can; FlightView's record seeking jumps back
+    // to a nearby checkpoint and shouldn't cost a stream seek each time.
+    std::streamoff bufferStart = m_pos - static_cast<std::streamoff>(m_begin);
+    std::streamoff bufferEnd = m_pos + static_cast<std::streamoff>(m_end - m_begin);
+    if (pos >= bufferStart && pos <= bufferEnd) {
+        m_begin = static_cast<std::size_t>(pos - bufferStart);
+        m_pos = pos;
+        return;
+    }
+
+    m_begin = m_end = 0;
+    m_pos = pos;
+    m_stream.clear();
+    m_stream.seekg(pos, std::ios_base::beg);
+}
+
+// Makes at least len bytes available from m_begin, unless the stream ends first.
+void StreamByteSource::fill(std::size_t len)
+{
+    std::size_t buffered = m_end - m_begin;
+    std::size_t wanted = std::max(len, STREAM_READ_CHUNK_SIZE);
+
+    if (m_buffer.size() - m_begin < wanted) {
+        // Slide the unconsumed bytes to the front, then grow if that's not enough.
+        if (buffered > 0 && m_begin > 0) {
+            std::memmove(m_buffer.data(), m_buffer.data() + m_begin, buffered);
+        }
+        m_begin = 0;
+        m_end = buffered;
+        if (m_buffer.size() < wanted) {
+            m_buffer.resize(wanted);
+        }
+    }
+
+    if (!m_stream.good()) {
+        return;
+    }
+    m_stream.read(reinterpret_cast<char *>(m_buffer.data() + m_end),
+                  static_cast<std::streamsize>(m_buffer.size() - m_end));
+    m_end += static_cast<std::size_t>(m_stream.gcount());
+}
+
+} // namespace jpi_edm
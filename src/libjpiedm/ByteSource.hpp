@@ -0,0 +1,107 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Positioned byte sources that the FlightFile parser reads from.
+ *
+ * The parser never reads a byte at a time. Instead it peeks at a span of
+ * bytes at the current offset, decodes it with a ByteReader, and consumes
+ * what it used. This lets the same parsing code run over:
+ *
+ * MemoryByteSource
+ *      A span that's already in memory, e.g. a memory-mapped file. Peeking
+ *      is just pointer arithmetic and nothing is copied.
+ *
+ * StreamByteSource
+ *      A std::istream, read through an internal buffer in large chunks so
+ *      the per-call streambuf overhead is paid once per chunk rather than
+ *      once per field.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "ByteReader.hpp"
+
+namespace jpi_edm {
+
+class ByteSource
+{
+  public:
+    ByteSource() = default;
+    virtual ~ByteSource() = default;
+
+    ByteSource(const ByteSource &) = delete;
+    ByteSource &operator=(const ByteSource &) = delete;
+
+    /**
+     * Returns a reader over up to len bytes starting at the current offset,
+     * without consuming them. The reader is shorter than len only if the end
+     * of the input was reached. It is invalidated by the next call to peek()
+     * or seek().
+     */
+    [[nodiscard]] virtual ByteReader peek(std::size_t len) = 0;
+
+    /// Advances the current offset by len bytes.
+    virtual void consume(std::size_t len) = 0;
+
+    /// Current offset from the start of the input.
+    [[nodiscard]] virtual std::streamoff tell() const = 0;
+
+    /// Moves the current offset. Seeking past the end is allowed; subsequent peeks return no bytes.
+    virtual void seek(std::streamoff pos) = 0;
+};
+
+class MemoryByteSource : public ByteSource
+{
+  public:
+    MemoryByteSource(const uint8_t *data, std::size_t size) : m_data(data), m_size(size) {}
+
+    /// A span that holds the input from offset base on, so offsets stay those of the whole input.
+    MemoryByteSource(const uint8_t *data, std::size_t size, std::streamoff base)
+        : m_data(data), m_size(size), m_base(base), m_pos(base)
+    {
+    }
+
+    [[nodiscard]] ByteReader peek(std::size_t len) override;
+    void consume(std::size_t len) override { m_pos += static_cast<std::streamoff>(len); }
+    [[nodiscard]] std::streamoff tell() const override { return m_pos; }
+    void seek(std::streamoff pos) override { m_pos = pos; }
+
+  private:
+    const uint8_t *m_data;
+    std::size_t m_size;
+    std::streamoff m_base{0}; // offset of m_data[0]
+    std::streamoff m_pos{0};
+};
+
+class StreamByteSource : public ByteSource
+{
+  public:
+    /// Starts reading at the stream's current position.
+    explicit StreamByteSource(std::istream &stream);
+
+    /// Leaves the stream positioned at tell(), as if it had been read directly.
+    ~StreamByteSource() override;
+
+    [[nodiscard]] ByteReader peek(std::size_t len) override;
+    void consume(std::size_t len) override;
+    [[nodiscard]] std::streamoff tell() const override { return m_pos; }
+    void seek(std::streamoff pos) override;
+
+  private:
+    void fill(std::size_t len);
+
+    std::istream &m_stream;
+    std::vector<uint8_t> m_buffer;
+    std::size_t m_begin{0};  // index in m_buffer of the byte at m_pos
+    std::size_t m_end{0};    // one past the last valid byte in m_buffer
+    std::streamoff m_pos{0}; // offset in the stream of m_buffer[m_begin]
+    bool m_seekable{true};
+};
+
+} // namespace jpi_edm
@@ -0,0 +1,151 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Scalar, SSE2 and AVX2 byte sum kernels, and the run-time choice between them.
+ */
+
+#include "Checksum.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JPIEDM_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+// Compiled for AVX2 whatever the build targets, and only called if the CPU has it
+#define JPIEDM_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace jpi_edm {
+
+namespace {
+
+// Below this many bytes the vector setup costs more than it saves
+constexpr std::size_t MIN_VECTOR_BYTES = 32;
+
+using SumKernel = ByteSums (*)(const uint8_t *, std::size_t);
+
+#ifdef JPIEDM_SSE2
+// Folds a vector's lanes of 64 bit sums and its XORed bytes into the tail's sums
+ByteSums combine(__m128i sums, __m128i xors, ByteSums tail)
+{
+    alignas(16) uint64_t sumLanes[2];
+    alignas(16) uint8_t xorBytes[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(sumLanes), sums);
+    _mm_store_si128(reinterpret_cast<__m128i *>(xorBytes), xors);
+
+    tail.sum = static_cast<uint8_t>(tail.sum + sumLanes[0] + sumLanes[1]);
+    for (uint8_t byte : xorBytes) {
+        tail.xorSum ^= byte;
+    }
+    return tail;
+}
+
+ByteSums sumBytesSse2(const uint8_t *data, std::size_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    __m128i xors = zero;
+    std::size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        // sum of absolute differences from zero adds each 8 bytes into a 64 bit lane
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(bytes, zero));
+        xors = _mm_xor_si128(xors, bytes);
+    }
+    return combine(sums, xors, sumBytesScalar(data + i, len - i));
+}
+#endif
+
+#ifdef JPIEDM_AVX2
+// Kept clear of the SSE2 kernel and its helpers: calling non-VEX code with the
+// upper halves of the registers in use stalls on every call on some CPUs.
+__attribute__((target("avx2"))) ByteSums sumBytesAvx2(const uint8_t *data, std::size_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sums = zero;
+    __m256i xors = zero;
+    std::size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(bytes, zero));
+        xors = _mm256_xor_si256(xors, bytes);
+    }
+
+    // Fold to 128 bits and take one more 16 byte step if there's room
+    __m128i sums128 = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    __m128i xors128 = _mm_xor_si128(_mm256_castsi256_si128(xors), _mm256_extracti128_si256(xors, 1));
+    if (i + 16 <= len) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        sums128 = _mm_add_epi64(sums128, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+        xors128 = _mm_xor_si128(xors128, bytes);
+        i += 16;
+    }
+
+    alignas(16) uint64_t sumLanes[2];
+    alignas(16) uint64_t xorLanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(sumLanes), sums128);
+    _mm_store_si128(reinterpret_cast<__m128i *>(xorLanes), xors128);
+
+    uint64_t sum = sumLanes[0] + sumLanes[1];
+    uint64_t xorWord = xorLanes[0] ^ xorLanes[1];
+    for (; i < len; ++i) {
+        sum += data[i];
+        xorWord ^= data[i];
+    }
+    xorWord ^= xorWord >> 32;
+    xorWord ^= xorWord >> 16;
+    xorWord ^= xorWord >> 8;
+    return {static_cast<uint8_t>(sum), static_cast<uint8_t>(xorWord)};
+}
+#endif
+
+struct KernelChoice {
+    SumKernel kernel;
+    const char *name;
+};
+
+KernelChoice chooseKernel()
+{
+#ifdef JPIEDM_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {sumBytesAvx2, "avx2"};
+    }
+#endif
+#ifdef JPIEDM_SSE2
+    return {sumBytesSse2, "sse2"};
+#else
+    return {sumBytesScalar, "scalar"};
+#endif
+}
+
+const KernelChoice &kernelChoice()
+{
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+} // namespace
+
+ByteSums sumBytesScalar(const uint8_t *data, std::size_t len)
+{
+    ByteSums sums;
+    for (std::size_t i = 0; i < len; ++i) {
+        sums.sum = static_cast<uint8_t>(sums.sum + data[i]);
+        sums.xorSum ^= data[i];
+    }
+    return sums;
+}
+
+ByteSums sumBytes(const uint8_t *data, std::size_t len)
+{
+    if (len < MIN_VECTOR_BYTES) {
+        return sumBytesScalar(data, len);
+    }
+    return kernelChoice().kernel(data, len);
+}
+
+const char *sumBytesKernel() { return kernelChoice().name; }
+
+} // namespace jpi_edm
@@ -0,0 +1,34 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Byte sum and XOR over a run of bytes, the two checksums EDM binary
+ * blocks use.
+ *
+ * The work is done with the widest vector instructions the CPU has (AVX2 or
+ * SSE2 on x86), picked once at run time, and a byte-at-a-time loop
+ * everywhere else.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jpi_edm {
+
+/// The byte sum (mod 256) and byte XOR of a run of bytes
+struct ByteSums {
+    uint8_t sum{0};
+    uint8_t xorSum{0};
+};
+
+[[nodiscard]] ByteSums sumBytes(const uint8_t *data, std::size_t len);
+
+/// The byte-at-a-time version sumBytes() falls back to
+[[nodiscard]] ByteSums sumBytesScalar(const uint8_t *data, std::size_t len);
+
+/// Which implementation sumBytes() uses: "avx2", "sse2" or "scalar"
+[[nodiscard]] const char *sumBytesKernel();
+
+} // namespace jpi_edm
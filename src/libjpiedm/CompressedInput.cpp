@@ -0,0 +1,465 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief gzip, zstd and zip input, decompressed a chunk at a time.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <climits>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef JPIEDM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef JPIEDM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "CompressedInput.hpp"
+
+namespace jpi_edm {
+
+namespace {
+
+// How much is read, or decompressed, at a time
+constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+constexpr uint8_t GZIP_MAGIC[] = {0x1F, 0x8B};
+constexpr uint8_t ZSTD_MAGIC[] = {0x28, 0xB5, 0x2F, 0xFD};
+constexpr uint8_t ZIP_MAGIC[] = {'P', 'K', 0x03, 0x04};
+constexpr uint8_t EMPTY_ZIP_MAGIC[] = {'P', 'K', 0x05, 0x06};
+
+// Zip record signatures and sizes
+constexpr uint32_t ZIP_LOCAL_HEADER_SIG = 0x04034B50U;
+constexpr uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014B50U;
+constexpr uint32_t ZIP_END_OF_DIR_SIG = 0x06054B50U;
+constexpr std::size_t ZIP_LOCAL_HEADER_SIZE = 30;
+constexpr std::size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+constexpr std::size_t ZIP_END_OF_DIR_SIZE = 22;
+constexpr std::size_t ZIP_MAX_COMMENT = 0xFFFF;
+constexpr uint16_t ZIP_STORED = 0;
+constexpr uint16_t ZIP_DEFLATED = 8;
+constexpr uint16_t ZIP_ENCRYPTED_FLAG = 0x0001;
+
+template <std::size_t N> bool startsWith(const uint8_t *data, std::size_t size, const uint8_t (&magic)[N])
+{
+    return size >= N && std::equal(magic, magic + N, data);
+}
+
+uint16_t readU16LE(const uint8_t *p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+uint32_t readU32LE(const uint8_t *p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+const std::array<uint32_t, 256> &crcTable()
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < t.size(); ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1U) ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U;
+            }
+            t[i] = crc;
+        }
+        return t;
+    }();
+    return table;
+}
+
+[[noreturn]] void throwUnsupported(const char *what, const char *library)
+{
+    std::stringstream msg;
+    msg << what << " input isn't supported: built without " << library;
+    throw std::runtime_error(msg.str());
+}
+
+#ifdef JPIEDM_HAVE_ZLIB
+// A gzip stream, or a zip member's raw deflate data
+class Inflater : public Decompressor
+{
+  public:
+    // windowBits as for inflateInit2(): MAX_WBITS + 16 for gzip, -MAX_WBITS for raw deflate
+    explicit Inflater(int windowBits) : m_gzip(windowBits > 0), m_out(CHUNK_SIZE)
+    {
+        if (inflateInit2(&m_stream, windowBits) != Z_OK) {
+            throw std::runtime_error("Couldn't start inflating");
+        }
+    }
+    ~Inflater() override { inflateEnd(&m_stream); }
+
+    Inflater(const Inflater &) = delete;
+    Inflater &operator=(const Inflater &) = delete;
+
+    void write(const uint8_t *data, std::size_t len, const ByteSink &sink) override
+    {
+        while (len > 0) {
+            auto part = static_cast<uInt>(std::min<std::size_t>(len, UINT_MAX));
+            inflatePart(data, part, sink);
+            data += part;
+            len -= part;
+        }
+    }
+
+    void finish(const ByteSink &) override
+    {
+        if (!m_ended) {
+            throw std::runtime_error("Compressed data ended early");
+        }
+    }
+
+  private:
+    void inflatePart(const uint8_t *data, uInt len, const ByteSink &sink)
+    {
+        m_stream.next_in = const_cast<Bytef *>(data);
+        m_stream.avail_in = len;
+        do {
+            if (m_ended) {
+                if (!m_gzip) {
+                    // nothing of a deflate stream follows its end
+                    return;
+                }
+                // gzip files can be several members one after the other
+                inflateReset(&m_stream);
+                m_ended = false;
+            }
+            m_stream.next_out = m_out.data();
+            m_stream.avail_out = static_cast<uInt>(m_out.size());
+            int ret = inflate(&m_stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                std::stringstream msg;
+                msg << "Couldn't inflate compressed data: " << (m_stream.msg ? m_stream.msg : "error") << " (" << ret
+                    << ")";
+                throw std::runtime_error(msg.str());
+            }
+            auto produced = m_out.size() - m_stream.avail_out;
+            if (produced > 0) {
+                sink(m_out.data(), produced);
+            }
+            m_ended = (ret == Z_STREAM_END);
+        } while (m_stream.avail_in > 0 || (m_stream.avail_out == 0 && !m_ended));
+    }
+
+    z_stream m_stream{};
+    bool m_gzip;
+    bool m_ended{false};
+    std::vector<uint8_t> m_out;
+};
+#endif
+
+#ifdef JPIEDM_HAVE_ZSTD
+class ZstdDecompressor : public Decompressor
+{
+  public:
+    ZstdDecompressor() : m_stream(ZSTD_createDStream()), m_out(ZSTD_DStreamOutSize())
+    {
+        if (!m_stream || ZSTD_isError(ZSTD_initDStream(m_stream))) {
+            ZSTD_freeDStream(m_stream);
+            throw std::runtime_error("Couldn't start zstd decompression");
+        }
+    }
+    ~ZstdDecompressor() override { ZSTD_freeDStream(m_stream); }
+
+    ZstdDecompressor(const ZstdDecompressor &) = delete;
+    ZstdDecompressor &operator=(const ZstdDecompressor &) = delete;
+
+    void write(const uint8_t *data, std::size_t len, const ByteSink &sink) override
+    {
+        ZSTD_inBuffer in{data, len, 0};
+        bool outFull = false;
+        while (in.pos < in.size || outFull) {
+            ZSTD_outBuffer out{m_out.data(), m_out.size(), 0};
+            std::size_t ret = ZSTD_decompressStream(m_stream, &out, &in);
+            if (ZSTD_isError(ret)) {
+                std::stringstream msg;
+                msg << "Couldn't decompress zstd data: " << ZSTD_getErrorName(ret);
+                throw std::runtime_error(msg.str());
+            }
+            if (out.pos > 0) {
+                sink(m_out.data(), out.pos);
+            }
+            // 0 once a frame has been decoded and flushed in full
+            m_frameDone = (ret == 0);
+            outFull = (out.pos == out.size);
+        }
+    }
+
+    void finish(const ByteSink &) override
+    {
+        if (!m_frameDone) {
+            throw std::runtime_error("Compressed data ended early");
+        }
+    }
+
+  private:
+    ZSTD_DStream *m_stream;
+    bool m_frameDone{false};
+    std::vector<uint8_t> m_out;
+};
+#endif
+
+} // namespace
+
+InputFormat detectInputFormat(const uint8_t *data, std::size_t size)
+{
+    if (startsWith(data, size, GZIP_MAGIC)) {
+        return InputFormat::GZIP;
+    }
+    if (startsWith(data, size, ZSTD_MAGIC)) {
+        return InputFormat::ZSTD;
+    }
+    if (startsWith(data, size, ZIP_MAGIC) || startsWith(data, size, EMPTY_ZIP_MAGIC)) {
+        return InputFormat::ZIP;
+    }
+    return InputFormat::RAW;
+}
+
+bool canDecompress(InputFormat format)
+{
+    switch (format) {
+    case InputFormat::RAW:
+        return true;
+    case InputFormat::GZIP:
+    case InputFormat::ZIP:
+#ifdef JPIEDM_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case InputFormat::ZSTD:
+#ifdef JPIEDM_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+uint32_t crc32(const uint8_t *data, std::size_t len, uint32_t crc)
+{
+    const auto &table = crcTable();
+    crc = ~crc;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8U);
+    }
+    return ~crc;
+}
+
+std::unique_ptr<Decompressor> Decompressor::create(InputFormat format)
+{
+    switch (format) {
+    case InputFormat::GZIP:
+#ifdef JPIEDM_HAVE_ZLIB
+        return std::make_unique<Inflater>(MAX_WBITS + 16);
+#else
+        throwUnsupported("gzip", "zlib");
+#endif
+    case InputFormat::ZSTD:
+#ifdef JPIEDM_HAVE_ZSTD
+        return std::make_unique<ZstdDecompressor>();
+#else
+        throwUnsupported("zstd", "libzstd");
+#endif
+    case InputFormat::RAW:
+    case InputFormat::ZIP:
+        break;
+    }
+    throw std::runtime_error("Only gzip and zstd streams can be decompressed");
+}
+
+void readDecompressed(std::istream &stream, const ByteSink &sink)
+{
+    std::vector<uint8_t> chunk(CHUNK_SIZE);
+    auto readChunk = [&stream, &chunk]() {
+        stream.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        return static_cast<std::size_t>(stream.gcount());
+    };
+
+    // read() only comes back short at the end, so the first chunk has the whole magic number
+    std::size_t len = readChunk();
+    auto format = detectInputFormat(chunk.data(), len);
+    if (format == InputFormat::ZIP) {
+        throw std::runtime_error("Zip archives have to be read with ZipArchive");
+    }
+    std::unique_ptr<Decompressor> decompressor;
+    if (format != InputFormat::RAW) {
+        decompressor = Decompressor::create(format);
+    }
+
+    for (; len > 0; len = readChunk()) {
+        decompressor ? decompressor->write(chunk.data(), len, sink) : sink(chunk.data(), len);
+    }
+    if (decompressor) {
+        decompressor->finish(sink);
+    }
+}
+
+void readDecompressed(const uint8_t *data, std::size_t size, const ByteSink &sink)
+{
+    auto format = detectInputFormat(data, size);
+    if (format == InputFormat::ZIP) {
+        throw std::runtime_error("Zip archives have to be read with ZipArchive");
+    }
+    if (format == InputFormat::RAW) {
+        for (std::size_t pos = 0; pos < size; pos += CHUNK_SIZE) {
+            sink(data + pos, std::min(CHUNK_SIZE, size - pos));
+        }
+        return;
+    }
+    auto decompressor = Decompressor::create(format);
+    decompressor->write(data, size, sink);
+    decompressor->finish(sink);
+}
+
+// =============================================================================
+// ZipArchive
+// =============================================================================
+
+ZipArchive::ZipArchive(const uint8_t *data, std::size_t size) : m_data(data), m_size(size)
+{
+    // The end of central directory record is last, followed only by a comment
+    if (size < ZIP_END_OF_DIR_SIZE) {
+        throw std::runtime_error("Not a zip archive: too short");
+    }
+    const uint8_t *endOfDir = nullptr;
+    const std::size_t lowest = size - ZIP_END_OF_DIR_SIZE - std::min(size - ZIP_END_OF_DIR_SIZE, ZIP_MAX_COMMENT);
+    for (std::size_t pos = size - ZIP_END_OF_DIR_SIZE + 1; pos-- > lowest;) {
+        if (readU32LE(data + pos) == ZIP_END_OF_DIR_SIG) {
+            endOfDir = data + pos;
+            break;
+        }
+    }
+    if (!endOfDir) {
+        throw std::runtime_error("Not a zip archive: no end of central directory");
+    }
+
+    const uint16_t entryCount = readU16LE(endOfDir + 10);
+    const uint32_t dirSize = readU32LE(endOfDir + 12);
+    const uint32_t dirOffset = readU32LE(endOfDir + 16);
+    if (entryCount == 0xFFFF || dirOffset == 0xFFFFFFFFU) {
+        throw std::runtime_error("Zip64 archives aren't supported");
+    }
+    if (static_cast<std::size_t>(dirOffset) + dirSize > size) {
+        throw std::runtime_error("Zip central directory runs past the end of the archive");
+    }
+
+    std::size_t pos = dirOffset;
+    const std::size_t dirEnd = pos + dirSize;
+    m_entries.reserve(entryCount);
+    for (uint16_t i = 0; i < entryCount; ++i) {
+        const uint8_t *header = data + pos;
+        if (pos + ZIP_CENTRAL_HEADER_SIZE > dirEnd || readU32LE(header) != ZIP_CENTRAL_HEADER_SIG) {
+            std::stringstream msg;
+            msg << "Bad zip central directory entry " << i << " at offset " << pos;
+            throw std::runtime_error(msg.str());
+        }
+        const std::size_t nameLen = readU16LE(header + 28);
+        const std::size_t extraLen = readU16LE(header + 30);
+        const std::size_t commentLen = readU16LE(header + 32);
+        const std::size_t headerLen = ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen;
+        if (pos + headerLen > dirEnd) {
+            std::stringstream msg;
+            msg << "Zip central directory entry " << i << " runs past the end of the directory";
+            throw std::runtime_error(msg.str());
+        }
+
+        Entry entry;
+        entry.flags = readU16LE(header + 8);
+        entry.method = readU16LE(header + 10);
+        entry.crc32 = readU32LE(header + 16);
+        entry.compressedSize = readU32LE(header + 20);
+        entry.size = readU32LE(header + 24);
+        entry.localHeaderOffset = readU32LE(header + 42);
+        entry.name.assign(reinterpret_cast<const char *>(header + ZIP_CENTRAL_HEADER_SIZE), nameLen);
+        m_entries.push_back(std::move(entry));
+        pos += headerLen;
+    }
+}
+
+std::vector<ZipArchive::Entry> ZipArchive::jpiEntries() const
+{
+    static const std::string suffix = ".jpi";
+    std::vector<Entry> jpis;
+    for (const auto &entry : m_entries) {
+        const auto &name = entry.name;
+        bool isJpi = name.size() > suffix.size() &&
+                     std::equal(suffix.begin(), suffix.end(), name.end() - static_cast<std::ptrdiff_t>(suffix.size()),
+                                [](char a, char b) {
+                                    return a == std::tolower(static_cast<unsigned char>(b));
+                                });
+        if (isJpi) {
+            jpis.push_back(entry);
+        }
+    }
+    return jpis;
+}
+
+void ZipArchive::read(const Entry &entry, const ByteSink &sink) const
+{
+    auto fail = [&entry](const char *why) {
+        std::stringstream msg;
+        msg << "Couldn't read " << entry.name << " from zip archive: " << why;
+        throw std::runtime_error(msg.str());
+    };
+
+    if (entry.flags & ZIP_ENCRYPTED_FLAG) {
+        fail("it's encrypted");
+    }
+    const std::size_t headerPos = entry.localHeaderOffset;
+    if (headerPos + ZIP_LOCAL_HEADER_SIZE > m_size || readU32LE(m_data + headerPos) != ZIP_LOCAL_HEADER_SIG) {
+        fail("bad local header");
+    }
+    const std::size_t dataPos = headerPos + ZIP_LOCAL_HEADER_SIZE + readU16LE(m_data + headerPos + 26) +
+                                readU16LE(m_data + headerPos + 28);
+    if (dataPos + entry.compressedSize > m_size) {
+        fail("it runs past the end of the archive");
+    }
+    const uint8_t *data = m_data + dataPos;
+
+    // Check what comes out against the central directory on the way through
+    uint32_t crc = 0;
+    std::size_t size = 0;
+    ByteSink checked = [&crc, &size, &sink](const uint8_t *chunk, std::size_t len) {
+        crc = jpi_edm::crc32(chunk, len, crc);
+        size += len;
+        sink(chunk, len);
+    };
+
+    switch (entry.method) {
+    case ZIP_STORED:
+        for (std::size_t pos = 0; pos < entry.compressedSize; pos += CHUNK_SIZE) {
+            checked(data + pos, std::min<std::size_t>(CHUNK_SIZE, entry.compressedSize - pos));
+        }
+        break;
+    case ZIP_DEFLATED:
+    {
+#ifdef JPIEDM_HAVE_ZLIB
+        Inflater inflater(-MAX_WBITS);
+        inflater.write(data, entry.compressedSize, checked);
+        inflater.finish(checked);
+#else
+        throwUnsupported("Deflated zip", "zlib");
+#endif
+    } break;
+    default:
+        fail("unsupported compression method");
+    }
+
+    if (size != entry.size) {
+        fail("its size doesn't match the central directory");
+    }
+    if (crc != entry.crc32) {
+        fail("CRC mismatch");
+    }
+}
+
+} // namespace jpi_edm
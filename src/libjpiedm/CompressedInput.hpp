@@ -0,0 +1,117 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Reading EDM files that are gzip or zstd compressed, or inside a
+ * zip archive.
+ *
+ * Nothing is inflated whole. Compressed bytes go in a chunk at a time, and
+ * each chunk of the file they decompress to is handed on as soon as it's
+ * ready, typically to FlightFile::feed(). So a large archive never needs
+ * more than a chunk of decompressed data in memory at once.
+ *
+ * gzip and deflated zip members need zlib, and zstd needs libzstd. Each is
+ * used if the build finds it (JPIEDM_HAVE_ZLIB, JPIEDM_HAVE_ZSTD). Stored
+ * zip members never need either.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+namespace jpi_edm {
+
+/// How an input file is packaged, going by its first few bytes
+enum class InputFormat { RAW, GZIP, ZSTD, ZIP };
+
+[[nodiscard]] InputFormat detectInputFormat(const uint8_t *data, std::size_t size);
+
+/// Whether this build can unpack format. RAW always can; ZIP means deflated members.
+[[nodiscard]] bool canDecompress(InputFormat format);
+
+/// Gets the decompressed bytes a chunk at a time. A chunk is only valid during the call.
+using ByteSink = std::function<void(const uint8_t *data, std::size_t len)>;
+
+/// The CRC-32 zip uses, continuing from crc for the bytes before data
+[[nodiscard]] uint32_t crc32(const uint8_t *data, std::size_t len, uint32_t crc = 0);
+
+/// A gzip or zstd stream, decompressed as it's written
+class Decompressor
+{
+  public:
+    virtual ~Decompressor() = default;
+
+    /**
+     * @throws std::runtime_error if format isn't GZIP or ZSTD, or this build
+     * can't decompress it
+     */
+    [[nodiscard]] static std::unique_ptr<Decompressor> create(InputFormat format);
+
+    /// Decompress the next len bytes of the stream, passing sink whatever they decompress to
+    virtual void write(const uint8_t *data, std::size_t len, const ByteSink &sink) = 0;
+
+    /// End of the compressed stream. Throws if it stopped partway through.
+    virtual void finish(const ByteSink &sink) = 0;
+};
+
+/**
+ * Read stream to the end a chunk at a time and pass the file's bytes to
+ * sink, decompressing them first if they're gzip or zstd compressed.
+ *
+ * @throws std::runtime_error if stream is a zip archive (see ZipArchive),
+ * can't be decompressed, or ends partway through a compressed stream
+ */
+void readDecompressed(std::istream &stream, const ByteSink &sink);
+void readDecompressed(const uint8_t *data, std::size_t size, const ByteSink &sink);
+
+/**
+ * The members of a zip archive, found from its central directory. Members
+ * are read straight out of the archive's bytes, which must outlive it.
+ * Zip64 archives and encrypted members aren't supported.
+ */
+class ZipArchive
+{
+  public:
+    struct Entry {
+        std::string name;
+        uint16_t method{0}; ///< 0 stored, 8 deflated
+        uint16_t flags{0};
+        uint32_t crc32{0};
+        uint32_t compressedSize{0};
+        uint32_t size{0};
+        uint32_t localHeaderOffset{0};
+    };
+
+    /// @throws std::runtime_error if the bytes aren't a zip archive this can read
+    ZipArchive(const uint8_t *data, std::size_t size);
+    explicit ZipArchive(const MappedFile &file) : ZipArchive(file.data(), file.size()) {}
+
+    [[nodiscard]] const std::vector<Entry> &entries() const { return m_entries; }
+
+    /// The entries whose names end in .jpi, in any case, in archive order
+    [[nodiscard]] std::vector<Entry> jpiEntries() const;
+
+    /**
+     * Pass entry's contents to sink a chunk at a time, inflating them if
+     * they're deflated.
+     *
+     * @throws std::runtime_error if the entry can't be read, or its size or
+     * CRC doesn't match the central directory's
+     */
+    void read(const Entry &entry, const ByteSink &sink) const;
+
+  private:
+    const uint8_t *m_data;
+    std::size_t m_size;
+    std::vector<Entry> m_entries;
+};
+
+} // namespace jpi_edm
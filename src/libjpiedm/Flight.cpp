@@ -8,74 +8,59 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
+#include <optional>
 #include <unordered_map>
 #include <utility>
-#include <vector>
 
+#include "BitOps.hpp"
 #include "Flight.hpp"
 #include "ProtocolConstants.hpp"
 
+namespace jpi_edm {
+
+// #define DEBUG_FLIGHT_RECORD
+
 namespace {
 
-bool isSecondEngineMetric(jpi_edm::MetricId metricId)
+// The EGTs DIF1 and DIF2 are worked out from
+const MetricId ENGINE1_EGTS[MAX_CYLINDERS_PER_ENGINE] = {EGT11, EGT12, EGT13, EGT14, EGT15,
+                                                         EGT16, EGT17, EGT18, EGT19};
+const MetricId ENGINE2_EGTS[MAX_CYLINDERS_PER_ENGINE] = {EGT21, EGT22, EGT23, EGT24, EGT25,
+                                                         EGT26, EGT27, EGT28, EGT29};
+
+// The spread between an engine's hottest and coolest EGT, if at least two are reading
+std::optional<float> egtSpread(const MetricValues &values, const MetricId (&egts)[MAX_CYLINDERS_PER_ENGINE],
+                               int numCylinders)
 {
-    using namespace jpi_edm;
-    switch (metricId) {
-    case EGT21:
-    case EGT22:
-    case EGT23:
-    case EGT24:
-    case EGT25:
-    case EGT26:
-    case EGT27:
-    case EGT28:
-    case EGT29:
-    case CHT21:
-    case CHT22:
-    case CHT23:
-    case CHT24:
-    case CHT25:
-    case CHT26:
-    case CHT27:
-    case CHT28:
-    case CHT29:
-    case CLD2:
-    case TIT21:
-    case TIT22:
-    case OILT2:
-    case OILP2:
-    case CRB2:
-    case IAT2:
-    case MAP2:
-    case FF21:
-    case FF22:
-    case FUSD21:
-    case FUSD22:
-    case FP2:
-    case HP2:
-    case RPM2:
-    case HRS2:
-    case TORQ2:
-        return true;
-    default:
-        return false;
+    std::array<float, MAX_CYLINDERS_PER_ENGINE> egtValues;
+    std::size_t egtCount = 0;
+    for (int i = 0; i < numCylinders && i < MAX_CYLINDERS_PER_ENGINE; ++i) {
+        auto it = values.find(egts[i]);
+        if (it != values.end() && it->second > 0) {
+            egtValues[egtCount++] = it->second;
+        }
     }
+    if (egtCount < 2) {
+        return std::nullopt;
+    }
+    auto bounds = std::minmax_element(egtValues.begin(), egtValues.begin() + egtCount);
+    return *bounds.second - *bounds.first;
 }
 
 } // namespace
 
-namespace jpi_edm {
-
-// #define DEBUG_FLIGHT_RECORD
+Flight::Flight(const std::shared_ptr<Metadata> &metadata) : Flight(metadata, std::nullopt) {}
 
 // Figure out which version of the metrics to use (V1, V2, etc),
 // and set the initial values.
-Flight::Flight(const std::shared_ptr<Metadata> &metadata) : m_metadata(metadata)
+Flight::Flight(const std::shared_ptr<Metadata> &metadata, const std::optional<MetricSet> &selection)
+    : m_metadata(metadata), m_bit2MetricMap(Metrics::getBitToMetricMap(metadata->ProtoVersion())),
+      m_decodeTable(Metrics::getDecodeTable(metadata->ProtoVersion())),
+      m_recordCodec(recordCodec(metadata->RecordMaskSize())), m_metricSelection(selection)
 {
-    m_bit2MetricMap = Metrics::getBitToMetricMap(m_metadata->ProtoVersion());
-
 #ifdef DEBUG_FLIGHT_RECORD
     std::cout << "Using map for proto " << m_metadata->ProtoVersion() << "\n";
 #endif
@@ -84,6 +69,27 @@ Flight::Flight(const std::shared_ptr<Metadata> &metadata) : m_metadata(metadata)
         m_supportedMetrics.insert(metric.getMetricId());
     }
 
+    if (m_metricSelection) {
+        for (auto [dif, egts] : {std::make_pair(DIF1, &ENGINE1_EGTS), std::make_pair(DIF2, &ENGINE2_EGTS)}) {
+            if (m_metricSelection->contains(dif)) {
+                for (auto egt : *egts) {
+                    m_metricSelection->insert(egt);
+                }
+            }
+        }
+        m_computeDif1 = m_metricSelection->contains(DIF1);
+        m_computeDif2 = m_metricSelection->contains(DIF2);
+    }
+
+    for (int bitIdx = 0; bitIdx < MAX_METRIC_FIELDS; ++bitIdx) {
+        const MetricDecodeEntry &entry = m_decodeTable[bitIdx];
+        if (!entry.isValid) {
+            continue;
+        }
+        m_secondEngineFields.set(bitIdx, entry.isSecondEngine);
+        m_decodedFields.set(bitIdx, !m_metricSelection || m_metricSelection->contains(entry.metricId));
+    }
+
 #ifdef DEBUG_FLIGHT_RECORD
     std::cout << "Using map for proto " << m_metadata->ProtoVersion() << "\n";
 #endif
@@ -92,6 +98,9 @@ Flight::Flight(const std::shared_ptr<Metadata> &metadata) : m_metadata(metadata)
 #ifdef DEBUG_FLIGHT_RECORD
         std::cout << "[" << bitidx << "] ==> " << metric.getShortName() << "\n";
 #endif
+        if (m_metricSelection && !m_metricSelection->contains(metric.getMetricId())) {
+            continue;
+        }
         m_metricValues[metric.getMetricId()] = metric.getInitialValue();
         if ((metric.getScaleFactor() == Metric::ScaleFactor::TEN) ||
             (metric.getScaleFactor() == Metric::ScaleFactor::TEN_IF_GPH && isGPH)) {
@@ -100,8 +109,12 @@ Flight::Flight(const std::shared_ptr<Metadata> &metadata) : m_metadata(metadata)
     }
 
     // derived data that's not in the bit map
-    m_metricValues[DIF1] = 0;
-    m_metricValues[DIF2] = 0;
+    if (m_computeDif1) {
+        m_metricValues[DIF1] = 0;
+    }
+    if (m_computeDif2) {
+        m_metricValues[DIF2] = 0;
+    }
 
 #ifdef DEBUG_FLIGHT_RECORD
     std::cout << "Initial metric values:\n";
@@ -115,37 +128,35 @@ Flight::Flight(const std::shared_ptr<Metadata> &metadata) : m_metadata(metadata)
 // Here, we update the m_metricValues with that by adding it to the
 // previous and scaling it.
 // We also calculate any derived values.
-void Flight::updateMetrics(const std::map<int, int> &valuesMap)
+void Flight::updateMetrics(const RecordDeltas &deltas)
 {
     m_lastUpdatedMetrics.clear();
-    bool isGPH = m_metadata->IsGPH();
-    for (const auto &[bitIdx, bitValue] : valuesMap) {
-        auto it = m_bit2MetricMap.find(bitIdx);
+    if (m_metadata && !m_metadata->m_configInfo.isTwin && (deltas.present() & m_secondEngineFields).any()) {
+        m_metadata->m_configInfo.isTwin = true;
+    }
+
+    // High bytes are picked up with their low byte, and unselected metrics
+    // aren't accumulated at all
+    const RecordDeltas::Bits fields = deltas.present() & m_decodedFields;
+    const int gphIdx = m_metadata->IsGPH() ? 1 : 0;
+    forEachSetBit(fields, [&](int bitIdx) {
+        int bitValue = deltas[bitIdx];
+        const MetricDecodeEntry &entry = m_decodeTable[bitIdx];
 #ifdef DEBUG_FLIGHT_RECORD
         std::cout << "[" << std::setw(3) << std::right << std::setfill('0') << bitIdx << "] ";
 #endif
-        if (it == m_bit2MetricMap.end()) {
-#ifdef DEBUG_FLIGHT_RECORD
-            std::cout << "highval, skipped\n";
-#endif
-            // if not found, the bitIdx is probably pointing at a high byte and
-            // we'll handle that when we do the low byte;
-            continue;
-        }
 
 #ifdef DEBUG_FLIGHT_RECORD
         std::cout << "lowval, " << std::left << std::setw(10) << std::setfill(' ') << bitValue;
 #endif
         int value = bitValue;
-        auto highByteBitIdx = it->second.getHighByteBitIdx();
-        if (highByteBitIdx.has_value()) {
+        if (entry.highByteBitIdx >= 0) {
 #ifdef DEBUG_FLIGHT_RECORD
-            std::cout << "ORing with high at [" << highByteBitIdx.value() << "]";
+            std::cout << "ORing with high at [" << static_cast<int>(entry.highByteBitIdx) << "]";
 #endif
-            // Use C++17 if-with-initializer to avoid double lookup
-            if (auto it = valuesMap.find(highByteBitIdx.value()); it != valuesMap.end()) {
+            if (deltas.contains(entry.highByteBitIdx)) {
                 // yup, there's a high byte
-                int highByte = it->second;
+                int highByte = deltas[entry.highByteBitIdx];
                 bool isNegative = (value < 0);
                 if (isNegative) {
                     value = 0 - value; // make it positive to make the bitshift easier
@@ -161,18 +172,13 @@ void Flight::updateMetrics(const std::map<int, int> &valuesMap)
 #endif
 
         float scaledValue = value;
-        auto metric = it->second;
-        if ((metric.getScaleFactor() == Metric::ScaleFactor::TEN) ||
-            (metric.getScaleFactor() == Metric::ScaleFactor::TEN_IF_GPH && isGPH)) {
-            scaledValue /= METRIC_SCALE_DIVISOR;
-        }
+        scaledValue /= entry.scaleDivisor[gphIdx];
 
+        auto metricId = entry.metricId;
 #ifdef DEBUG_FLIGHT_RECORD
-        std::cout << ", [" << it->second.getShortName() << "] -> " << m_metricValues[it->second.getMetricId()] << " + "
-                  << scaledValue << " == ";
+        std::cout << ", [" << metricId << "] -> " << m_metricValues[metricId] << " + " << scaledValue << " == ";
 #endif
-        auto metricId = it->second.getMetricId();
-        if (metricId == LAT || metricId == LNG) {
+        if (entry.isGps) {
             float rawAccum = m_rawGpsValues[metricId];
             int delta = static_cast<int>(std::lround(scaledValue));
             int baselineOffset = m_gpsBaselineOffsets[metricId];
@@ -201,65 +207,51 @@ void Flight::updateMetrics(const std::map<int, int> &valuesMap)
         }
         m_lastUpdatedMetrics.insert(metricId);
 #ifdef DEBUG_FLIGHT_RECORD
-        std::cout << m_metricValues[it->second.getMetricId()] << "\n";
+        std::cout << m_metricValues[metricId] << "\n";
 #endif
-
-        if (m_metadata && !m_metadata->m_configInfo.isTwin && isSecondEngineMetric(metricId)) {
-            m_metadata->m_configInfo.isTwin = true;
-        }
-    }
+    });
 
     // Now do derived values
 
-    // Calculate DIF1 (differential between hottest and coolest EGT for engine 1)
-    // DIF represents the spread in exhaust gas temperatures across cylinders
+    // DIF1/DIF2: the spread between the hottest and coolest EGT on each engine
     int numCylinders = m_metadata->NumCylinders();
-    if (numCylinders > 0) {
-        std::vector<float> egtValues;
-        egtValues.reserve(numCylinders);
-
-        // Collect all EGT values for active cylinders on engine 1
-        const MetricId egtMetrics[] = {MetricId::EGT11, MetricId::EGT12, MetricId::EGT13,
-                                       MetricId::EGT14, MetricId::EGT15, MetricId::EGT16,
-                                       MetricId::EGT17, MetricId::EGT18, MetricId::EGT19};
-
-        for (int i = 0; i < numCylinders && i < 9; ++i) {
-            auto it = m_metricValues.find(egtMetrics[i]);
-            if (it != m_metricValues.end() && it->second > 0) {
-                egtValues.push_back(it->second);
-            }
+    if (m_computeDif1 && numCylinders > 0) {
+        if (auto spread = egtSpread(m_metricValues, ENGINE1_EGTS, numCylinders)) {
+            m_metricValues[MetricId::DIF1] = *spread;
         }
-
-        // Calculate DIF1 only if we have at least 2 EGT readings
-        if (egtValues.size() >= 2) {
-            auto bounds = std::minmax_element(egtValues.begin(), egtValues.end());
-            m_metricValues[MetricId::DIF1] = *bounds.second - *bounds.first;
+    }
+    if (m_computeDif2 && m_metadata->IsTwin() && numCylinders > 0) {
+        if (auto spread = egtSpread(m_metricValues, ENGINE2_EGTS, numCylinders)) {
+            m_metricValues[MetricId::DIF2] = *spread;
         }
     }
+}
 
-    // Calculate DIF2 for twin-engine aircraft (engine 2)
-    if (m_metadata->IsTwin() && numCylinders > 0) {
-        std::vector<float> egtValues;
-        egtValues.reserve(numCylinders);
-
-        // Collect all EGT values for active cylinders on engine 2
-        const MetricId egtMetrics[] = {MetricId::EGT21, MetricId::EGT22, MetricId::EGT23,
-                                       MetricId::EGT24, MetricId::EGT25, MetricId::EGT26,
-                                       MetricId::EGT27, MetricId::EGT28, MetricId::EGT29};
+void Flight::beginRecord()
+{
+    if (m_flightHeader) {
+        m_recordTime = (m_recordSeq == 0) ? m_flightHeader->startTime() : m_recordTime + secondsToNextRecord();
+    }
+    ++m_recordSeq;
+}
 
-        for (int i = 0; i < numCylinders && i < 9; ++i) {
-            auto it = m_metricValues.find(egtMetrics[i]);
-            if (it != m_metricValues.end() && it->second > 0) {
-                egtValues.push_back(it->second);
-            }
-        }
+Flight::State Flight::saveState() const
+{
+    return State{m_recordSeq,         m_fastFlag,     m_stdRecCount,        m_fastRecCount, m_metricValues,
+                 m_lastUpdatedMetrics, m_rawGpsValues, m_gpsBaselineOffsets, m_recordTime};
+}
 
-        // Calculate DIF2 only if we have at least 2 EGT readings
-        if (egtValues.size() >= 2) {
-            auto bounds = std::minmax_element(egtValues.begin(), egtValues.end());
-            m_metricValues[MetricId::DIF2] = *bounds.second - *bounds.first;
-        }
-    }
+void Flight::restoreState(const State &state)
+{
+    m_recordSeq = state.recordSeq;
+    m_fastFlag = state.fastFlag;
+    m_stdRecCount = state.stdRecCount;
+    m_fastRecCount = state.fastRecCount;
+    m_metricValues = state.metricValues;
+    m_lastUpdatedMetrics = state.lastUpdatedMetrics;
+    m_rawGpsValues = state.rawGpsValues;
+    m_gpsBaselineOffsets = state.gpsBaselineOffsets;
+    m_recordTime = state.recordTime;
 }
 
 std::shared_ptr<FlightMetricsRecord> Flight::getFlightMetricsRecord()
@@ -269,4 +261,13 @@ std::shared_ptr<FlightMetricsRecord> Flight::getFlightMetricsRecord()
                                                  m_supportedMetrics);
 }
 
+void Flight::copyFlightMetricsRecord(FlightMetricsRecord &record) const
+{
+    record.m_isFast = m_fastFlag;
+    record.m_recordSeq = m_recordSeq;
+    record.m_metrics = m_metricValues;
+    record.m_updatedMetrics = m_lastUpdatedMetrics;
+    record.m_supportedMetrics = m_supportedMetrics;
+}
+
 } // namespace jpi_edm
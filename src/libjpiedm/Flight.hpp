@@ -10,16 +10,21 @@
 #pragma once
 
 #include <bitset>
+#include <cstddef>
 #include <cstdint>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 
 #include "Metadata.hpp"
+#include "MetricValues.hpp"
 #include "Metrics.hpp"
+#include "RecordDecoder.hpp"
+#include "RecordDeltas.hpp"
 
 namespace jpi_edm {
 
@@ -53,6 +58,17 @@ class FlightHeader
                   << "\n    time: " << std::put_time(&local, "%T") << "\n";
     }
 
+    /// When the flight's first record was logged, as a UTC time_t
+    [[nodiscard]] std::time_t startTime() const
+    {
+        std::tm dateCopy = startDate; // timegm may modify the struct, so make a copy
+#ifdef _WIN32
+        return _mkgmtime(&dateCopy);
+#else
+        return timegm(&dateCopy);
+#endif
+    }
+
   public:
     unsigned int flight_num; // matches what's in the $D record
     uint32_t flags;          // matches the flags in the $C record
@@ -71,15 +87,23 @@ class FlightHeader
 class FlightMetricsRecord
 {
   public:
+    FlightMetricsRecord(bool isFast, unsigned long recordSeq, const MetricValues &metrics,
+                        const MetricSet &updatedMetrics, const MetricSet &supportedMetrics)
+        : m_isFast(isFast), m_recordSeq(recordSeq), m_metrics(metrics), m_updatedMetrics(updatedMetrics),
+          m_supportedMetrics(supportedMetrics)
+    {
+    }
+
+    // Compatibility constructors for callers that build records from std::map/std::set
     FlightMetricsRecord(bool isFast, unsigned long recordSeq, const std::map<MetricId, float> &metricMap)
-        : FlightMetricsRecord(isFast, recordSeq, metricMap, std::set<MetricId>{}, std::set<MetricId>{})
+        : FlightMetricsRecord(isFast, recordSeq, MetricValues(metricMap), MetricSet{}, MetricSet{})
     {
     }
 
     FlightMetricsRecord(bool isFast, unsigned long recordSeq, const std::map<MetricId, float> &metricMap,
                         const std::set<MetricId> &updatedMetrics, const std::set<MetricId> &supportedMetrics)
-        : m_isFast(isFast), m_recordSeq(recordSeq), m_metrics(metricMap), m_updatedMetrics(updatedMetrics),
-          m_supportedMetrics(supportedMetrics)
+        : FlightMetricsRecord(isFast, recordSeq, MetricValues(metricMap), MetricSet(updatedMetrics),
+                              MetricSet(supportedMetrics))
     {
     }
     virtual ~FlightMetricsRecord() = default;
@@ -93,9 +117,50 @@ class FlightMetricsRecord
   public:
     bool m_isFast{false};
     unsigned long m_recordSeq{0};
-    std::map<MetricId, float> m_metrics;
-    std::set<MetricId> m_updatedMetrics;
-    std::set<MetricId> m_supportedMetrics;
+    MetricValues m_metrics;
+    MetricSet m_updatedMetrics;
+    MetricSet m_supportedMetrics;
+};
+
+/**
+ * A read-only look at the record a Flight has just decoded, without copying
+ * it. The view points into the Flight's running state, so it's only valid
+ * until the next record is decoded; use toRecord() to keep one.
+ */
+class FlightRecordView
+{
+  public:
+    FlightRecordView(bool isFast, unsigned long recordSeq, const MetricValues &metrics,
+                     const MetricSet &updatedMetrics, const MetricSet &supportedMetrics, std::time_t time = 0)
+        : m_isFast(isFast), m_recordSeq(recordSeq), m_time(time), m_metrics(&metrics),
+          m_updatedMetrics(&updatedMetrics), m_supportedMetrics(&supportedMetrics)
+    {
+    }
+
+    [[nodiscard]] bool isFast() const { return m_isFast; }
+    [[nodiscard]] unsigned long recordSeq() const { return m_recordSeq; }
+    /// When the record was logged, as a UTC time_t
+    [[nodiscard]] std::time_t time() const { return m_time; }
+
+    /// Every metric's current value, not just the ones this record changed
+    [[nodiscard]] const MetricValues &metrics() const { return *m_metrics; }
+    /// The metrics this record changed
+    [[nodiscard]] const MetricSet &updatedMetrics() const { return *m_updatedMetrics; }
+    [[nodiscard]] const MetricSet &supportedMetrics() const { return *m_supportedMetrics; }
+
+    /// A copy of the record that outlives the view
+    [[nodiscard]] FlightMetricsRecord toRecord() const
+    {
+        return FlightMetricsRecord(m_isFast, m_recordSeq, *m_metrics, *m_updatedMetrics, *m_supportedMetrics);
+    }
+
+  private:
+    bool m_isFast;
+    unsigned long m_recordSeq;
+    std::time_t m_time;
+    const MetricValues *m_metrics;
+    const MetricSet *m_updatedMetrics;
+    const MetricSet *m_supportedMetrics;
 };
 
 class Flight
@@ -103,6 +168,14 @@ class Flight
   public:
     Flight() = delete;
     explicit Flight(const std::shared_ptr<Metadata> &metadata);
+    /**
+     * A Flight that only keeps track of some metrics. Record fields for any
+     * other metric are still read past, but not accumulated, and the other
+     * metrics don't appear in m_metricValues or the records made from it.
+     * DIF1 and DIF2 are the spread of an engine's EGTs, so selecting one
+     * selects that engine's EGTs too. No selection means every metric.
+     */
+    Flight(const std::shared_ptr<Metadata> &metadata, const std::optional<MetricSet> &selection);
     virtual ~Flight() = default;
 
     // Explicitly handle copy and move operations (non-copyable and non-move-assignable due to const member)
@@ -113,36 +186,109 @@ class Flight
 
     void setFastFlag(bool flag) { m_fastFlag = flag; }
     void incrementSequence() { ++m_recordSeq; }
-    void updateMetrics(const std::map<int, int> &values);
+    /**
+     * Move on to the next record: bump the sequence number and work out when
+     * the record was logged. The first is logged at the header's start time,
+     * and each one after that the interval later, or a second later in fast
+     * mode. Call before the record's mark changes the fast flag.
+     */
+    void beginRecord();
+    void updateMetrics(const RecordDeltas &deltas);
+    void updateMetrics(const std::map<int, int> &values) { updateMetrics(RecordDeltas(values)); }
 
     [[nodiscard]] std::shared_ptr<FlightMetricsRecord> getFlightMetricsRecord();
+    /// Overwrite record with the last decoded record, reusing its storage
+    void copyFlightMetricsRecord(FlightMetricsRecord &record) const;
+    /// The last decoded record, in place. Valid until the next updateMetrics().
+    [[nodiscard]] FlightRecordView recordView() const
+    {
+        return FlightRecordView(m_fastFlag, m_recordSeq, m_metricValues, m_lastUpdatedMetrics, m_supportedMetrics,
+                                m_recordTime);
+    }
     [[nodiscard]] bool isMetricSupported(MetricId metricId) const { return m_supportedMetrics.count(metricId) > 0; }
+    /// The metrics this Flight was limited to, with DIF1/DIF2's EGTs added; empty if it wasn't
+    [[nodiscard]] const std::optional<MetricSet> &metricSelection() const { return m_metricSelection; }
+
+    /// Seconds from the last decoded record to the next one
+    [[nodiscard]] std::time_t secondsToNextRecord() const
+    {
+        return m_fastFlag ? 1 : static_cast<std::time_t>(m_flightHeader->interval);
+    }
+
+    /**
+     * Everything that carries over from one record to the next. Records are
+     * deltas from the one before, so restoring the state saved after record
+     * n lets decoding resume at record n + 1 without replaying the others.
+     */
+    struct State {
+        unsigned long recordSeq{0};
+        bool fastFlag{false};
+        unsigned long stdRecCount{0};
+        unsigned long fastRecCount{0};
+        MetricValues metricValues;
+        MetricSet lastUpdatedMetrics;
+        std::map<MetricId, float> rawGpsValues;
+        std::map<MetricId, int> gpsBaselineOffsets;
+        std::time_t recordTime{0};
+    };
+
+    [[nodiscard]] State saveState() const;
+    void restoreState(const State &state);
 
   public:
     unsigned long m_recordSeq{0};
     bool m_fastFlag{false};
     unsigned long m_stdRecCount{0};
     unsigned long m_fastRecCount{0};
+    std::time_t m_recordTime{0}; // when the last record started by beginRecord() was logged
 
     const std::shared_ptr<Metadata> m_metadata;
     std::shared_ptr<FlightHeader> m_flightHeader;
 
-    // This is a fairly static object that is created when the file
-    // is first opened. It is a map of bit offsets to Metric objects.
+    // This is a fairly static object, shared by every flight with the same
+    // protocol version. It is a map of bit offsets to Metric objects.
     // Note that only the low-byte offset of multiple-byte items will
     // have an entry here.
-    std::map<int, Metric> m_bit2MetricMap;
+    const std::map<int, Metric> &m_bit2MetricMap;
+
+    // The same information flattened into an array indexed by bit offset,
+    // which is what updateMetrics() actually decodes with.
+    const MetricDecodeTable &m_decodeTable;
+
+    // How this flight's data records are laid out, picked from the protocol
+    // version once here rather than for every record.
+    const RecordCodec &m_recordCodec;
 
     // This is the running total, updated each time a data row is read
     // out of the file. It is keyed on MetricId. Items are:
     // - Initialized according to Metric.InitValue,
     // - Scaled according to Metric.ScaleFactor,
     // - and derived data is calculated (Min/Max elements, for example)
-    std::map<MetricId, float> m_metricValues;
-    std::set<MetricId> m_lastUpdatedMetrics;
+    MetricValues m_metricValues;
+    MetricSet m_lastUpdatedMetrics;
     std::map<MetricId, float> m_rawGpsValues;
     std::map<MetricId, int> m_gpsBaselineOffsets;
-    std::set<MetricId> m_supportedMetrics;
+    MetricSet m_supportedMetrics;
+
+  private:
+    std::optional<MetricSet> m_metricSelection;
+
+    // The low-byte fields updateMetrics() accumulates, and the ones that
+    // mean the file is from a twin, by bit index
+    RecordDeltas::Bits m_decodedFields;
+    RecordDeltas::Bits m_secondEngineFields;
+    bool m_computeDif1{true};
+    bool m_computeDif2{true};
+};
+
+/**
+ * A Flight's state at a record boundary, so decoding can pick up there.
+ */
+struct RecordCheckpoint {
+    std::size_t recordIndex{0}; ///< Records decoded before this point; the next record's index
+    std::streamoff offset{0};   ///< File offset of the next record
+    std::time_t time{0};        ///< When the next record was logged
+    Flight::State state;        ///< The Flight's state after the records before this point
 };
 
 } // namespace jpi_edm
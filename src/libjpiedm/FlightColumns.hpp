@@ -0,0 +1,67 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief A whole flight decoded into columns (structure-of-arrays).
+ *
+ * FlightFile::loadFlightColumns() fills one of these by decoding a flight's
+ * records straight into contiguous per-metric vectors, with no per-record
+ * objects. Row i of every column is the i'th data record of the flight.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "Flight.hpp"
+#include "MetricId.hpp"
+#include "MetricValues.hpp"
+
+namespace jpi_edm {
+
+class FlightColumns
+{
+  public:
+    /// Number of records (rows) in the flight
+    [[nodiscard]] std::size_t size() const { return m_timestamps.size(); }
+    [[nodiscard]] bool empty() const { return m_timestamps.empty(); }
+
+    [[nodiscard]] bool hasColumn(MetricId id) const { return m_metrics.contains(id); }
+
+    /// The values of one metric, one per record. Throws std::out_of_range if it wasn't loaded.
+    [[nodiscard]] const std::vector<float> &column(MetricId id) const
+    {
+        if (!hasColumn(id)) {
+            std::stringstream msg;
+            msg << "FlightColumns: metric " << static_cast<int>(id) << " wasn't loaded";
+            throw std::out_of_range(msg.str());
+        }
+        return m_columns[id];
+    }
+
+    /// The metrics that have columns
+    [[nodiscard]] const MetricSet &metrics() const { return m_metrics; }
+
+  public:
+    std::shared_ptr<FlightHeader> m_header;
+
+    // Per-record time (UTC seconds since the epoch). The first record is at
+    // the flight's start time; each record after that is 1 second later if
+    // the previous record was a fast one, and m_header->interval otherwise.
+    std::vector<std::time_t> m_timestamps;
+
+    // 1 for records logged in fast mode, 0 otherwise
+    std::vector<std::uint8_t> m_isFast;
+
+    // Indexed by MetricId; only the ids in m_metrics have data.
+    MetricSet m_metrics;
+    std::array<std::vector<float>, METRIC_ID_COUNT> m_columns;
+};
+
+} // namespace jpi_edm
@@ -7,16 +7,19 @@
  */
 
 #include <algorithm>
-#include <bitset>
+#include <array>
+#include <atomic>
 #include <cctype>
 #include <cstring>
+#include <exception>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
-#include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -32,13 +35,19 @@
 #include <limits.h>
 #include <stdio.h>
 
+#include "ByteReader.hpp"
+#include "ByteSource.hpp"
+#include "CompressedInput.hpp"
 #include "FileHeaders.hpp"
 #include "Flight.hpp"
 #include "FlightFile.hpp"
+#include "FlightIndexFile.hpp"
 #include "FlightIterator.hpp"
 #include "Metadata.hpp"
 #include "MetricId.hpp"
 #include "ProtocolConstants.hpp"
+#include "RecordDecoder.hpp"
+#include "RecordDeltas.hpp"
 
 namespace jpi_edm {
 
@@ -50,8 +59,6 @@ namespace jpi_edm {
 // #define DEBUG_FLIGHT_HEADERS
 #endif
 
-static const int MARK_IDX = 16; // bit index for fast/slow recording mode
-
 // Use constant from ProtocolConstants.hpp
 const int maxheaderlen = MAX_HEADER_LINE_LENGTH;
 
@@ -83,6 +90,11 @@ void FlightFile::setFlightRecordCompletionCb(std::function<void(std::shared_ptr<
     m_flightRecCompletionCb = cb;
 }
 
+void FlightFile::setFlightRecordViewCb(std::function<void(const FlightRecordView &)> cb)
+{
+    m_flightRecViewCb = cb;
+}
+
 void FlightFile::setFlightCompletionCb(std::function<void(unsigned long, unsigned long)> cb)
 {
     m_flightCompletionCb = cb;
@@ -90,10 +102,70 @@ void FlightFile::setFlightCompletionCb(std::function<void(unsigned long, unsigne
 
 void FlightFile::setFileFooterCompletionCb(std::function<void(void)> cb) { m_fileFooterCompletionCb = cb; }
 
+void FlightFile::setMetricSelection(const MetricSet &metrics)
+{
+    m_metricSelection = metrics.empty() ? std::nullopt : std::optional<MetricSet>(metrics);
+}
+
+void FlightFile::setRecordFilter(std::function<bool(const FlightRecordView &)> filter)
+{
+    m_recordFilter = filter;
+}
+
+void FlightFile::setTimeWindow(std::time_t from, std::time_t to) { m_timeWindow = std::make_pair(from, to); }
+
+void FlightFile::clearRecordFilters()
+{
+    m_recordFilter = nullptr;
+    m_timeWindow.reset();
+}
+
+bool FlightFile::wantsRecord(const Flight &flight) const
+{
+    if (m_timeWindow && (flight.m_recordTime < m_timeWindow->first || flight.m_recordTime >= m_timeWindow->second)) {
+        return false;
+    }
+    return !m_recordFilter || m_recordFilter(flight.recordView());
+}
+
+std::shared_ptr<Flight> FlightFile::makeFlight(const std::shared_ptr<Metadata> &metadata) const
+{
+    return std::make_shared<Flight>(metadata, m_metricSelection);
+}
+
 namespace {
 struct HeaderChecksumError : public std::invalid_argument {
     using std::invalid_argument::invalid_argument;
 };
+
+// The $D record's word count as the byte limit the parse loops use,
+// measured from the start of the flight header.
+std::streamoff flightByteBudget(long dataCount)
+{
+    // Validate flight data count
+    if (dataCount < 1 || dataCount > MAX_FLIGHT_DATA_WORDS) {
+        std::stringstream msg;
+        msg << "Invalid flight data count: " << dataCount;
+        throw std::runtime_error(msg.str());
+    }
+    return static_cast<std::streamoff>(dataCount - 1L) * 2;
+}
+
+// Clears a callback for as long as it's in scope, then puts it back, even if
+// parsing throws in between.
+template <typename Callback> class SuspendedCallback
+{
+  public:
+    explicit SuspendedCallback(Callback &cb) : m_cb(cb), m_saved(std::move(cb)) { m_cb = nullptr; }
+    ~SuspendedCallback() { m_cb = std::move(m_saved); }
+
+    SuspendedCallback(const SuspendedCallback &) = delete;
+    SuspendedCallback &operator=(const SuspendedCallback &) = delete;
+
+  private:
+    Callback &m_cb;
+    Callback m_saved;
+};
 } // namespace
 
 /**
@@ -188,7 +260,7 @@ void FlightFile::validateHeaderChecksum(int lineno, const char *line)
     }
 }
 
-void FlightFile::parseFileHeaders(std::istream &stream, bool strictChecksums)
+void FlightFile::parseFileHeaders(ByteSource &src, bool strictChecksums)
 {
     int lineno = 0;
     bool end_of_headers = false;
@@ -201,17 +273,23 @@ void FlightFile::parseFileHeaders(std::istream &stream, bool strictChecksums)
     m_flightDataCounts.clear();
 
     // line is terminated with CRLF (\r\n)
-    // read to the LF (\n) (getline won't include the LF in the return)
+    // read to the LF (\n), which isn't copied into the buffer. Like
+    // getline(), allow at most maxheaderlen - 1 characters before it.
     std::unique_ptr<char[]> buffer(new char[HEADER_BUFFER_SIZE]);
-    while (stream.good() && !end_of_headers) {
+    while (!end_of_headers) {
         lineno++;
 
-        stream.getline(buffer.get(), maxheaderlen);
-        if (!stream.good()) {
+        auto reader = src.peek(maxheaderlen);
+        const void *lf = (reader.size() > 0) ? std::memchr(reader.data(), '\n', reader.size()) : nullptr;
+        if (!lf) {
             std::stringstream msg;
             msg << "Couldn't read stream: line " << lineno;
             throw std::runtime_error{msg.str()};
         }
+        auto lineLen = static_cast<std::size_t>(static_cast<const uint8_t *>(lf) - reader.data());
+        std::memcpy(buffer.get(), reader.data(), lineLen);
+        buffer[lineLen] = '\0';
+        src.consume(lineLen + 1);
 
         char *line = buffer.get();
 
@@ -321,115 +399,54 @@ void FlightFile::parseFileHeaders(std::istream &stream, bool strictChecksums)
     }
 }
 
-void FlightFile::parseFileFooters(std::istream &stream)
+void FlightFile::parseFileFooters(ByteSource &src)
 {
     if (m_fileFooterCompletionCb) {
         m_fileFooterCompletionCb();
     }
 }
 
-bool FlightFile::validateBinaryChecksum(std::istream &stream, std::iostream::off_type startOff,
-                                        std::iostream::off_type endOff, unsigned char checksum)
+// Finds the largest possible header size for which the byte that follows
+// the header is a valid checksum of the header. The candidates are checked
+// in one pass, each extending the running checksum of the one before.
+std::optional<std::streamoff> FlightFile::detectFlightHeaderSize(ByteSource &src)
 {
-    auto curLoc{stream.tellg()};
-    if (curLoc == -1) {
-        throw std::runtime_error("Failed to get current stream position for checksum validation");
-    }
-
-    // checksum - go back to the start of the record and add or xor everything
-    // up to the end
-    unsigned char checksum_sum{0};
-    unsigned char checksum_xor{0};
-
-    stream.seekg(startOff);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to checksum start position");
-    }
-
-    auto len = endOff - startOff;
-    std::vector<char> buffer(len);
-    stream.read(buffer.data(), len);
-
-    if (!stream || stream.gcount() != len) {
-        std::stringstream msg;
-        msg << "Failed to read " << len << " bytes for checksum validation. " << "Read " << stream.gcount()
-            << " bytes instead.";
-        throw std::runtime_error(msg.str());
-    }
+    static_assert((MAX_FLIGHT_HEADER_SIZE - MIN_FLIGHT_HEADER_SIZE) % HEADER_SIZE_STEP == 0,
+                  "header size candidates must step evenly from the smallest to the largest");
+
+    auto reader = src.peek(MAX_FLIGHT_HEADER_SIZE + 1);
+    const uint8_t *bytes = reader.data();
+
+    std::optional<std::streamoff> headerSize;
+    BinaryChecksum checksum;
+    std::size_t summed = 0;
+    for (std::streamoff offset = MIN_FLIGHT_HEADER_SIZE; offset <= MAX_FLIGHT_HEADER_SIZE;
+         offset += HEADER_SIZE_STEP) {
+        auto len = static_cast<std::size_t>(offset);
+        if (len >= reader.size()) {
+            // past the end of the file, as are all the larger sizes
+            break;
+        }
 
-    for (const auto &byte : buffer) {
-        checksum_sum += static_cast<unsigned char>(byte);
-        checksum_xor ^= static_cast<unsigned char>(byte);
-    }
-    checksum_sum = -checksum_sum;
+        checksum.add(bytes + summed, len - summed);
+        summed = len;
 
 #ifdef DEBUG_FLIGHTS
-    std::cout << "checksum_sum: " << hex(checksum_sum) << "\n";
-    std::cout << "checksum_xor: " << hex(checksum_xor) << "\n";
-    std::cout << "stream checksum: " << hex(checksum) << "\n";
+        std::cout << "checksum_sum: " << hex(static_cast<uint8_t>(-checksum.sum)) << "\n";
+        std::cout << "checksum_xor: " << hex(checksum.xorSum) << "\n";
+        std::cout << "stream checksum: " << hex(bytes[len]) << "\n";
 #endif
-
-    stream.seekg(curLoc, std::ios_base::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to restore stream position after checksum validation");
-    }
-    if (checksum != checksum_sum && checksum != checksum_xor) {
-        return false;
-    }
-    return true;
-}
-
-// This scans the stream, adding bytes to it until a checksum matches
-std::optional<std::streamoff> FlightFile::detectFlightHeaderSize(std::istream &stream)
-{
-    auto startOff{stream.tellg()};
-    if (startOff == -1) {
-        throw std::runtime_error("Failed to get stream position for flight header detection");
-    }
-
-    std::streamoff offset;
-    unsigned char checksum;
-    for (offset = MAX_FLIGHT_HEADER_SIZE; offset >= MIN_FLIGHT_HEADER_SIZE; offset -= HEADER_SIZE_STEP) {
-        stream.clear(); // Clear any error flags from previous iterations
-        stream.seekg(startOff + offset, std::ios_base::beg);
-        if (!stream) {
-            // Seek failed (beyond EOF) - try next offset
-            continue;
-        }
-
-        stream.read(reinterpret_cast<char *>(&checksum), 1);
-        if (!stream || stream.gcount() != 1) {
-            // Read failed - try next offset
-            continue;
-        }
-
-        if (validateBinaryChecksum(stream, startOff, startOff + offset, checksum)) {
-            // reset the stream and return the found offset
-            stream.clear(); // Clear any error flags before final seek
-            stream.seekg(startOff, std::ios_base::beg);
-            if (!stream) {
-                throw std::runtime_error("Failed to reset stream position after finding header size");
-            }
-            return offset;
+        if (checksum.matches(bytes[len])) {
+            headerSize = offset;
         }
     }
 
-    // reset the stream and return nullopt if not found
-    stream.clear(); // Clear any error flags before final seek
-    stream.seekg(startOff, std::ios_base::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to reset stream position after header size detection");
-    }
-    return std::nullopt;
+    return headerSize;
 }
 
-std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(std::istream &stream, int flightId,
-                                                            std::streamoff headerSize)
+std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(ByteSource &src, int flightId, std::streamoff headerSize)
 {
-    auto startOff{stream.tellg()};
-    if (startOff == -1) {
-        throw std::runtime_error("Failed to get stream position for flight header parsing");
-    }
+    auto startOff{src.tell()};
 
 #ifdef DEBUG_FLIGHT_HEADERS
     std::cout << "Flight Header start offset: 0x" << std::hex << startOff << std::dec << std::endl;
@@ -437,16 +454,22 @@ std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(std::istream &stream
 
     auto flightHeader = std::make_shared<FlightHeader>();
 
-    stream.read(reinterpret_cast<char *>(&flightHeader->flight_num), 2);
-    if (!stream || stream.gcount() != 2) {
-        throw std::runtime_error("Failed to read flight number from header");
-    }
-    flightHeader->flight_num = ntohs(flightHeader->flight_num);
+    // The header and its checksum byte, all big-endian words
+    auto reader = src.peek(static_cast<std::size_t>(headerSize) + 1);
+    auto readWord = [&reader](const char *errorMsg) {
+        if (!reader.has(2)) {
+            throw std::runtime_error(errorMsg);
+        }
+        return reader.readU16BE();
+    };
+
+    flightHeader->flight_num = readWord("Failed to read flight number from header");
 
     if (!m_isLegacyModel && flightHeader->flight_num != flightId) {
         std::stringstream msg;
         msg << "Flight IDs don't match (expected " << flightId << ", got " << flightHeader->flight_num
-            << "). Offset: " << std::hex << (stream.tellg() - static_cast<std::streamoff>(4L));
+            << "). Offset: " << std::hex
+            << (startOff + static_cast<std::streamoff>(reader.position()) - static_cast<std::streamoff>(4L));
 #ifdef DEBUG_FLIGHT_HEADERS
         std::cout << msg.str() << std::endl;
 #endif
@@ -457,29 +480,24 @@ std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(std::istream &stream
         // Don't throw - use the flight number from the header instead
     }
 
-    uint16_t flags[2];
-    stream.read(reinterpret_cast<char *>(&flags), 4);
-    if (!stream || stream.gcount() != 4) {
+    if (!reader.has(4)) {
         throw std::runtime_error("Failed to read flags from flight header");
     }
-    flightHeader->flags = ntohs(flags[0]) | (static_cast<uint32_t>(ntohs(flags[1])) << 16);
+    uint16_t flagsLow = reader.readU16BE();
+    uint16_t flagsHigh = reader.readU16BE();
+    flightHeader->flags = flagsLow | (static_cast<uint32_t>(flagsHigh) << 16);
 
 #ifdef DEBUG_FLIGHT_HEADERS
     std::cout << "flags: 0x" << std::hex << flightHeader->flags << std::dec << "\n";
 #endif
 
-    std::streamoff intervalOffset = startOff + headerSize - std::streamoff(INTERVAL_FIELD_TRAILING_BYTES);
+    auto intervalOffset = static_cast<std::size_t>(headerSize - std::streamoff(INTERVAL_FIELD_TRAILING_BYTES));
     if (headerSize >= MAX_FLIGHT_HEADER_SIZE) {
         // big header, with at least seven data fields before the interval field
         // This potentially has GPS data in fields 3,4 and 5,6.
         uint32_t latlng{0};
-        for (int i = 0; stream.tellg() < intervalOffset; ++i) {
-            uint16_t val;
-            stream.read(reinterpret_cast<char *>(&val), 2);
-            if (!stream || stream.gcount() != 2) {
-                throw std::runtime_error("Failed to read GPS data field from flight header");
-            }
-            val = ntohs(val);
+        for (int i = 0; reader.position() < intervalOffset; ++i) {
+            uint16_t val = readWord("Failed to read GPS data field from flight header");
             switch (i) {
             case HEADER_DATA_GPS_LAT_HIGH_IDX:
                 latlng = static_cast<uint32_t>(val << 16);
@@ -513,34 +531,20 @@ std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(std::istream &stream
         }
     } else {
         // small header. just skip the data block
-        stream.seekg(intervalOffset, std::ios_base::beg);
-        if (!stream) {
+        if (intervalOffset > reader.size()) {
             throw std::runtime_error("Failed to seek to interval field in flight header");
         }
+        reader.seek(intervalOffset);
     }
 
-    stream.read(reinterpret_cast<char *>(&flightHeader->interval), 2);
-    if (!stream || stream.gcount() != 2) {
-        throw std::runtime_error("Failed to read interval from flight header");
-    }
-    flightHeader->interval = ntohs(flightHeader->interval);
+    flightHeader->interval = readWord("Failed to read interval from flight header");
 
-    uint16_t dt;
-    stream.read(reinterpret_cast<char *>(&dt), 2);
-    if (!stream || stream.gcount() != 2) {
-        throw std::runtime_error("Failed to read date from flight header");
-    }
-    dt = ntohs(dt);
+    uint16_t dt = readWord("Failed to read date from flight header");
     flightHeader->startDate.tm_mday = (dt & DATE_MDAY_MASK);
     flightHeader->startDate.tm_mon = ((dt & DATE_MONTH_MASK) >> DATE_MONTH_SHIFT) - 1;
     flightHeader->startDate.tm_year = (dt >> DATE_YEAR_SHIFT) + DATE_YEAR_OFFSET;
 
-    uint16_t tm;
-    stream.read(reinterpret_cast<char *>(&tm), 2);
-    if (!stream || stream.gcount() != 2) {
-        throw std::runtime_error("Failed to read time from flight header");
-    }
-    tm = ntohs(tm);
+    uint16_t tm = readWord("Failed to read time from flight header");
     flightHeader->startDate.tm_sec = (tm & TIME_SECONDS_MASK) * TIME_SECONDS_SCALE;
     flightHeader->startDate.tm_min = (tm & TIME_MINUTES_MASK) >> TIME_MINUTES_SHIFT;
     flightHeader->startDate.tm_hour = (tm >> TIME_HOURS_SHIFT);
@@ -556,23 +560,22 @@ std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(std::istream &stream
               << "  tm_isdst: " << flightHeader->startDate.tm_isdst << "\n";
 #endif
 
-    auto endOff{stream.tellg()};
-    if (endOff == -1) {
-        throw std::runtime_error("Failed to get stream position after reading flight header");
-    }
-
 #ifdef DEBUG_FLIGHT_HEADERS
+    auto endOff{startOff + static_cast<std::streamoff>(reader.position())};
     std::cout << "\n";
     std::cout << "Flight Header end offset: " << std::hex << endOff << std::dec << "\n";
     std::cout << std::flush;
 #endif
 
-    unsigned char checksum;
-    stream.read(reinterpret_cast<char *>(&checksum), 1);
-    if (!stream || stream.gcount() != 1) {
+    if (!reader.has(1)) {
         throw std::runtime_error("Failed to read checksum from flight header");
     }
-    if (!validateBinaryChecksum(stream, startOff, endOff, checksum)) {
+    BinaryChecksum checksum;
+    checksum.add(reader.data(), reader.position());
+    uint8_t headerChecksum = reader.readU8();
+    src.consume(reader.position());
+
+    if (!checksum.matches(headerChecksum)) {
         std::stringstream msg;
         msg << "checksum failure in flight header ";
 #ifdef DEBUG_FLIGHTS
@@ -593,18 +596,43 @@ std::shared_ptr<FlightHeader> FlightFile::parseFlightHeader(std::istream &stream
     return flightHeader;
 }
 
-void FlightFile::parseFlightDataRec(std::istream &stream, const std::shared_ptr<Flight> &flight)
+// Hands the decoder everything up to the largest possible record at the
+// current offset, then consumes however much the record actually used.
+bool FlightFile::parseFlightDataRec(ByteSource &src, const std::shared_ptr<Flight> &flight)
 {
-    int oldFormat = false; // NOT ACTIVE YET
-
-    flight->incrementSequence();
+    // Records only get later, so once one is past the window the rest of the
+    // flight can't be wanted and needn't be decoded
+    if (m_timeWindow && flight->m_recordSeq > 0 &&
+        flight->m_recordTime + flight->secondsToNextRecord() >= m_timeWindow->second) {
+        skipFlightDataRec(src, flight);
+        return false;
+    }
 
-    int maskSize = oldFormat ? 1 : 2;
+    replayFlightDataRec(src, flight);
+    if (!wantsRecord(*flight)) {
+        return false;
+    }
 
-    auto startOff{stream.tellg()};
-    if (startOff == -1) {
-        throw std::runtime_error("Failed to get stream position for flight data record");
+    if (m_flightRecViewCb) {
+        m_flightRecViewCb(flight->recordView());
+    }
+    if (m_flightRecCompletionCb) {
+        m_flightRecCompletionCb(flight->getFlightMetricsRecord());
     }
+    return true;
+}
+
+void FlightFile::replayFlightDataRec(ByteSource &src, const std::shared_ptr<Flight> &flight)
+{
+    auto startOff{src.tell()};
+    auto reader = src.peek(MAX_DATA_RECORD_SIZE);
+    src.consume(decodeFlightDataRec(reader.data(), reader.size(), flight, startOff));
+}
+
+std::size_t FlightFile::decodeFlightDataRec(const uint8_t *data, std::size_t size,
+                                            const std::shared_ptr<Flight> &flight, std::streamoff startOff)
+{
+    flight->beginRecord();
 
 #ifdef DEBUG_FLIGHTS
     std::cout << "-----------------------------------\n";
@@ -612,602 +640,921 @@ void FlightFile::parseFlightDataRec(std::istream &stream, const std::shared_ptr<
     std::cout << "start offset: " << std::hex << startOff << std::dec << "\n";
 #endif
 
-    // A pair of bitmaps, which should be identical
-    // They indicate which bytes of the data bitmap are populated
-    // Read as raw bytes and compare byte-by-byte to avoid endianness issues
-    unsigned char bmPopMapBytes[4]; // 2 bytes * 2 maps
-    stream.read(reinterpret_cast<char *>(bmPopMapBytes), maskSize * 2);
-    if (!stream || stream.gcount() != static_cast<std::streamsize>(maskSize * 2)) {
+    RecordDeltas values;
+    auto record = flight->m_recordCodec.decode(data, size, flight->m_recordSeq, values);
+
+    if (!record.popMapsMatch) {
+        // For some files, bmPopMaps may not match due to data corruption
+        // Log warning but continue - the decoder used the first map
         std::stringstream msg;
-        msg << "Failed to read bmPopMap in flight data record " << flight->m_recordSeq;
-        throw std::runtime_error(msg.str());
+        msg << "bmPopMaps don't match (record: " << std::dec << flight->m_recordSeq << " offset: " << std::hex
+            << startOff;
+        std::cerr << "Warning: " << msg.str() << " (using first map)\n";
     }
 
-    // Compare the raw bytes - they should be identical
-    bool mapsMatch = true;
-    for (int i = 0; i < maskSize; ++i) {
-        if (bmPopMapBytes[i] != bmPopMapBytes[i + maskSize]) {
-            mapsMatch = false;
+    if (values.contains(MARK_IDX)) {
+        switch (values[MARK_IDX]) {
+        case MARK_START:
+            flight->setFastFlag(true);
+            break;
+        case MARK_END:
+            flight->setFastFlag(false);
             break;
         }
     }
 
-    if (!mapsMatch) {
-        std::stringstream msg;
-        msg << "bmPopMaps don't match (record: " << std::dec << flight->m_recordSeq << " offset: " << std::hex
-            << (stream.tellg() - static_cast<std::streamoff>(maskSize * 2));
+    flight->updateMetrics(values);
+
+    if (flight->m_fastFlag) {
+        ++flight->m_fastRecCount;
+    } else {
+        ++flight->m_stdRecCount;
+    }
+
 #ifdef DEBUG_FLIGHTS
-        std::cout << msg.str() << std::endl;
-        std::cout << "Bytes: ";
-        for (int i = 0; i < maskSize * 2; ++i) {
-            std::cout << std::hex << static_cast<unsigned int>(bmPopMapBytes[i]) << " ";
-        }
-        std::cout << std::dec << std::endl;
+    std::cout << "values read: " << values.size() << "\n";
+    std::cout << "end offset: " << std::hex << (startOff + static_cast<std::streamoff>(record.length)) << std::dec
+              << "\n";
+    std::cout << std::flush;
 #endif
-        // For some files, bmPopMaps may not match due to data corruption
-        // Log warning but continue - use the first map
-        std::cerr << "Warning: " << msg.str() << " (using first map)\n";
-    }
 
-    // Convert the first map to a bitset for ease of access
-    // For maskSize == 1, use the byte directly
-    // For maskSize == 2, convert from big-endian
-    std::uint16_t bmPopMapValue;
-    if (maskSize == 1) {
-        bmPopMapValue = bmPopMapBytes[0];
-    } else {
-        bmPopMapValue =
-            (static_cast<std::uint16_t>(bmPopMapBytes[0]) << 8) | static_cast<std::uint16_t>(bmPopMapBytes[1]);
+    if (!record.checksumOk) {
+        // Log warning but continue - some files may have checksum issues in data records
+        std::cerr << "Warning: checksum failure in record " << std::dec << flight->m_recordSeq
+                  << " (continuing anyway)\n";
     }
-    std::bitset<16> flags{bmPopMapValue};
 
-    char repeatCount;
-    stream.read(&repeatCount, 1);
-    if (!stream || stream.gcount() != 1) {
-        std::stringstream msg;
-        msg << "Failed to read repeat count in flight data record " << flight->m_recordSeq;
-        throw std::runtime_error(msg.str());
+    return record.length;
+}
+
+void FlightFile::parseFlights(ByteSource &src)
+{
+    // If there are no flights to parse, return early
+    if (m_flightDataCounts.empty()) {
+        return;
     }
 
-    // The next few bytes indicate which measurements are available
-    const int mapBytes = maskSize * BITS_PER_BYTE;
+    std::streamoff headerSize = requireFlightHeaderSize(src);
 
-    std::bitset<MAX_METRIC_FIELDS> fieldMap;
-    for (int i = 0; i < mapBytes; ++i) {
-        if (flags[i]) {
-            char val;
-            stream.read(&val, 1);
-            if (!stream || stream.gcount() != 1) {
-                std::stringstream msg;
-                msg << "Failed to read field map byte " << i << " in flight data record " << flight->m_recordSeq;
-                throw std::runtime_error(msg.str());
-            }
-            for (int k = 0; k < BITS_PER_BYTE; ++k) {
-                fieldMap.set(i * BITS_PER_BYTE + k, val & (1 << k)); // set the proper bit to 1
-            }
+    for (auto &&flightDataCount : m_flightDataCounts) {
+        auto startOff{src.tell()};
+
+#ifdef DEBUG_PARSE
+        std::cout << "======== startOff: " << std::hex << startOff << std::dec << "\n";
+#endif
+
+        auto totalBytes = flightByteBudget(flightDataCount.second);
+
+        auto flight = makeFlight(m_metadata);
+        flight->m_flightHeader = parseFlightHeader(src, flightDataCount.first, headerSize);
+
+        while ((src.tell() - startOff) < totalBytes) {
+            parseFlightDataRec(src, flight);
+
+#ifdef DEBUG_PARSE
+            auto bytesRead = src.tell() - startOff;
+            std::cout << "---> " << std::dec << bytesRead << "    streamnext: " << std::hex << src.tell() << std::dec
+                      << "    totalBytes: " << totalBytes << "\n"
+                      << std::flush;
+#endif
         }
-    }
 
-    // The measurements are differences from the previous value. This indicates
-    // whether it should be added to or subtracted from the previous value.
-    // Note that we skip bytes 6 & 7 - they are the high bytes of the EGTs and
-    // the sign bits aren't used (they use the sign bits from the low bytes).
-    std::bitset<MAX_METRIC_FIELDS> signMap;
-    for (int i = 0; i < mapBytes; ++i) {
-        if (flags[i] && (i != EGT_HIGHBYTE_IDX_1 && i != EGT_HIGHBYTE_IDX_2)) {
-            char val;
-            stream.read(&val, 1);
-            if (!stream || stream.gcount() != 1) {
-                std::stringstream msg;
-                msg << "Failed to read sign map byte " << i << " in flight data record " << flight->m_recordSeq;
-                throw std::runtime_error(msg.str());
-            }
-            for (int k = 0; k < BITS_PER_BYTE; ++k) {
-                signMap.set(i * BITS_PER_BYTE + k, val & (1 << k)); // set the proper bit to 1
-            }
+        if (m_flightCompletionCb) {
+            m_flightCompletionCb(flight->m_stdRecCount, flight->m_fastRecCount);
         }
     }
+}
 
-#ifdef DEBUG_FLIGHTS
-    std::cout << "repeatCount: " << hex(repeatCount) << "\n";
-    {
-        std::cout << "          ";
-        if (fieldMap.size() > 0) {
-            for (size_t count = 0, i = fieldMap.size() / 8; i > 0; --i) {
-                std::cout << " Byte " << hex(i - 1) << "  ";
-            }
-        }
-        std::cout << "\n";
-        std::cout << "fieldMap: ";
-        if (fieldMap.size() > 0) {
-            for (size_t count = 0, i = fieldMap.size(); i > 0; --i) {
-                std::cout << fieldMap[i - 1];
-                if (++count == 8) {
-                    std::cout << " ";
-                    count = 0;
-                }
-            }
-        }
-        std::cout << "\n";
-        std::cout << " signMap: ";
-        if (signMap.size() > 0) {
-            for (size_t count = 0, i = signMap.size(); i > 0; --i) {
-                std::cout << signMap[i - 1];
-                if (++count == 8) {
-                    std::cout << " ";
-                    count = 0;
-                }
-            }
+std::streamoff FlightFile::requireFlightHeaderSize(ByteSource &src)
+{
+    auto headerSizeOpt = detectFlightHeaderSize(src);
+
+    if (!headerSizeOpt.has_value()) {
+        if (m_isLegacyModel) {
+            headerSizeOpt = MIN_FLIGHT_HEADER_SIZE;
+        } else {
+            throw std::runtime_error("Failed to detect flight header size - invalid file format");
         }
-        std::cout << "\n";
     }
-    std::cout << "values to read: " << std::dec << fieldMap.count() << "\n";
-#endif
 
-#ifdef DEBUG_FLIGHTS
-    std::cout << "values start offset: " << std::hex << stream.tellg() << std::dec << "\n";
-    int printCount = 0;
-    std::cout << "raw values:\n";
-    std::cout << "[idx]\thexval\tintval\tsign\tfinalval\n";
+#ifdef DEBUG_FLIGHT_HEADERS
+    std::cout << "Detected flight header size: " << headerSizeOpt.value() << std::endl;
 #endif
+    return headerSizeOpt.value();
+}
 
-    std::map<int, int> values;
-    for (size_t metricIdx = 0; metricIdx < fieldMap.size(); ++metricIdx) {
-        if (fieldMap[metricIdx]) {
-            unsigned char byte;
-            stream.read(reinterpret_cast<char *>(&byte), 1);
-            if (!stream || stream.gcount() != 1) {
-                std::stringstream msg;
-                msg << "Failed to read metric value byte at index " << metricIdx << " in flight data record "
-                    << flight->m_recordSeq;
-                throw std::runtime_error(msg.str());
-            }
-            int val = byte; // promote to int
-            if (signMap[metricIdx]) {
-                val = -val;
-            };
-
-#ifdef DEBUG_FLIGHTS
-            std::cout << "[" << metricIdx << "]\t0x" << hex(byte) << "\t(" << int(byte) << ")\t"
-                      << (signMap[metricIdx] ? "-" : "+") << "   =>\t" << val << "\n";
-            if (++printCount % 16 == 0) {
-                std::cout << "\n";
-            }
-#endif
-            values[metricIdx] = val;
-
-            if (metricIdx == MARK_IDX) {
-                switch (val) {
-                case 2:
-                    flight->setFastFlag(true);
-                    break;
-                case 3:
-                    flight->setFastFlag(false);
-                    break;
-                }
-            }
+std::size_t FlightFile::findFlightIndex(int flightId) const
+{
+    for (size_t i = 0; i < m_flightDataCounts.size(); ++i) {
+        if (m_flightDataCounts[i].first == flightId) {
+            return i;
         }
     }
 
-    flight->updateMetrics(values);
+    std::stringstream msg;
+    msg << "Flight ID " << flightId << " not found in file";
+    throw std::runtime_error(msg.str());
+}
 
-    if (flight->m_fastFlag) {
-        ++flight->m_fastRecCount;
+void FlightFile::skipFlights(ByteSource &src, std::size_t count, std::streamoff headerSize)
+{
+    // Each flight's records are stepped over using only their framing, so
+    // none of them is decoded and no Flight is built. This lands exactly on
+    // the next flight header, for legacy models too.
+    for (size_t i = 0; i < count && i < m_flightDataCounts.size(); ++i) {
+        (void)indexFlight(src, i, headerSize);
+    }
+}
+
+void FlightFile::parseFlights(ByteSource &src, int flightId)
+{
+    // If there are no flights to parse, return early
+    if (m_flightDataCounts.empty()) {
+        throw std::runtime_error("No flights found in file");
+    }
+
+    std::streamoff headerSize = 0;
+    std::size_t targetFlightIndex = 0;
+    if (hasFlightIndexFor(src.tell())) {
+        // Jump straight to the flight. Its header is everything before its
+        // data, less the header's checksum byte.
+        targetFlightIndex = findFlightIndex(flightId);
+        const auto &entry = m_flightIndex[targetFlightIndex];
+        headerSize = entry.dataOffset - entry.headerOffset - 1;
+        src.seek(entry.headerOffset);
     } else {
-        ++flight->m_stdRecCount;
+        // First, detect the flight header size
+        headerSize = requireFlightHeaderSize(src);
+
+        // Verify the target flight exists in the list, then skip everything before it
+        targetFlightIndex = findFlightIndex(flightId);
+        skipFlights(src, targetFlightIndex, headerSize);
     }
 
-    auto endOff{stream.tellg()};
-    if (endOff == -1) {
-        throw std::runtime_error("Failed to get stream position after reading flight data values");
+    auto &flightDataCount = m_flightDataCounts[targetFlightIndex];
+
+    // Estimated total bytes from start of flight (header + checksum + data)
+    std::streamoff estimatedTotalBytes = flightByteBudget(flightDataCount.second);
+
+    // Capture position BEFORE parsing header (to match original behavior)
+    auto startOff{src.tell()};
+
+    // Target flight - parse it fully with callbacks
+    auto flight = makeFlight(m_metadata);
+    flight->m_flightHeader = parseFlightHeader(src, flightDataCount.first, headerSize);
+
+    while ((src.tell() - startOff) < estimatedTotalBytes) {
+        parseFlightDataRec(src, flight);
     }
 
-#ifdef DEBUG_FLIGHTS
-    std::cout << "\n";
-    std::cout << "end offset: " << std::hex << endOff << std::dec << "\n";
-    std::cout << std::flush;
-#endif
+    if (m_flightCompletionCb) {
+        m_flightCompletionCb(flight->m_stdRecCount, flight->m_fastRecCount);
+    }
+}
 
-    unsigned char checksum;
-    stream.read(reinterpret_cast<char *>(&checksum), 1);
-    if (!stream || stream.gcount() != 1) {
+void FlightFile::skipFlightDataRec(ByteSource &src, const std::shared_ptr<Flight> &flight)
+{
+    auto startOff{src.tell()};
+    auto window = src.peek(MAX_DATA_RECORD_SIZE);
+    auto frame = flight->m_recordCodec.frame(window.data(), window.size());
+    if (!frame) {
         std::stringstream msg;
-        msg << "Failed to read checksum from flight data record " << flight->m_recordSeq;
+        msg << "Truncated data record " << (flight->m_recordSeq + 1) << " at offset " << std::hex << startOff;
         throw std::runtime_error(msg.str());
     }
-    if (!validateBinaryChecksum(stream, startOff, endOff, checksum)) {
-        std::stringstream msg;
-        msg << "checksum failure in record " << std::dec << flight->m_recordSeq;
-#ifdef DEBUG_FLIGHTS
-        std::cout << msg.str() << std::endl;
-#endif
-        // Log warning but continue - some files may have checksum issues in data records
-        std::cerr << "Warning: " << msg.str() << " (continuing anyway)\n";
+
+    flight->beginRecord();
+    if (frame->mark == MARK_START) {
+        flight->setFastFlag(true);
+    } else if (frame->mark == MARK_END) {
+        flight->setFastFlag(false);
     }
+    flight->m_fastFlag ? ++flight->m_fastRecCount : ++flight->m_stdRecCount;
+    src.consume(frame->length);
+}
 
-    if (m_flightRecCompletionCb) {
-        m_flightRecCompletionCb(flight->getFlightMetricsRecord());
+FlightFile::FlightIndexEntry FlightFile::indexFlight(ByteSource &src, std::size_t flightIdx,
+                                                    std::streamoff headerSize)
+{
+    const auto &flightDataCount = m_flightDataCounts[flightIdx];
+    std::streamoff totalBytes = flightByteBudget(flightDataCount.second);
+
+    const RecordCodec &codec = recordCodec(m_metadata->RecordMaskSize());
+
+    FlightIndexEntry entry;
+    entry.flightNumber = flightDataCount.first;
+    entry.recordMaskSize = codec.maskSize;
+    entry.headerOffset = src.tell();
+    {
+        SuspendedCallback headerCb(m_flightHeaderCompletionCb);
+        entry.header = parseFlightHeader(src, flightDataCount.first, headerSize);
     }
+    entry.dataOffset = src.tell();
+
+    // Same end condition as the parse loops: stop at the first record that
+    // starts totalBytes or more past the flight header.
+    auto dataBytes =
+        static_cast<std::size_t>(std::max<std::streamoff>(totalBytes - (entry.dataOffset - entry.headerOffset), 0));
+    auto window = src.peek(dataBytes + MAX_DATA_RECORD_SIZE);
+    bool isFast = false;
+    std::size_t pos = 0;
+    while (pos < dataBytes) {
+        auto frame = codec.frame(window.data() + pos, window.size() - pos);
+        if (!frame) {
+            std::stringstream msg;
+            msg << "Truncated data record in flight " << entry.flightNumber << " at offset " << std::hex
+                << (entry.dataOffset + static_cast<std::streamoff>(pos));
+            throw std::runtime_error(msg.str());
+        }
+        if (frame->mark == MARK_START) {
+            isFast = true;
+        } else if (frame->mark == MARK_END) {
+            isFast = false;
+        }
+        isFast ? ++entry.fastRecCount : ++entry.stdRecCount;
+        pos += frame->length;
+    }
+
+    src.consume(pos);
+    entry.endOffset = src.tell();
+    return entry;
 }
 
-void FlightFile::parseFlights(std::istream &stream)
+std::vector<FlightFile::FlightIndexEntry> FlightFile::buildFlightIndex(ByteSource &src)
 {
-    // If there are no flights to parse, return early
+    src.seek(0);
+    parseFileHeaders(src);
+
     if (m_flightDataCounts.empty()) {
-        return;
+        return {};
     }
+    return indexFlights(src, requireFlightHeaderSize(src));
+}
 
-    auto headerSizeOpt = detectFlightHeaderSize(stream);
+std::vector<FlightFile::FlightIndexEntry> FlightFile::indexFlights(ByteSource &src, std::streamoff headerSize)
+{
+    std::vector<FlightIndexEntry> index;
+    index.reserve(m_flightDataCounts.size());
+    for (std::size_t i = 0; i < m_flightDataCounts.size(); ++i) {
+        index.push_back(indexFlight(src, i, headerSize));
+    }
+    return index;
+}
 
-    if (!headerSizeOpt.has_value()) {
-        if (m_isLegacyModel) {
-            headerSizeOpt = MIN_FLIGHT_HEADER_SIZE;
-        } else {
-            throw std::runtime_error("Failed to detect flight header size - invalid file format");
-        }
+const std::vector<FlightFile::FlightIndexEntry> &
+FlightFile::ensureFlightIndex(ByteSource &src, std::streamoff firstFlightOffset, std::streamoff headerSize)
+{
+    if (!hasFlightIndexFor(firstFlightOffset)) {
+        src.seek(firstFlightOffset);
+        m_flightIndex = indexFlights(src, headerSize);
     }
+    return m_flightIndex;
+}
 
-    std::streamoff headerSize = headerSizeOpt.value();
+FlightFile::FlightIndexEntry FlightFile::locateFlight(ByteSource &src, std::size_t flightIdx, std::streamoff offset,
+                                                     std::streamoff headerSize)
+{
+    FlightIndexEntry entry;
+    if (flightIdx < m_flightIndex.size() && m_flightIndex.size() == m_flightDataCounts.size() &&
+        m_flightIndex[flightIdx].headerOffset == offset &&
+        m_flightIndex[flightIdx].flightNumber == m_flightDataCounts[flightIdx].first) {
+        // Hand out a copy of the header so callers can't change the index's
+        entry = m_flightIndex[flightIdx];
+        entry.header = std::make_shared<FlightHeader>(*entry.header);
+    } else {
+        src.seek(offset);
+        entry = indexFlight(src, flightIdx, headerSize);
+    }
 
-#ifdef DEBUG_FLIGHT_HEADERS
-    std::cout << "Detected flight header size: " << headerSize << std::endl;
-#endif
+    if (m_flightHeaderCompletionCb) {
+        m_flightHeaderCompletionCb(entry.header);
+    }
+    return entry;
+}
 
-    for (auto &&flightDataCount : m_flightDataCounts) {
-        auto startOff{stream.tellg()};
-        if (startOff == -1) {
-            throw std::runtime_error("Failed to get stream position before reading flight data");
+std::vector<FlightFile::FlightIndexEntry> FlightFile::buildFlightIndex(std::istream &stream)
+{
+    StreamByteSource src(stream);
+    return buildFlightIndex(src);
+}
+
+std::vector<FlightFile::FlightIndexEntry> FlightFile::buildFlightIndex(const MappedFile &file)
+{
+    MemoryByteSource src(file.data(), file.size());
+    return buildFlightIndex(src);
+}
+
+namespace {
+
+// Checks the checksum of the flight header at the start of bytes (its last
+// byte is the checksum), then of each data record after it, up to the first
+// one that starts at or past dataEnd. Records are found by their framing.
+// offset is where bytes starts in the file. Returns where the last record ends.
+std::size_t checkFlightBytes(const uint8_t *bytes, std::size_t size, std::size_t headerBytes, std::size_t dataEnd,
+                             const RecordCodec &codec, std::streamoff offset, int flightNumber,
+                             FlightFile::FlightChecksums &result)
+{
+    auto noteBad = [&result, offset](std::size_t pos) {
+        if (!result.firstBadOffset) {
+            result.firstBadOffset = offset + static_cast<std::streamoff>(pos);
         }
+    };
 
-#ifdef DEBUG_PARSE
-        std::cout << "======== startOff: " << std::hex << startOff << std::dec << "\n";
-#endif
+    if (headerBytes > size) {
+        std::stringstream msg;
+        msg << "Truncated header for flight " << flightNumber << " at offset " << std::hex << offset;
+        throw std::runtime_error(msg.str());
+    }
+    BinaryChecksum headerChecksum;
+    headerChecksum.add(bytes, headerBytes - 1);
+    if (!headerChecksum.matches(bytes[headerBytes - 1])) {
+        result.headerOk = false;
+        noteBad(0);
+    }
 
-        // Validate flight data count is reasonable (prevent integer overflow)
-        const std::streamoff MAX_FLIGHT_RECORDS = 1000000; // 1 million records max
-        if (flightDataCount.second < 1 || flightDataCount.second > MAX_FLIGHT_RECORDS) {
+    std::size_t pos = headerBytes;
+    while (pos < dataEnd) {
+        auto frame = codec.frame(bytes + pos, size - pos);
+        if (!frame) {
             std::stringstream msg;
-            msg << "Invalid flight data count: " << flightDataCount.second << " (must be between 1 and "
-                << MAX_FLIGHT_RECORDS << ")";
+            msg << "Truncated data record in flight " << flightNumber << " at offset " << std::hex
+                << (offset + static_cast<std::streamoff>(pos));
             throw std::runtime_error(msg.str());
         }
-
-        // Calculate total bytes to read with overflow checking
-        std::streamoff recordCount = flightDataCount.second - 1L;
-        std::streamoff totalBytes;
-        if (recordCount > std::numeric_limits<std::streamoff>::max() / 2) {
-            throw std::runtime_error("Flight data count too large - would cause integer overflow");
+        BinaryChecksum checksum;
+        checksum.add(bytes + pos, frame->length - 1);
+        if (!checksum.matches(bytes[pos + frame->length - 1])) {
+            ++result.badRecordCount;
+            noteBad(pos);
         }
-        totalBytes = recordCount * 2;
+        ++result.recordCount;
+        pos += frame->length;
+    }
+    return pos;
+}
 
-        auto flight = std::make_shared<Flight>(m_metadata);
-        flight->m_flightHeader = parseFlightHeader(stream, flightDataCount.first, headerSize);
+} // namespace
 
-        if (!stream.good()) {
-            throw std::runtime_error("Stream error after reading flight header");
-        }
+FlightFile::FlightChecksums FlightFile::verifyFlightChecksums(const MappedFile &file, const FlightIndexEntry &entry)
+{
+    if (entry.headerOffset < 0 || entry.headerOffset >= entry.dataOffset || entry.dataOffset > entry.endOffset ||
+        static_cast<std::size_t>(entry.endOffset) > file.size()) {
+        std::stringstream msg;
+        msg << "Flight " << entry.flightNumber << " index entry doesn't fit in the file";
+        throw std::runtime_error(msg.str());
+    }
 
-        while ((stream.tellg() - startOff) < totalBytes) {
-            if (!stream.good()) {
-                std::stringstream msg;
-                msg << "Stream error while reading flight data records at position " << stream.tellg();
-                throw std::runtime_error(msg.str());
-            }
+    FlightChecksums result;
+    auto flightBytes = static_cast<std::size_t>(entry.endOffset - entry.headerOffset);
+    (void)checkFlightBytes(file.data() + entry.headerOffset, flightBytes,
+                           static_cast<std::size_t>(entry.dataOffset - entry.headerOffset), flightBytes,
+                           recordCodec(entry.recordMaskSize), entry.headerOffset, entry.flightNumber, result);
+    return result;
+}
 
-            parseFlightDataRec(stream, flight);
+FlightFile::IntegrityReport FlightFile::verify(ByteSource &src)
+{
+    IntegrityReport report;
+    SuspendedCallback metadataCb(m_metadataCompletionCb);
 
-#ifdef DEBUG_PARSE
-            auto bytesRead = stream.tellg() - startOff;
-            std::cout << "---> " << std::dec << bytesRead << "    streamnext: " << std::hex << stream.tellg()
-                      << std::dec << "    totalBytes: " << totalBytes << "\n"
-                      << std::flush;
-#endif
-        }
+    // The ASCII header lines, $U through $L, each with an XOR checksum
+    src.seek(0);
+    try {
+        bool lastLine = false;
+        while (!lastLine) {
+            auto reader = src.peek(maxheaderlen);
+            const void *lf = (reader.size() > 0) ? std::memchr(reader.data(), '\n', reader.size()) : nullptr;
+            if (!lf) {
+                throw std::runtime_error("Couldn't find the end of the file headers");
+            }
+            auto lineLen = static_cast<std::size_t>(static_cast<const uint8_t *>(lf) - reader.data());
+            std::string line(reinterpret_cast<const char *>(reader.data()), lineLen);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
 
-        if (!stream.good()) {
-            throw std::runtime_error("Stream error after reading flight data");
+            ++report.headerLines;
+            try {
+                validateHeaderChecksum(static_cast<int>(report.headerLines), line.c_str());
+            } catch (const std::exception &) {
+                ++report.badHeaderLines;
+                if (!report.firstBadOffset) {
+                    report.firstBadOffset = src.tell();
+                }
+            }
+            lastLine = line.rfind("$L", 0) == 0;
+            src.consume(lineLen + 1);
         }
 
-        if (m_flightCompletionCb) {
-            m_flightCompletionCb(flight->m_stdRecCount, flight->m_fastRecCount);
+        // Now for what the headers say, without stopping for bad checksums
+        src.seek(0);
+        parseFileHeaders(src, false);
+        if (m_flightDataCounts.empty()) {
+            return report;
+        }
+        auto headerSize = requireFlightHeaderSize(src);
+        const RecordCodec &codec = recordCodec(m_metadata->RecordMaskSize());
+
+        for (std::size_t i = 0; i < m_flightDataCounts.size(); ++i) {
+            const auto &flightDataCount = m_flightDataCounts[i];
+            auto totalBytes = static_cast<std::size_t>(flightByteBudget(flightDataCount.second));
+            auto headerBytes = static_cast<std::size_t>(headerSize) + 1;
+
+            FlightIntegrity flight;
+            flight.flightNumber = flightDataCount.first;
+            flight.headerOffset = src.tell();
+            // Same end condition as the parse loops: stop at the first record
+            // that starts totalBytes or more past the flight header.
+            auto window = src.peek(std::max(totalBytes, headerBytes) + MAX_DATA_RECORD_SIZE);
+            auto end = checkFlightBytes(window.data(), window.size(), headerBytes, totalBytes, codec,
+                                        flight.headerOffset, flight.flightNumber, flight.checksums);
+            src.consume(end);
+            flight.endOffset = src.tell();
+
+            if (!report.firstBadOffset && flight.checksums.firstBadOffset) {
+                report.firstBadOffset = flight.checksums.firstBadOffset;
+            }
+            report.flights.push_back(flight);
         }
+    } catch (const std::exception &ex) {
+        report.error = ex.what();
     }
+    return report;
 }
 
-void FlightFile::parseFlights(std::istream &stream, int flightId)
+FlightFile::IntegrityReport FlightFile::verify(std::istream &stream)
 {
-    // If there are no flights to parse, return early
-    if (m_flightDataCounts.empty()) {
-        throw std::runtime_error("No flights found in file");
+    StreamByteSource src(stream);
+    return verify(src);
+}
+
+FlightFile::IntegrityReport FlightFile::verify(const MappedFile &file)
+{
+    MemoryByteSource src(file.data(), file.size());
+    return verify(src);
+}
+
+bool FlightFile::IntegrityReport::ok() const
+{
+    if (!error.empty() || badHeaderLines > 0) {
+        return false;
     }
+    return std::all_of(flights.begin(), flights.end(), [](const FlightIntegrity &flight) { return flight.ok(); });
+}
 
-    // First, detect the flight header size
-    auto headerSizeOpt = detectFlightHeaderSize(stream);
+void FlightFile::setFlightIndex(std::vector<FlightIndexEntry> index) { m_flightIndex = std::move(index); }
 
-    if (!headerSizeOpt.has_value()) {
-        if (m_isLegacyModel) {
-            headerSizeOpt = MIN_FLIGHT_HEADER_SIZE;
-        } else {
-            throw std::runtime_error("Failed to detect flight header size - invalid file format");
+std::vector<FlightFile::FlightIndexEntry> FlightFile::loadFlightIndex(const MappedFile &file)
+{
+    SuspendedCallback metadataCb(m_metadataCompletionCb);
+    auto index = FlightIndexFile::read(file);
+    if (index) {
+        // The sidecar only has the flights. Decoding them needs the metadata
+        // and flight list from the file's own headers, which end where the
+        // first flight starts.
+        MemoryByteSource src(file.data(), file.size());
+        parseFileHeaders(src);
+    } else {
+        index = buildFlightIndex(file);
+        try {
+            FlightIndexFile::write(file, *index);
+        } catch (const std::exception &e) {
+            std::cerr << "Warning: " << e.what() << " (continuing anyway)\n";
         }
     }
+    setFlightIndex(*index);
+    return *index;
+}
 
-    std::streamoff headerSize = headerSizeOpt.value();
+bool FlightFile::hasFlightIndexFor(std::streamoff firstFlightOffset) const
+{
+    if (m_flightIndex.empty() || m_flightIndex.size() != m_flightDataCounts.size() ||
+        m_flightIndex.front().headerOffset != firstFlightOffset) {
+        return false;
+    }
+    for (std::size_t i = 0; i < m_flightIndex.size(); ++i) {
+        if (m_flightIndex[i].flightNumber != m_flightDataCounts[i].first) {
+            return false;
+        }
+    }
+    return true;
+}
 
-#ifdef DEBUG_FLIGHT_HEADERS
-    std::cout << "Detected flight header size: " << headerSize << std::endl;
-#endif
+void FlightFile::forEachFlightParallel(const MappedFile &file, const std::vector<FlightIndexEntry> &index,
+                                       const std::function<void(std::size_t, const FlightView &)> &fn,
+                                       unsigned int threads)
+{
+    if (index.empty()) {
+        return;
+    }
+    if (!m_metadata) {
+        throw std::runtime_error("forEachFlightParallel: no metadata; build the flight index from this file first");
+    }
 
-    // Verify the target flight exists in the list
-    int targetFlightIndex = -1;
-    for (size_t i = 0; i < m_flightDataCounts.size(); ++i) {
-        if (m_flightDataCounts[i].first == flightId) {
-            targetFlightIndex = static_cast<int>(i);
-            break;
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned int>(std::min<std::size_t>(threads, index.size()));
+
+    std::atomic<std::size_t> nextFlight{0};
+    std::atomic<bool> failed{false};
+    std::atomic<bool> sawTwin{false};
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        // The records are decoded through a parser of the worker's own, with
+        // no callbacks registered, reading its own view of the shared mapping.
+        FlightFile parser;
+        parser.m_isLegacyModel = m_isLegacyModel;
+        parser.m_metricSelection = m_metricSelection;
+        parser.m_recordFilter = m_recordFilter;
+        parser.m_timeWindow = m_timeWindow;
+        auto source = std::make_shared<MemoryByteSource>(file.data(), file.size());
+
+        while (!failed) {
+            auto i = nextFlight.fetch_add(1);
+            if (i >= index.size()) {
+                break;
+            }
+            const auto &entry = index[i];
+            try {
+                // Flight::updateMetrics can set the twin flag in the metadata,
+                // so every flight gets a copy of its own.
+                auto metadata = std::make_shared<Metadata>(*m_metadata);
+                auto flight = parser.makeFlight(metadata);
+                flight->m_flightHeader = entry.header;
+
+                FlightView view(source, &parser, entry.header, flight, entry.dataOffset,
+                                entry.endOffset - entry.dataOffset, entry.stdRecCount, entry.fastRecCount);
+                fn(i, view);
+
+                if (metadata->m_configInfo.isTwin) {
+                    sawTwin = true;
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+                failed = true;
+            }
         }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned int t = 0; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    for (auto &thread : pool) {
+        thread.join();
     }
 
-    if (targetFlightIndex == -1) {
-        std::stringstream msg;
-        msg << "Flight ID " << flightId << " not found in file";
-        throw std::runtime_error(msg.str());
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+    if (sawTwin) {
+        m_metadata->m_configInfo.isTwin = true;
     }
+}
 
-    // Enhanced skip technique: parse headers, skip data with neighborhood search
-    // Based on edmtools but with more robust position finding
+void FlightFile::forEachFlightParallel(const MappedFile &file,
+                                       const std::function<void(std::size_t, const FlightView &)> &fn,
+                                       unsigned int threads)
+{
+    forEachFlightParallel(file, buildFlightIndex(file), fn, threads);
+}
 
-    // Save callbacks - we'll only invoke them for the target flight
-    auto savedFlightHeaderCb = m_flightHeaderCompletionCb;
-    auto savedFlightRecCb = m_flightRecCompletionCb;
-    auto savedFlightCompletionCb = m_flightCompletionCb;
+FlightColumns FlightFile::loadFlightColumns(ByteSource &src, int flightId, const MetricSet &metrics)
+{
+    src.seek(0);
+    parseFileHeaders(src);
 
-    for (size_t i = 0; i < m_flightDataCounts.size(); ++i) {
-        auto &flightDataCount = m_flightDataCounts[i];
-        bool isTargetFlight = (static_cast<int>(i) == targetFlightIndex);
-        bool isLastFlight = (i == m_flightDataCounts.size() - 1);
+    if (m_flightDataCounts.empty()) {
+        throw std::runtime_error("No flights found in file");
+    }
 
-        // Validate flight data count
-        const std::streamoff MAX_FLIGHT_RECORDS = 1000000;
-        if (flightDataCount.second < 1 || flightDataCount.second > MAX_FLIGHT_RECORDS) {
-            std::stringstream msg;
-            msg << "Invalid flight data count: " << flightDataCount.second;
-            throw std::runtime_error(msg.str());
-        }
+    FlightIndexEntry entry;
+    std::size_t flightIndex = 0;
+    if (hasFlightIndexFor(src.tell())) {
+        flightIndex = findFlightIndex(flightId);
+        entry = m_flightIndex[flightIndex];
+        entry.header = std::make_shared<FlightHeader>(*entry.header);
+    } else {
+        std::streamoff headerSize = requireFlightHeaderSize(src);
+        flightIndex = findFlightIndex(flightId);
+        skipFlights(src, flightIndex, headerSize);
+
+        // Walk the records' framing first so every column is allocated exactly
+        // once. The walk peeks the whole flight, so going back to its first
+        // record doesn't need a real seek, even on a stream.
+        entry = indexFlight(src, flightIndex, headerSize);
+    }
+    src.seek(entry.dataOffset);
 
-        // Calculate estimated total bytes from start of flight (header + checksum + data)
-        std::streamoff recordCount = flightDataCount.second - 1L;
-        std::streamoff estimatedTotalBytes;
-        if (recordCount > std::numeric_limits<std::streamoff>::max() / 2) {
-            throw std::runtime_error("Flight data count too large");
-        }
-        estimatedTotalBytes = recordCount * 2;
+    std::streamoff totalBytes = flightByteBudget(m_flightDataCounts[flightIndex].second);
+    auto startOff{entry.headerOffset};
+    if (m_flightHeaderCompletionCb) {
+        m_flightHeaderCompletionCb(entry.header);
+    }
 
-        // Capture position BEFORE parsing header (to match original behavior)
-        auto startOff{stream.tellg()};
-        if (startOff == -1) {
-            throw std::runtime_error("Failed to get stream position");
+    // Only the requested columns need decoding
+    auto flight = metrics.empty() ? makeFlight(m_metadata) : std::make_shared<Flight>(m_metadata, metrics);
+    flight->m_flightHeader = entry.header;
+
+    FlightColumns columns;
+    columns.m_header = flight->m_flightHeader;
+
+    // Only columns the flight actually carries values for
+    for (auto id : flight->m_metricValues.ids()) {
+        if (metrics.empty() || metrics.contains(id)) {
+            columns.m_metrics.insert(id);
         }
+    }
 
-        // Enable callbacks only for target flight
-        if (!isTargetFlight) {
-            m_flightHeaderCompletionCb = nullptr;
-            m_flightRecCompletionCb = nullptr;
-            m_flightCompletionCb = nullptr;
-        } else {
-            m_flightHeaderCompletionCb = savedFlightHeaderCb;
-            m_flightRecCompletionCb = savedFlightRecCb;
-            m_flightCompletionCb = savedFlightCompletionCb;
+    std::size_t recordCount = entry.recordCount();
+    columns.m_timestamps.reserve(recordCount);
+    columns.m_isFast.reserve(recordCount);
+    for (auto id : columns.m_metrics) {
+        columns.m_columns[id].reserve(recordCount);
+    }
+
+    while ((src.tell() - startOff) < totalBytes) {
+        if (!parseFlightDataRec(src, flight)) {
+            continue;
         }
 
-        // Parse the flight header (always needed to stay in sync)
-        auto flightHeader = parseFlightHeader(stream, flightDataCount.first, headerSize);
-        if (!stream.good()) {
-            throw std::runtime_error("Stream error after reading flight header");
+        columns.m_timestamps.push_back(flight->m_recordTime);
+        columns.m_isFast.push_back(flight->m_fastFlag ? 1 : 0);
+        for (auto id : columns.m_metrics) {
+            columns.m_columns[id].push_back(flight->m_metricValues.get(id, 0.0f));
         }
+    }
 
-        if (isTargetFlight) {
-            // Target flight - parse it fully with callbacks
-            auto flight = std::make_shared<Flight>(m_metadata);
-            flight->m_flightHeader = flightHeader;
+    if (m_flightCompletionCb) {
+        m_flightCompletionCb(flight->m_stdRecCount, flight->m_fastRecCount);
+    }
+    return columns;
+}
 
-            while ((stream.tellg() - startOff) < estimatedTotalBytes) {
-                if (!stream.good()) {
-                    throw std::runtime_error("Stream error while reading flight data");
-                }
-                parseFlightDataRec(stream, flight);
-            }
+FlightColumns FlightFile::loadFlightColumns(std::istream &stream, int flightId, const MetricSet &metrics)
+{
+    StreamByteSource src(stream);
+    return loadFlightColumns(src, flightId, metrics);
+}
 
-            if (m_flightCompletionCb) {
-                m_flightCompletionCb(flight->m_stdRecCount, flight->m_fastRecCount);
-            }
+FlightColumns FlightFile::loadFlightColumns(const MappedFile &file, int flightId, const MetricSet &metrics)
+{
+    MemoryByteSource src(file.data(), file.size());
+    return loadFlightColumns(src, flightId, metrics);
+}
 
-            // Restore callbacks and return
-            m_flightHeaderCompletionCb = savedFlightHeaderCb;
-            m_flightRecCompletionCb = savedFlightRecCb;
-            m_flightCompletionCb = savedFlightCompletionCb;
-            return;
-        } else if (!isLastFlight) {
-            if (m_isLegacyModel) {
-                auto flight = std::make_shared<Flight>(m_metadata);
-                flight->m_flightHeader = flightHeader;
-
-                while ((stream.tellg() - startOff) < estimatedTotalBytes) {
-                    if (!stream.good()) {
-                        throw std::runtime_error("Stream error while reading flight data during legacy parsing");
-                    }
-                    parseFlightDataRec(stream, flight);
-                }
-                continue;
-            }
-            // Non-target flight - skip data efficiently with neighborhood search
-            // We've already read headerSize + 1 bytes (header + checksum)
-            // Calculate how much data remains
-            std::streamoff bytesAlreadyRead = headerSize + 1;
-            std::streamoff estimatedDataRemaining = estimatedTotalBytes - bytesAlreadyRead;
-
-            // Skip most of the data, leaving a search window
-            const std::streamoff SEARCH_WINDOW = 64; // bytes to search
-            std::streamoff skipAmount = estimatedDataRemaining - SEARCH_WINDOW;
-
-            if (skipAmount > 0) {
-                stream.seekg(skipAmount, std::ios_base::cur);
-                if (!stream.good()) {
-                    std::stringstream msg;
-                    msg << "Failed to seek past flight " << flightDataCount.first;
-                    throw std::runtime_error(msg.str());
-                }
-            }
+void FlightFile::parse(ByteSource &src)
+{
+    src.seek(0);
 
-            // Read a search window to find the next flight number
-            auto searchStartPos = stream.tellg();
-            size_t headerBytes = static_cast<size_t>(headerSize);
-            const size_t SEARCH_BUFFER_SIZE =
-                static_cast<size_t>(std::max<std::streamoff>(SEARCH_WINDOW, 0)) + headerBytes + 1;
-            std::vector<char> searchBuf(SEARCH_BUFFER_SIZE);
-            stream.read(searchBuf.data(), SEARCH_BUFFER_SIZE);
-            std::streamsize bytesRead = stream.gcount();
-            auto afterBufferPos = stream.tellg();
-
-            if (bytesRead >= 2) {
-                // Look for next flight number in the search window
-                int nextFlightNumber = m_flightDataCounts[i + 1].first;
-                uint16_t targetFlightNum = htons(static_cast<uint16_t>(nextFlightNumber));
-
-                bool found = false;
-                std::streamoff foundOffset = 0;
-
-                // Search for the flight number pattern in the buffer
-                for (std::streamsize offset = 0; offset <= bytesRead - 2; ++offset) {
-                    uint16_t candidate;
-                    std::memcpy(&candidate, searchBuf.data() + offset, sizeof(uint16_t));
-
-                    if (candidate == targetFlightNum) {
-                        auto candidatePos = searchStartPos + static_cast<std::streamoff>(offset);
-                        auto restorePos = afterBufferPos;
-                        unsigned char checksumByte = 0;
-
-                        stream.clear();
-                        stream.seekg(candidatePos + headerSize, std::ios_base::beg);
-                        if (stream.good()) {
-                            stream.read(reinterpret_cast<char *>(&checksumByte), 1);
-                        }
-
-                        bool checksumValid =
-                            stream.good() && stream.gcount() == 1 &&
-                            validateBinaryChecksum(stream, candidatePos, candidatePos + headerSize, checksumByte);
-
-                        stream.clear();
-                        stream.seekg(restorePos, std::ios_base::beg);
-
-                        if (!checksumValid) {
-                            continue;
-                        }
-
-                        found = true;
-                        foundOffset = offset;
-#ifdef DEBUG_FLIGHT_HEADERS
-                        std::cout << "Found flight " << nextFlightNumber << " at offset " << offset
-                                  << " in search window\n";
-#endif
-                        break;
-                    }
-                }
+    parseFileHeaders(src);
+    parseFlights(src);
+    parseFileFooters(src);
+}
 
-                if (found) {
-                    // Position stream at the found flight number
-                    stream.seekg(searchStartPos + foundOffset, std::ios_base::beg);
-                } else {
-                    // Fallback: couldn't validate next flight number - parse sequentially to stay in sync
-                    auto flight = std::make_shared<Flight>(m_metadata);
-                    flight->m_flightHeader = flightHeader;
-
-                    while ((stream.tellg() - startOff) < estimatedTotalBytes) {
-                        if (!stream.good()) {
-                            throw std::runtime_error("Stream error while reading flight data during fallback parsing");
-                        }
-                        parseFlightDataRec(stream, flight);
-                    }
-                    continue;
-                }
-            } else {
-                // Not enough bytes read - just position at end of what we read
-                stream.clear();
-                stream.seekg(searchStartPos + static_cast<std::streamoff>(bytesRead), std::ios_base::beg);
-            }
+void FlightFile::parse(ByteSource &src, int flightId)
+{
+    src.seek(0);
 
-            if (!stream.good()) {
-                stream.clear();
-            }
-        }
-        // For last flight, we don't need to skip - we'll return after target
+    parseFileHeaders(src);
+    parseFlights(src, flightId);
+    parseFileFooters(src);
+}
+
+void FlightFile::processFile(std::istream &stream)
+{
+    StreamByteSource src(stream);
+    parse(src);
+}
+
+void FlightFile::processFile(std::istream &stream, int flightId)
+{
+    StreamByteSource src(stream);
+    parse(src, flightId);
+}
+
+void FlightFile::processFile(const MappedFile &file)
+{
+    MemoryByteSource src(file.data(), file.size());
+    parse(src);
+}
+
+void FlightFile::processFile(const MappedFile &file, int flightId)
+{
+    MemoryByteSource src(file.data(), file.size());
+    parse(src, flightId);
+}
+
+void FlightFile::feed(const uint8_t *data, std::size_t len)
+{
+    auto &buffer = m_feed.buffer;
+    if (m_feed.stage == FeedState::Stage::DONE) {
+        // trailing bytes after the last flight
+        return;
     }
 
-    // Restore callbacks before throwing
-    m_flightHeaderCompletionCb = savedFlightHeaderCb;
-    m_flightRecCompletionCb = savedFlightRecCb;
-    m_flightCompletionCb = savedFlightCompletionCb;
+    // Drop what's been parsed before growing the buffer, so it only ever
+    // holds the unparsed tail and the new chunk
+    if (m_feed.begin > 0) {
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(m_feed.begin));
+        m_feed.offset += static_cast<std::streamoff>(m_feed.begin);
+        m_feed.begin = 0;
+    }
+    buffer.insert(buffer.end(), data, data + len);
 
-    throw std::runtime_error("Failed to find target flight while parsing");
+    feedSteps(false);
 }
 
-void FlightFile::parse(std::istream &stream)
+void FlightFile::finish()
 {
-    stream.seekg(0);
+    feedSteps(true);
+    if (m_feed.stage != FeedState::Stage::DONE) {
+        m_feed = FeedState();
+        throw std::runtime_error("Input ended before the end of the last flight");
+    }
+    m_feed = FeedState();
+}
 
-    parseFileHeaders(stream);
-    parseFlights(stream);
-    parseFileFooters(stream);
+std::size_t FlightFile::feedBacklog() const { return m_feed.buffer.size() - m_feed.begin; }
+
+void FlightFile::feedWhole(const std::function<void(const ByteSink &)> &produce)
+{
+    m_feed = FeedState();
+    try {
+        produce([this](const uint8_t *data, std::size_t len) { feed(data, len); });
+    } catch (...) {
+        // the input failed, not the parse, so start over with the next feed()
+        m_feed = FeedState();
+        throw;
+    }
+    finish();
 }
 
-void FlightFile::parse(std::istream &stream, int flightId)
+void FlightFile::processCompressedFile(std::istream &stream)
 {
-    stream.seekg(0);
+    feedWhole([&stream](const ByteSink &sink) { readDecompressed(stream, sink); });
+}
 
-    parseFileHeaders(stream);
-    parseFlights(stream, flightId);
-    parseFileFooters(stream);
+void FlightFile::processCompressedFile(const MappedFile &file)
+{
+    if (detectInputFormat(file.data(), file.size()) == InputFormat::RAW) {
+        processFile(file);
+        return;
+    }
+    feedWhole([&file](const ByteSink &sink) { readDecompressed(file.data(), file.size(), sink); });
 }
 
-void FlightFile::processFile(std::istream &stream) { parse(stream); }
+void FlightFile::processZipEntry(const ZipArchive &archive, const ZipArchive::Entry &entry)
+{
+    feedWhole([&archive, &entry](const ByteSink &sink) { archive.read(entry, sink); });
+}
 
-void FlightFile::processFile(std::istream &stream, int flightId) { parse(stream, flightId); }
+void FlightFile::feedSteps(bool atEnd)
+{
+    try {
+        MemoryByteSource src(m_feed.buffer.data(), m_feed.buffer.size(), m_feed.offset);
+        src.seek(m_feed.offset + static_cast<std::streamoff>(m_feed.begin));
+        while (m_feed.stage != FeedState::Stage::DONE && feedStep(src, atEnd)) {
+        }
+        m_feed.begin = static_cast<std::size_t>(std::min(src.tell() - m_feed.offset,
+                                                         static_cast<std::streamoff>(m_feed.buffer.size())));
+    } catch (...) {
+        // start over with the next feed()
+        m_feed = FeedState();
+        throw;
+    }
+}
 
-FlightRange FlightFile::flights(std::istream &stream)
+bool FlightFile::feedStep(ByteSource &src, bool atEnd)
 {
-    // Parse file headers to get metadata and flight counts
-    stream.seekg(0);
-    parseFileHeaders(stream);
+    const auto available = static_cast<std::size_t>(m_feed.offset + static_cast<std::streamoff>(m_feed.buffer.size()) -
+                                                     src.tell());
 
-    // If there are no flights, return an empty range
-    if (m_flightDataCounts.empty()) {
-        std::streamoff flightDataStartPos = stream.tellg();
-        if (flightDataStartPos == -1) {
-            flightDataStartPos = 0;
+    switch (m_feed.stage) {
+    case FeedState::Stage::FILE_HEADERS:
+    {
+        // Wait for the whole $L line, which ends the headers. A line too long
+        // to be a header, or the end of input, is left to parseFileHeaders()
+        // to complain about.
+        const auto &buffer = m_feed.buffer;
+        bool complete = atEnd;
+        while (!complete) {
+            const uint8_t *line = buffer.data() + m_feed.headerScan;
+            const std::size_t left = buffer.size() - m_feed.headerScan;
+            const void *lf = (left > 0) ? std::memchr(line, '\n', left) : nullptr;
+            if (!lf) {
+                complete = left >= static_cast<std::size_t>(maxheaderlen);
+                if (!complete) {
+                    return false;
+                }
+                break;
+            }
+            complete = left >= 2 && line[0] == '$' && line[1] == 'L';
+            m_feed.headerScan = static_cast<std::size_t>(static_cast<const uint8_t *>(lf) - buffer.data()) + 1;
         }
-        return FlightRange(&stream, this, m_metadata, &m_flightDataCounts, 0, flightDataStartPos);
+
+        parseFileHeaders(src);
+        if (m_flightDataCounts.empty()) {
+            parseFileFooters(src);
+            m_feed.stage = FeedState::Stage::DONE;
+        } else {
+            m_feed.stage = FeedState::Stage::FLIGHT_HEADER;
+        }
+        return true;
     }
 
-    // Detect flight header size
-    auto headerSizeOpt = detectFlightHeaderSize(stream);
-    if (!headerSizeOpt.has_value()) {
-        if (m_isLegacyModel) {
-            headerSizeOpt = MIN_FLIGHT_HEADER_SIZE;
+    case FeedState::Stage::FLIGHT_HEADER:
+    {
+        // The first flight's header decides how big they all are
+        if (!m_feed.headerSize) {
+            if (!atEnd && available < static_cast<std::size_t>(MAX_FLIGHT_HEADER_SIZE) + 1) {
+                return false;
+            }
+            m_feed.headerSize = requireFlightHeaderSize(src);
+        }
+        if (!atEnd && available < static_cast<std::size_t>(*m_feed.headerSize) + 1) {
+            return false;
+        }
+
+        const auto &flightDataCount = m_flightDataCounts[m_feed.flightIdx];
+        m_feed.flightBytes = flightByteBudget(flightDataCount.second);
+        m_feed.flightStart = src.tell();
+        m_feed.flight = makeFlight(m_metadata);
+        m_feed.flight->m_flightHeader = parseFlightHeader(src, flightDataCount.first, *m_feed.headerSize);
+        m_feed.stage = FeedState::Stage::RECORDS;
+        return true;
+    }
+
+    case FeedState::Stage::RECORDS:
+    {
+        const auto &flight = m_feed.flight;
+        while ((src.tell() - m_feed.flightStart) < m_feed.flightBytes) {
+            // Only decode records that have arrived in full. Any record fits
+            // in MAX_DATA_RECORD_SIZE bytes, so only a shorter tail needs framing.
+            if (!atEnd) {
+                auto window = src.peek(MAX_DATA_RECORD_SIZE);
+                if (window.size() < static_cast<std::size_t>(MAX_DATA_RECORD_SIZE) &&
+                    !flight->m_recordCodec.frame(window.data(), window.size())) {
+                    return false;
+                }
+            }
+            parseFlightDataRec(src, flight);
+        }
+
+        if (m_flightCompletionCb) {
+            m_flightCompletionCb(flight->m_stdRecCount, flight->m_fastRecCount);
+        }
+        m_feed.flight.reset();
+        if (++m_feed.flightIdx < m_flightDataCounts.size()) {
+            m_feed.stage = FeedState::Stage::FLIGHT_HEADER;
         } else {
-            throw std::runtime_error("Failed to detect flight header size - invalid file format");
+            parseFileFooters(src);
+            m_feed.stage = FeedState::Stage::DONE;
         }
+        return true;
     }
 
-    std::streamoff headerSize = headerSizeOpt.value();
+    case FeedState::Stage::DONE:
+        break;
+    }
+    return false;
+}
+
+MappedFile FlightFile::open(const std::string &path) { return MappedFile(path); }
+
+FlightRange FlightFile::flights(std::istream &stream) { return flights(std::make_shared<StreamByteSource>(stream)); }
+
+FlightRange FlightFile::flights(const MappedFile &file)
+{
+    return flights(std::make_shared<MemoryByteSource>(file.data(), file.size()));
+}
+
+FlightRange FlightFile::flights(std::shared_ptr<ByteSource> src)
+{
+    // Parse file headers to get metadata and flight counts
+    src->seek(0);
+    parseFileHeaders(*src);
 
     // Get the position where flight data starts (after headers)
-    // detectFlightHeaderSize() resets the stream to this position
-    std::streamoff flightDataStartPos = stream.tellg();
-    if (flightDataStartPos == -1) {
-        throw std::runtime_error("Failed to get flight data start position");
+    std::streamoff flightDataStartPos = src->tell();
+
+    // If there are no flights, return an empty range
+    if (m_flightDataCounts.empty()) {
+        return FlightRange(src, this, m_metadata, &m_flightDataCounts, 0, flightDataStartPos);
     }
 
+    // Detect flight header size
+    std::streamoff headerSize = requireFlightHeaderSize(*src);
+
     // Return a range object that provides begin/end iterators
-    return FlightRange(&stream, this, m_metadata, &m_flightDataCounts, headerSize, flightDataStartPos);
+    return FlightRange(src, this, m_metadata, &m_flightDataCounts, headerSize, flightDataStartPos);
 }
 
 std::vector<FlightFile::FlightInfo> FlightFile::detectFlights(std::istream &stream)
@@ -1217,10 +1564,29 @@ std::vector<FlightFile::FlightInfo> FlightFile::detectFlights(std::istream &stre
 }
 
 std::vector<FlightFile::FlightInfo> FlightFile::detectFlights(std::istream &stream, std::shared_ptr<Metadata> &metadata)
+{
+    StreamByteSource src(stream);
+    return detectFlights(src, metadata);
+}
+
+std::vector<FlightFile::FlightInfo> FlightFile::detectFlights(const MappedFile &file)
+{
+    std::shared_ptr<Metadata> metadata;
+    return detectFlights(file, metadata);
+}
+
+std::vector<FlightFile::FlightInfo> FlightFile::detectFlights(const MappedFile &file,
+                                                              std::shared_ptr<Metadata> &metadata)
+{
+    MemoryByteSource src(file.data(), file.size());
+    return detectFlights(src, metadata);
+}
+
+std::vector<FlightFile::FlightInfo> FlightFile::detectFlights(ByteSource &src, std::shared_ptr<Metadata> &metadata)
 {
     // Parse file headers to extract $D records
-    stream.seekg(0);
-    parseFileHeaders(stream);
+    src.seek(0);
+    parseFileHeaders(src);
 
     // Return metadata to caller
     metadata = m_metadata;
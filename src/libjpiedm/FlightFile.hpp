@@ -14,14 +14,19 @@
 #include <string>
 #include <vector>
 
+#include "CompressedInput.hpp"
 #include "FileHeaders.hpp"
 #include "Flight.hpp"
+#include "FlightColumns.hpp"
+#include "MappedFile.hpp"
 #include "Metadata.hpp"
 
 namespace jpi_edm {
 
 // Forward declarations for iterator API
+class ByteSource;
 class FlightRange;
+class FlightView;
 
 class FlightFile
 {
@@ -42,11 +47,152 @@ class FlightFile
     virtual void setMetadataCompletionCb(std::function<void(std::shared_ptr<Metadata>)> cb);
     virtual void setFlightHeaderCompletionCb(std::function<void(std::shared_ptr<FlightHeader>)> cb);
     virtual void setFlightRecordCompletionCb(std::function<void(std::shared_ptr<FlightMetricsRecord>)> cb);
+    /**
+     * Like setFlightRecordCompletionCb(), but the record isn't copied: the
+     * view points into the flight's running state and is only valid during
+     * the call. Nothing is allocated per record, which makes this the cheaper
+     * choice for consumers that read a few metrics and move on. If both
+     * callbacks are set, both fire, the view first.
+     */
+    virtual void setFlightRecordViewCb(std::function<void(const FlightRecordView &)> cb);
     virtual void setFlightCompletionCb(std::function<void(unsigned long, unsigned long)> cb);
+
+    /**
+     * Only decode some metrics. Every record's fields are still read, but
+     * only the selected metrics are accumulated, so they're the only ones in
+     * records, record views and FlightView iteration. DIF1 and DIF2 are only
+     * worked out if they're selected; selecting one selects its engine's EGTs
+     * too. An empty set, the default, means every metric.
+     *
+     * Applies to flights decoded after the call.
+     */
+    void setMetricSelection(const MetricSet &metrics);
+
+    /**
+     * Only deliver the records filter accepts. The filter sees each record
+     * as soon as it's decoded, before any FlightMetricsRecord is made; the
+     * record callbacks and FlightView iteration skip the records it turns
+     * down, as does loadFlightColumns(). Flight completion counts still
+     * include every record. forEachFlightParallel() calls it from its worker
+     * threads.
+     */
+    void setRecordFilter(std::function<bool(const FlightRecordView &)> filter);
+
+    /**
+     * Only deliver records logged from `from` up to, but not including, `to`
+     * (UTC). Record times come from the flight header's start time and
+     * interval, and the one second cadence of fast mode; see
+     * FlightRecordView::time(). Checked before the record filter. Once a
+     * flight is past `to` its remaining records are stepped over by their
+     * framing rather than decoded.
+     */
+    void setTimeWindow(std::time_t from, std::time_t to);
+
+    /// Remove the record filter and time window
+    void clearRecordFilters();
     virtual void setFileFooterCompletionCb(std::function<void(void)> cb);
 
     virtual void processFile(std::istream &stream);
     virtual void processFile(std::istream &stream, int flightId);
+    virtual void processFile(const MappedFile &file);
+    virtual void processFile(const MappedFile &file, int flightId);
+
+    // =========================================================================
+    // Push-style input
+    // =========================================================================
+
+    /**
+     * @brief Parse a file handed over a chunk at a time, e.g. from a pipe, a
+     * socket or a decompressor.
+     *
+     * The same callbacks fire, in the same order, as for processFile(), each
+     * as soon as the bytes it needs have arrived. Nothing is seeked, so the
+     * input doesn't have to be seekable. Only the bytes that haven't been
+     * parsed yet are kept: at most the last chunk plus the file headers, or
+     * plus one flight header or data record once those have been parsed.
+     *
+     * Chunks can be any size, including a byte at a time. Bytes after the
+     * last flight are ignored.
+     *
+     * @throws std::runtime_error or std::invalid_argument if the file is
+     * malformed. The partial file is discarded, and the next call starts a
+     * new one.
+     *
+     * Example:
+     * @code
+     *   FlightFile parser;
+     *   parser.setFlightRecordCompletionCb(...);
+     *   while (auto len = read(fd, buf, sizeof(buf))) {
+     *       parser.feed(buf, len);
+     *   }
+     *   parser.finish();
+     * @endcode
+     */
+    void feed(const uint8_t *data, std::size_t len);
+
+    /**
+     * @brief End of input for feed(). Parses what's left and checks that
+     * every flight arrived.
+     *
+     * The next feed() starts a new file.
+     *
+     * @throws std::runtime_error or std::invalid_argument if the input
+     * stopped before the end of the last flight, or is malformed.
+     */
+    void finish();
+
+    /// Bytes fed but not yet parsed
+    [[nodiscard]] std::size_t feedBacklog() const;
+
+    /**
+     * @brief processFile() for a file that may be gzip or zstd compressed.
+     *
+     * The file is decompressed a chunk at a time and each chunk is fed to
+     * feed(), so it's never inflated whole. An uncompressed file is parsed
+     * as it is. The stream needn't be seekable.
+     *
+     * @throws std::runtime_error if the file is compressed in a way this
+     * build can't undo (see canDecompress()), is a zip archive, or is
+     * malformed
+     */
+    void processCompressedFile(std::istream &stream);
+    void processCompressedFile(const MappedFile &file);
+
+    /**
+     * @brief processFile() for one member of a zip archive, inflated a
+     * chunk at a time and fed to feed().
+     *
+     * @throws std::runtime_error if the member can't be read, or is malformed
+     */
+    void processZipEntry(const ZipArchive &archive, const ZipArchive::Entry &entry);
+
+    // =========================================================================
+    // Memory-mapped input
+    // =========================================================================
+
+    /**
+     * @brief Map an EDM file into memory for parsing.
+     *
+     * Every method that takes a std::istream also has an overload taking the
+     * returned MappedFile. Those read headers and records directly out of the
+     * mapping by offset, rather than through istream reads, seeks and state
+     * checks. The MappedFile must outlive anything parsed from it, including
+     * FlightRanges and their iterators.
+     *
+     * @param path Path to the EDM file
+     * @return The mapped file
+     * @throws std::runtime_error if the file can't be opened or mapped
+     *
+     * Example:
+     * @code
+     *   FlightFile parser;
+     *   auto file = FlightFile::open("data.jpi");
+     *   for (const auto& flight : parser.flights(file)) {
+     *       ...
+     *   }
+     * @endcode
+     */
+    [[nodiscard]] static MappedFile open(const std::string &path);
 
     // =========================================================================
     // Iterator-based API (modern C++ interface with lazy evaluation)
@@ -83,6 +229,7 @@ class FlightFile
      * @endcode
      */
     [[nodiscard]] FlightRange flights(std::istream &stream);
+    [[nodiscard]] FlightRange flights(const MappedFile &file);
 
     // =========================================================================
     // Flight Detection API (lightweight flight enumeration)
@@ -110,6 +257,9 @@ class FlightFile
      * - Checking if a specific flight exists
      * - Determining file contents before full parsing
      *
+     * For each flight's header and exact record counts, still without
+     * decoding any records, use buildFlightIndex().
+     *
      * @param stream Input stream containing the EDM file
      * @return Vector of FlightInfo structures, one per flight
      * @throws std::runtime_error if the file headers cannot be parsed
@@ -131,6 +281,7 @@ class FlightFile
      * @endcode
      */
     [[nodiscard]] std::vector<FlightInfo> detectFlights(std::istream &stream);
+    [[nodiscard]] std::vector<FlightInfo> detectFlights(const MappedFile &file);
 
     /**
      * @brief Get flight count and metadata without parsing flight data.
@@ -157,10 +308,238 @@ class FlightFile
      * @endcode
      */
     [[nodiscard]] std::vector<FlightInfo> detectFlights(std::istream &stream, std::shared_ptr<Metadata> &metadata);
+    [[nodiscard]] std::vector<FlightInfo> detectFlights(const MappedFile &file, std::shared_ptr<Metadata> &metadata);
+
+    // =========================================================================
+    // Flight index and parallel decoding
+    // =========================================================================
+
+    /**
+     * @brief Where a flight is in the file, and what its header says.
+     *
+     * Offsets are absolute byte offsets in the file. The record counts come
+     * from walking the records' framing, not from decoding them.
+     */
+    struct FlightIndexEntry {
+        int flightNumber{0};                  ///< Flight ID from the $D record
+        std::streamoff headerOffset{0};       ///< Start of the binary flight header
+        std::streamoff dataOffset{0};         ///< First data record
+        std::streamoff endOffset{0};          ///< One past the last data record
+        unsigned long stdRecCount{0};         ///< Records logged at the flight's interval
+        unsigned long fastRecCount{0};        ///< Records logged in fast (1 second) mode
+        int recordMaskSize{RECORD_MASK_SIZE}; ///< Width of the records' population maps
+        std::shared_ptr<FlightHeader> header;
+
+        [[nodiscard]] unsigned long recordCount() const { return stdRecCount + fastRecCount; }
+    };
+
+    /**
+     * @brief Find every flight's boundaries without decoding any records.
+     *
+     * Parses the file headers and each flight header, and steps over the
+     * data records using only their population/field maps. This is much
+     * cheaper than decoding, and the result lets flights be decoded
+     * independently of each other (see forEachFlightParallel()).
+     *
+     * The metadata callback fires; no flight callbacks do.
+     *
+     * @throws std::runtime_error if the headers can't be parsed or a flight is truncated
+     */
+    [[nodiscard]] std::vector<FlightIndexEntry> buildFlightIndex(std::istream &stream);
+    [[nodiscard]] std::vector<FlightIndexEntry> buildFlightIndex(const MappedFile &file);
+
+    /// What verifyFlightChecksums() found in one flight
+    struct FlightChecksums {
+        bool headerOk{true};                           ///< The flight header's checksum matched
+        unsigned long recordCount{0};
+        unsigned long badRecordCount{0};               ///< Data records whose checksum didn't match
+        std::optional<std::streamoff> firstBadOffset;  ///< Start of the first header or record that didn't match
+
+        [[nodiscard]] unsigned long okRecordCount() const { return recordCount - badRecordCount; }
+    };
+
+    /**
+     * @brief Check the checksums of a flight's header and all its data records.
+     *
+     * The records are found by their framing, as buildFlightIndex() finds
+     * them, and each one is checksummed as a single block. Nothing is
+     * decoded, no Flight is built and no callbacks fire.
+     *
+     * @param file The mapped file the entry describes
+     * @param entry From buildFlightIndex(file) or loadFlightIndex(file)
+     * @throws std::runtime_error if the entry isn't within the file or a record runs past the flight's end
+     */
+    [[nodiscard]] static FlightChecksums verifyFlightChecksums(const MappedFile &file, const FlightIndexEntry &entry);
+
+    /// What verify() found in one flight
+    struct FlightIntegrity {
+        int flightNumber{0};            ///< Flight ID from the $D record
+        std::streamoff headerOffset{0}; ///< Start of the binary flight header
+        std::streamoff endOffset{0};    ///< One past the last data record
+        FlightChecksums checksums;
+
+        [[nodiscard]] bool ok() const { return checksums.headerOk && checksums.badRecordCount == 0; }
+    };
+
+    /// What verify() found in a whole file
+    struct IntegrityReport {
+        unsigned int headerLines{0};                  ///< ASCII header lines, $U through $L
+        unsigned int badHeaderLines{0};               ///< Header lines whose XOR checksum didn't match
+        std::vector<FlightIntegrity> flights;         ///< Every flight checked, in file order
+        std::optional<std::streamoff> firstBadOffset; ///< Start of the first line, header or record that didn't match
+        std::string error; ///< Why checking stopped early (e.g. a truncated flight), or empty if it didn't
+
+        /// True if every checksum matched and the whole file was checked
+        [[nodiscard]] bool ok() const;
+    };
+
+    /**
+     * @brief Check every checksum in the file without decoding any of it.
+     *
+     * Checks the XOR checksum of each ASCII header line, then walks the
+     * flights checking each flight header's checksum and each data record's,
+     * finding the records by their framing. No Flight is built and no
+     * callbacks fire. Damaged checksums are counted rather than thrown; if
+     * the file's structure gives out (headers that can't be parsed, a flight
+     * that runs past the end of the file), checking stops there and the
+     * reason is in the report's error.
+     *
+     * Example:
+     * @code
+     *   FlightFile parser;
+     *   auto report = parser.verify(FlightFile::open("upload.jpi"));
+     *   if (!report.ok()) {
+     *       // reject it
+     *   }
+     * @endcode
+     */
+    [[nodiscard]] IntegrityReport verify(std::istream &stream);
+    [[nodiscard]] IntegrityReport verify(const MappedFile &file);
+
+    /**
+     * @brief Decode flights concurrently on a pool of worker threads.
+     *
+     * fn is called once per flight in the index, with the flight's position
+     * in the index and a FlightView whose records are decoded lazily as fn
+     * iterates them. Calls for different flights happen concurrently and in
+     * no particular order, so fn must be thread-safe; writing each flight's
+     * results into its own slot of a pre-sized vector is the simple way to
+     * get deterministic output.
+     *
+     * Each flight is decoded with its own Flight state, its own copy of the
+     * file metadata, and its own reader over the shared mapping, so the
+     * results don't depend on how the flights are spread across threads.
+     * Registered callbacks are not invoked. If fn or decoding throws, the
+     * remaining flights are abandoned and the first exception is rethrown.
+     *
+     * @param file The mapped file the index was built from
+     * @param index From buildFlightIndex(file) or loadFlightIndex(file)
+     * @param fn Called with (index position, flight) for every flight
+     * @param threads Number of worker threads; 0 means one per hardware thread
+     *
+     * Example:
+     * @code
+     *   FlightFile parser;
+     *   auto file = FlightFile::open("data.jpi");
+     *   auto index = parser.buildFlightIndex(file);
+     *
+     *   std::vector<float> peakEgt(index.size());
+     *   parser.forEachFlightParallel(file, index, [&](size_t i, const FlightView &flight) {
+     *       for (const auto &rec : flight) {
+     *           peakEgt[i] = std::max(peakEgt[i], rec->m_metrics.get(EGT11, 0.0f));
+     *       }
+     *   });
+     * @endcode
+     */
+    void forEachFlightParallel(const MappedFile &file, const std::vector<FlightIndexEntry> &index,
+                               const std::function<void(std::size_t, const FlightView &)> &fn,
+                               unsigned int threads = 0);
+    void forEachFlightParallel(const MappedFile &file, const std::function<void(std::size_t, const FlightView &)> &fn,
+                               unsigned int threads = 0);
+
+    /**
+     * @brief Seek straight to flights using a previously built index.
+     *
+     * Once set, processFile(file, flightId) and loadFlightColumns() jump
+     * directly to the requested flight instead of searching past the
+     * flights before it. The index is only used while the file being parsed
+     * agrees with it (same flight list, first flight at the same offset);
+     * otherwise those calls fall back to skipping flights as usual. Pass an
+     * empty vector to stop using an index.
+     *
+     * @param index From buildFlightIndex() or loadFlightIndex() on the same file
+     */
+    void setFlightIndex(std::vector<FlightIndexEntry> index);
+
+    /**
+     * @brief Get a file's flight index, from its sidecar file if possible.
+     *
+     * Reads "<path>.idx" next to the mapped file if it was built from this
+     * exact file (same size, modification time and ASCII headers). Otherwise
+     * builds the index with buildFlightIndex() and saves the sidecar for next
+     * time; if the sidecar can't be written a warning is printed and the
+     * freshly built index is used anyway. Either way, the file's ASCII
+     * headers are parsed, so the index is ready for forEachFlightParallel(),
+     * and the index is passed to setFlightIndex(). No callbacks fire.
+     *
+     * @param file A file returned by FlightFile::open()
+     * @return The file's flight index
+     * @throws std::runtime_error if the file's headers, or the index when it has to be built, can't be parsed
+     *
+     * Example:
+     * @code
+     *   FlightFile parser;
+     *   auto file = FlightFile::open("data.jpi");
+     *   parser.loadFlightIndex(file);    // cheap after the first time
+     *   parser.processFile(file, 186);   // seeks directly to flight 186
+     * @endcode
+     */
+    std::vector<FlightIndexEntry> loadFlightIndex(const MappedFile &file);
+
+    // =========================================================================
+    // Columnar API (a whole flight as structure-of-arrays)
+    // =========================================================================
+
+    /**
+     * @brief Decode one flight into per-metric columns.
+     *
+     * Flights before the requested one are skipped the same way as
+     * processFile(stream, flightId). The columns are sized up front from the
+     * flight's record count, and each record's values are written straight
+     * into them; no FlightMetricsRecord is created unless a record callback
+     * is registered. Registered callbacks fire as they would for
+     * processFile(stream, flightId), except for the file footer.
+     *
+     * @param stream Input stream containing the EDM file
+     * @param flightId The flight number to load
+     * @param metrics The metrics to load. If empty, every metric the file's
+     *        protocol version supports is loaded. Metrics the file doesn't
+     *        have are left out of the result.
+     * @return The flight's columns
+     * @throws std::runtime_error if the flight isn't in the file or can't be parsed
+     *
+     * Example:
+     * @code
+     *   FlightFile parser;
+     *   auto file = FlightFile::open("data.jpi");
+     *   MetricSet wanted;
+     *   wanted.insert(EGT11);
+     *   wanted.insert(CHT11);
+     *
+     *   auto cols = parser.loadFlightColumns(file, 186, wanted);
+     *   const auto &egt = cols.column(EGT11);
+     *   float peak = *std::max_element(egt.begin(), egt.end());
+     * @endcode
+     */
+    [[nodiscard]] FlightColumns loadFlightColumns(std::istream &stream, int flightId,
+                                                  const MetricSet &metrics = MetricSet{});
+    [[nodiscard]] FlightColumns loadFlightColumns(const MappedFile &file, int flightId,
+                                                  const MetricSet &metrics = MetricSet{});
 
   private:
     // Make parseFlightHeader and parseFlightDataRec accessible to iterator
     friend class FlightIterator;
+    friend class FlightRange;
     friend class FlightView;
     /**
      * Parse a header into a vector of unsigned longs.
@@ -176,31 +555,163 @@ class FlightFile
      * didn't match.
      */
     void validateHeaderChecksum(int lineno, const char *line);
-    [[nodiscard]] bool validateBinaryChecksum(std::istream &stream, std::iostream::off_type startOff,
-                                              std::iostream::off_type endOff, unsigned char checksum);
-    [[nodiscard]] std::optional<std::streamoff> detectFlightHeaderSize(std::istream &stream);
 
-    void parse(std::istream &stream);
-    void parse(std::istream &stream, int flightId);
+    /**
+     * Find the flight header size by looking for the header length whose
+     * trailing byte is a valid checksum of the bytes before it. Doesn't
+     * consume anything from the source.
+     */
+    [[nodiscard]] std::optional<std::streamoff> detectFlightHeaderSize(ByteSource &src);
+
+    /**
+     * detectFlightHeaderSize(), falling back to the minimum size for legacy
+     * models. Throws if the size can't be determined.
+     */
+    [[nodiscard]] std::streamoff requireFlightHeaderSize(ByteSource &src);
+
+    /// Index of a flight in m_flightDataCounts. Throws if it isn't there.
+    [[nodiscard]] std::size_t findFlightIndex(int flightId) const;
+
+    /**
+     * Whether m_flightIndex describes the file whose headers were just
+     * parsed, given where that file's first flight starts.
+     */
+    [[nodiscard]] bool hasFlightIndexFor(std::streamoff firstFlightOffset) const;
+
+    /**
+     * m_flightIndex, first building it by walking every flight from
+     * firstFlightOffset if it doesn't match the file. File headers must
+     * already have been parsed from src.
+     */
+    const std::vector<FlightIndexEntry> &ensureFlightIndex(ByteSource &src, std::streamoff firstFlightOffset,
+                                                           std::streamoff headerSize);
+
+    /**
+     * Where the flight at flightIdx, starting at offset, is and how many
+     * records it has. Taken from m_flightIndex if that matches, otherwise
+     * found by walking the flight's framing. Fires the header callback.
+     */
+    [[nodiscard]] FlightIndexEntry locateFlight(ByteSource &src, std::size_t flightIdx, std::streamoff offset,
+                                                std::streamoff headerSize);
+
+    /**
+     * Move past the first count flights, starting at the beginning of the
+     * first one. Flight data is stepped over by the records' framing rather
+     * than decoded. No flight callbacks fire for the skipped flights.
+     */
+    void skipFlights(ByteSource &src, std::size_t count, std::streamoff headerSize);
+
+    void parse(ByteSource &src);
+    void parse(ByteSource &src, int flightId);
+
+    [[nodiscard]] FlightRange flights(std::shared_ptr<ByteSource> src);
+    [[nodiscard]] std::vector<FlightInfo> detectFlights(ByteSource &src, std::shared_ptr<Metadata> &metadata);
 
-    void parseFileHeaders(std::istream &stream, bool strictChecksums = true);
-    [[nodiscard]] std::shared_ptr<FlightHeader> parseFlightHeader(std::istream &stream, int flightId,
+    void parseFileHeaders(ByteSource &src, bool strictChecksums = true);
+    [[nodiscard]] std::shared_ptr<FlightHeader> parseFlightHeader(ByteSource &src, int flightId,
                                                                   std::streamoff headerSize);
-    void parseFlightDataRec(std::istream &stream, const std::shared_ptr<Flight> &flight);
-    void parseFlights(std::istream &stream);
-    void parseFlights(std::istream &stream, int flightId);
-    void parseFileFooters(std::istream &stream);
+    /**
+     * Decode the next record and, if it passes the record filters, fire the
+     * record callbacks. Returns whether it passed.
+     */
+    bool parseFlightDataRec(ByteSource &src, const std::shared_ptr<Flight> &flight);
+
+    /// Decode the next record without filtering it or firing the record callbacks
+    void replayFlightDataRec(ByteSource &src, const std::shared_ptr<Flight> &flight);
+
+    /**
+     * Step over the next record using only its framing, keeping the
+     * flight's sequence, time, fast flag and record counts up to date but
+     * not its metric values.
+     */
+    void skipFlightDataRec(ByteSource &src, const std::shared_ptr<Flight> &flight);
+
+    /// Whether the flight's last decoded record passes the time window and record filter
+    [[nodiscard]] bool wantsRecord(const Flight &flight) const;
+
+    /**
+     * Decode one flight data record from a contiguous byte span.
+     *
+     * The flight's record codec walks the set bits of the field and sign
+     * maps to apply the deltas, then checksums the framed record span in one
+     * pass. startOff is the record's offset in the file and is only used for
+     * diagnostics.
+     *
+     * Returns the number of bytes consumed, including the checksum byte.
+     * Throws std::runtime_error if the span ends before the record does.
+     */
+    std::size_t decodeFlightDataRec(const uint8_t *data, std::size_t size, const std::shared_ptr<Flight> &flight,
+                                    std::streamoff startOff);
+    void parseFlights(ByteSource &src);
+    void parseFlights(ByteSource &src, int flightId);
+    void parseFileFooters(ByteSource &src);
+
+    [[nodiscard]] FlightColumns loadFlightColumns(ByteSource &src, int flightId, const MetricSet &metrics);
+
+    [[nodiscard]] std::vector<FlightIndexEntry> buildFlightIndex(ByteSource &src);
+    [[nodiscard]] IntegrityReport verify(ByteSource &src);
+
+    /// Index every flight, starting with the first one at the current position.
+    [[nodiscard]] std::vector<FlightIndexEntry> indexFlights(ByteSource &src, std::streamoff headerSize);
+
+    /**
+     * Parse the flight header at the current position, then step over the
+     * flight's records by their framing alone, leaving src at the end of
+     * the flight.
+     */
+    [[nodiscard]] FlightIndexEntry indexFlight(ByteSource &src, std::size_t flightIdx, std::streamoff headerSize);
+
+    /// A Flight that decodes the selected metrics
+    [[nodiscard]] std::shared_ptr<Flight> makeFlight(const std::shared_ptr<Metadata> &metadata) const;
+
+    /// Where feed() has got to in the file it's being fed
+    struct FeedState {
+        enum class Stage { FILE_HEADERS, FLIGHT_HEADER, RECORDS, DONE };
+
+        Stage stage{Stage::FILE_HEADERS};
+        std::vector<uint8_t> buffer;
+        std::size_t begin{0};                  ///< index in buffer of the first unparsed byte
+        std::streamoff offset{0};              ///< file offset of buffer[0]
+        std::size_t headerScan{0};             ///< index in buffer of the first header line not yet looked at
+        std::optional<std::streamoff> headerSize;
+        std::size_t flightIdx{0};              ///< index in m_flightDataCounts of the current flight
+        std::streamoff flightStart{0};         ///< file offset of the current flight's header
+        std::streamoff flightBytes{0};         ///< byte budget of the current flight, from its $D record
+        std::shared_ptr<Flight> flight;
+    };
+
+    /**
+     * Take the next parsing step of feed() with the bytes in src: the file
+     * headers, a flight header, or a flight's records. Returns false if it
+     * needs more bytes first. With atEnd, nothing more is coming, so it
+     * parses whatever is there, which throws if that's too little.
+     */
+    bool feedStep(ByteSource &src, bool atEnd);
+
+    /// feedStep() until it needs more bytes, then drop what was parsed
+    void feedSteps(bool atEnd);
+
+    /// Start a new file, feed() it everything produce passes its sink, then finish()
+    void feedWhole(const std::function<void(const ByteSink &)> &produce);
 
   private:
     std::shared_ptr<Metadata> m_metadata;
     std::vector<std::pair<int, long>> m_flightDataCounts;
+    std::vector<FlightIndexEntry> m_flightIndex;
 
     std::function<void(std::shared_ptr<Metadata>)> m_metadataCompletionCb;
     std::function<void(std::shared_ptr<FlightHeader>)> m_flightHeaderCompletionCb;
     std::function<void(std::shared_ptr<FlightMetricsRecord>)> m_flightRecCompletionCb;
+    std::function<void(const FlightRecordView &)> m_flightRecViewCb;
     std::function<void(unsigned long, unsigned long)> m_flightCompletionCb;
     std::function<void(void)> m_fileFooterCompletionCb;
 
+    std::optional<MetricSet> m_metricSelection;
+    std::function<bool(const FlightRecordView &)> m_recordFilter;
+    std::optional<std::pair<std::time_t, std::time_t>> m_timeWindow;
+
+    FeedState m_feed;
+
     bool m_isLegacyModel{false};
 };
 
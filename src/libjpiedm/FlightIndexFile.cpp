@@ -0,0 +1,332 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Sidecar files that persist a FlightFile's flight index.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include "FlightIndexFile.hpp"
+
+namespace jpi_edm {
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'J', 'P', 'I', 'E', 'D', 'M', 'I', 'X'};
+
+// Bump this whenever the layout below changes; older sidecars are then rebuilt.
+constexpr std::uint32_t INDEX_FORMAT_VERSION = 2;
+
+constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+// 64-bit FNV-1a
+std::uint64_t hashBytes(const uint8_t *data, std::size_t size)
+{
+    std::uint64_t hash = FNV_OFFSET_BASIS;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// What a sidecar was built from
+struct SourceKey {
+    std::uint64_t fileSize{0};
+    std::int64_t modifiedTime{0};
+    std::uint64_t headerLength{0}; // bytes of ASCII headers covered by headerHash
+    std::uint64_t headerHash{0};
+
+    bool operator==(const SourceKey &other) const
+    {
+        return fileSize == other.fileSize && modifiedTime == other.modifiedTime &&
+               headerLength == other.headerLength && headerHash == other.headerHash;
+    }
+};
+
+std::optional<std::int64_t> modifiedTime(const std::string &path)
+{
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return static_cast<std::int64_t>(mtime.time_since_epoch().count());
+}
+
+std::optional<SourceKey> sourceKey(const MappedFile &file, std::uint64_t headerLength)
+{
+    auto mtime = modifiedTime(file.path());
+    if (!mtime || headerLength > file.size()) {
+        return std::nullopt;
+    }
+
+    SourceKey key;
+    key.fileSize = file.size();
+    key.modifiedTime = *mtime;
+    key.headerLength = headerLength;
+    key.headerHash = hashBytes(file.data(), static_cast<std::size_t>(headerLength));
+    return key;
+}
+
+class IndexWriter
+{
+  public:
+    template <typename T> void put(T value)
+    {
+        static_assert(std::is_integral_v<T>, "only integers are serialized");
+        auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            m_bytes.push_back(static_cast<char>((bits >> (i * 8)) & 0xff));
+        }
+    }
+
+    void putKey(const SourceKey &key)
+    {
+        put(key.fileSize);
+        put(key.modifiedTime);
+        put(key.headerLength);
+        put(key.headerHash);
+    }
+
+    void putEntry(const FlightFile::FlightIndexEntry &entry)
+    {
+        put<std::int32_t>(entry.flightNumber);
+        put<std::int64_t>(entry.headerOffset);
+        put<std::int64_t>(entry.dataOffset);
+        put<std::int64_t>(entry.endOffset);
+        put<std::uint64_t>(entry.stdRecCount);
+        put<std::uint64_t>(entry.fastRecCount);
+        put<std::uint8_t>(static_cast<std::uint8_t>(entry.recordMaskSize));
+
+        const FlightHeader &hdr = *entry.header;
+        put<std::uint32_t>(hdr.flight_num);
+        put<std::uint32_t>(hdr.flags);
+        for (auto unknown : hdr.unknown) {
+            put<std::uint16_t>(unknown);
+        }
+        put<std::int32_t>(hdr.startLat);
+        put<std::int32_t>(hdr.startLng);
+        put<std::uint16_t>(hdr.unknown7);
+        put<std::uint32_t>(hdr.interval);
+        const std::tm &date = hdr.startDate;
+        for (int field : {date.tm_sec, date.tm_min, date.tm_hour, date.tm_mday, date.tm_mon, date.tm_year,
+                          date.tm_wday, date.tm_yday, date.tm_isdst}) {
+            put<std::int32_t>(field);
+        }
+    }
+
+    [[nodiscard]] const std::string &bytes() const { return m_bytes; }
+
+  private:
+    std::string m_bytes;
+};
+
+// Reads what IndexWriter wrote. Every get() fails, rather than reading past
+// the end, once the data runs out.
+class IndexReader
+{
+  public:
+    IndexReader(const uint8_t *data, std::size_t size) : m_data(data), m_size(size) {}
+
+    template <typename T> bool get(T &value)
+    {
+        static_assert(std::is_integral_v<T>, "only integers are serialized");
+        if (m_size - m_pos < sizeof(T)) {
+            return false;
+        }
+        std::make_unsigned_t<T> bits = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<std::make_unsigned_t<T>>(static_cast<std::make_unsigned_t<T>>(m_data[m_pos + i])
+                                                         << (i * 8));
+        }
+        m_pos += sizeof(T);
+        value = static_cast<T>(bits);
+        return true;
+    }
+
+    bool getKey(SourceKey &key)
+    {
+        return get(key.fileSize) && get(key.modifiedTime) && get(key.headerLength) && get(key.headerHash);
+    }
+
+    bool getEntry(FlightFile::FlightIndexEntry &entry)
+    {
+        std::int32_t flightNumber = 0;
+        std::int64_t headerOffset = 0;
+        std::int64_t dataOffset = 0;
+        std::int64_t endOffset = 0;
+        std::uint64_t stdRecCount = 0;
+        std::uint64_t fastRecCount = 0;
+        std::uint8_t recordMaskSize = 0;
+        if (!(get(flightNumber) && get(headerOffset) && get(dataOffset) && get(endOffset) && get(stdRecCount) &&
+              get(fastRecCount) && get(recordMaskSize))) {
+            return false;
+        }
+        if (recordMaskSize != OLD_RECORD_MASK_SIZE && recordMaskSize != RECORD_MASK_SIZE) {
+            return false;
+        }
+        entry.flightNumber = flightNumber;
+        entry.headerOffset = static_cast<std::streamoff>(headerOffset);
+        entry.dataOffset = static_cast<std::streamoff>(dataOffset);
+        entry.endOffset = static_cast<std::streamoff>(endOffset);
+        entry.stdRecCount = static_cast<unsigned long>(stdRecCount);
+        entry.fastRecCount = static_cast<unsigned long>(fastRecCount);
+        entry.recordMaskSize = recordMaskSize;
+
+        auto hdr = std::make_shared<FlightHeader>();
+        std::uint32_t flightNum = 0;
+        std::uint32_t interval = 0;
+        if (!(get(flightNum) && get(hdr->flags) && get(hdr->unknown[0]) && get(hdr->unknown[1]) &&
+              get(hdr->unknown[2]) && get(hdr->startLat) && get(hdr->startLng) && get(hdr->unknown7) &&
+              get(interval))) {
+            return false;
+        }
+        hdr->flight_num = flightNum;
+        hdr->interval = interval;
+        std::tm &date = hdr->startDate;
+        for (int *field : {&date.tm_sec, &date.tm_min, &date.tm_hour, &date.tm_mday, &date.tm_mon, &date.tm_year,
+                           &date.tm_wday, &date.tm_yday, &date.tm_isdst}) {
+            std::int32_t value = 0;
+            if (!get(value)) {
+                return false;
+            }
+            *field = value;
+        }
+        entry.header = hdr;
+        return true;
+    }
+
+    [[nodiscard]] std::size_t position() const { return m_pos; }
+
+  private:
+    const uint8_t *m_data;
+    std::size_t m_size;
+    std::size_t m_pos{0};
+};
+
+} // namespace
+
+std::string FlightIndexFile::pathFor(const std::string &path) { return path + ".idx"; }
+
+std::optional<std::vector<FlightFile::FlightIndexEntry>> FlightIndexFile::read(const MappedFile &file)
+{
+    std::ifstream in(pathFor(file.path()), std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // Everything but the trailing hash has to hash to it
+    const std::size_t hashSize = sizeof(std::uint64_t);
+    if (bytes.size() < sizeof(INDEX_MAGIC) + hashSize ||
+        std::memcmp(bytes.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        return std::nullopt;
+    }
+    std::size_t payloadSize = bytes.size() - hashSize;
+    std::uint64_t storedHash = 0;
+    IndexReader(bytes.data() + payloadSize, hashSize).get(storedHash);
+    if (storedHash != hashBytes(bytes.data(), payloadSize)) {
+        return std::nullopt;
+    }
+
+    IndexReader reader(bytes.data() + sizeof(INDEX_MAGIC), payloadSize - sizeof(INDEX_MAGIC));
+    std::uint32_t version = 0;
+    SourceKey storedKey;
+    if (!reader.get(version) || version != INDEX_FORMAT_VERSION || !reader.getKey(storedKey)) {
+        return std::nullopt;
+    }
+
+    // Cheap checks first; only hash the headers if the size and time match
+    auto mtime = modifiedTime(file.path());
+    if (storedKey.fileSize != file.size() || !mtime || storedKey.modifiedTime != *mtime) {
+        return std::nullopt;
+    }
+    auto currentKey = sourceKey(file, storedKey.headerLength);
+    if (!currentKey || !(*currentKey == storedKey)) {
+        return std::nullopt;
+    }
+
+    std::uint32_t count = 0;
+    if (!reader.get(count)) {
+        return std::nullopt;
+    }
+    std::vector<FlightFile::FlightIndexEntry> index;
+    std::streamoff prevEnd = static_cast<std::streamoff>(storedKey.headerLength);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        FlightFile::FlightIndexEntry entry;
+        if (!reader.getEntry(entry) || entry.headerOffset < prevEnd || entry.dataOffset <= entry.headerOffset ||
+            entry.endOffset < entry.dataOffset || entry.endOffset > static_cast<std::streamoff>(file.size())) {
+            return std::nullopt;
+        }
+        prevEnd = entry.endOffset;
+        index.push_back(std::move(entry));
+    }
+    if (reader.position() != payloadSize - sizeof(INDEX_MAGIC)) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+void FlightIndexFile::write(const MappedFile &file, const std::vector<FlightFile::FlightIndexEntry> &index)
+{
+    std::uint64_t headerLength = index.empty() ? file.size() : static_cast<std::uint64_t>(index.front().headerOffset);
+    auto key = sourceKey(file, headerLength);
+    if (!key) {
+        std::stringstream msg;
+        msg << "Can't determine the modification time of " << file.path();
+        throw std::runtime_error(msg.str());
+    }
+
+    IndexWriter writer;
+    for (char c : INDEX_MAGIC) {
+        writer.put(c);
+    }
+    writer.put(INDEX_FORMAT_VERSION);
+    writer.putKey(*key);
+    writer.put(static_cast<std::uint32_t>(index.size()));
+    for (const auto &entry : index) {
+        writer.putEntry(entry);
+    }
+    const std::string &payload = writer.bytes();
+    IndexWriter trailer;
+    trailer.put(hashBytes(reinterpret_cast<const uint8_t *>(payload.data()), payload.size()));
+
+    std::string path = pathFor(file.path());
+    std::string tmpPath = path + ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out << payload << trailer.bytes();
+        out.close();
+        if (!out) {
+            std::remove(tmpPath.c_str());
+            std::stringstream msg;
+            msg << "Failed to write flight index " << tmpPath;
+            throw std::runtime_error(msg.str());
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::remove(tmpPath.c_str());
+        std::stringstream msg;
+        msg << "Failed to write flight index " << path << ": " << ec.message();
+        throw std::runtime_error(msg.str());
+    }
+}
+
+} // namespace jpi_edm
@@ -0,0 +1,53 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Sidecar files that persist a FlightFile's flight index.
+ *
+ * Building a flight index means walking every record in the file. When the
+ * same file gets opened over and over, that walk can be done once and the
+ * result saved next to the file as "<file>.idx". The sidecar carries the
+ * size and modification time of the file it was built from, plus a hash of
+ * its ASCII headers, and is ignored if any of those no longer match.
+ *
+ * The format is little-endian binary, ending in a hash of everything before
+ * it, so truncated or damaged sidecars are ignored too. Use
+ * FlightFile::loadFlightIndex() rather than calling this directly.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "FlightFile.hpp"
+#include "MappedFile.hpp"
+
+namespace jpi_edm {
+
+class FlightIndexFile
+{
+  public:
+    /// Where the sidecar for the EDM file at path lives
+    [[nodiscard]] static std::string pathFor(const std::string &path);
+
+    /**
+     * Read the sidecar for a mapped EDM file.
+     *
+     * @return The index, or nullopt if there's no sidecar, it was built from
+     *         a different version of the file, or it's damaged
+     */
+    [[nodiscard]] static std::optional<std::vector<FlightFile::FlightIndexEntry>> read(const MappedFile &file);
+
+    /**
+     * Write the sidecar for a mapped EDM file, replacing any existing one.
+     * The sidecar is written to a temporary file first and renamed into
+     * place, so concurrent readers never see a partial one.
+     *
+     * @throws std::runtime_error if the sidecar can't be written
+     */
+    static void write(const MappedFile &file, const std::vector<FlightFile::FlightIndexEntry> &index);
+};
+
+} // namespace jpi_edm
@@ -8,7 +8,9 @@
 #include "FlightIterator.hpp"
 #include "FlightFile.hpp"
 
-#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
 
 namespace jpi_edm {
@@ -17,23 +19,19 @@ namespace jpi_edm {
 // FlightView::RecordIterator Implementation
 // =============================================================================
 
-FlightView::RecordIterator::RecordIterator(std::istream *stream, FlightFile *parser, std::shared_ptr<Flight> flight,
-                                           std::streamoff startOffset, std::streamoff totalBytes)
-    : m_stream(stream), m_parser(parser), m_flight(flight), m_startOffset(startOffset), m_totalBytes(totalBytes),
+FlightView::RecordIterator::RecordIterator(std::shared_ptr<ByteSource> source, FlightFile *parser,
+                                           std::shared_ptr<Flight> flight, std::streamoff startOffset,
+                                           std::streamoff totalBytes)
+    : m_source(source), m_parser(parser), m_flight(flight), m_startOffset(startOffset), m_totalBytes(totalBytes),
       m_currentOffset(0), m_isEnd(false)
 {
-    if (!m_stream || !m_parser || !m_flight) {
+    if (!m_source || !m_parser || !m_flight) {
         m_isEnd = true;
         return;
     }
 
-    // Position stream at start of flight data records
-    m_stream->clear();
-    m_stream->seekg(m_startOffset, std::ios::beg);
-    if (!m_stream->good()) {
-        m_isEnd = true;
-        return;
-    }
+    // Position source at start of flight data records
+    m_source->seek(m_startOffset);
 
     // Parse the first record
     advance();
@@ -41,24 +39,30 @@ FlightView::RecordIterator::RecordIterator(std::istream *stream, FlightFile *par
 
 void FlightView::RecordIterator::advance()
 {
-    if (m_isEnd || !m_stream || !m_parser || !m_flight) {
-        m_isEnd = true;
-        m_currentRecord.reset();
-        return;
-    }
-
-    // Check if we've read all the data for this flight
-    auto currentPos = m_stream->tellg();
-    if (currentPos == -1 || (currentPos - m_startOffset) >= m_totalBytes) {
+    if (m_isEnd || !m_source || !m_parser || !m_flight) {
         m_isEnd = true;
         m_currentRecord.reset();
         return;
     }
 
     try {
-        // Parse the next record
-        m_parser->parseFlightDataRec(*m_stream, m_flight);
-        m_currentRecord = m_flight->getFlightMetricsRecord();
+        // Parse records until one passes the parser's record filters, or
+        // all the data for this flight has been read
+        do {
+            if ((m_source->tell() - m_startOffset) >= m_totalBytes) {
+                m_isEnd = true;
+                m_currentRecord.reset();
+                return;
+            }
+        } while (!m_parser->parseFlightDataRec(*m_source, m_flight));
+
+        // Nobody else can see the last record unless they took a copy of
+        // the pointer, so overwrite it rather than allocating another
+        if (m_currentRecord && m_currentRecord.use_count() == 1) {
+            m_flight->copyFlightMetricsRecord(*m_currentRecord);
+        } else {
+            m_currentRecord = m_flight->getFlightMetricsRecord();
+        }
     } catch (const std::exception &) {
         // If parsing fails, mark as end
         m_isEnd = true;
@@ -106,9 +110,9 @@ bool FlightView::RecordIterator::operator==(const RecordIterator &other) const
     if (m_isEnd != other.m_isEnd) {
         return false;
     }
-    // Both are valid - compare stream position and flight
-    return (m_stream == other.m_stream) && (m_flight == other.m_flight) &&
-           (m_stream->tellg() == other.m_stream->tellg());
+    // Both are valid - compare source position and flight
+    return (m_source == other.m_source) && (m_flight == other.m_flight) &&
+           (m_source->tell() == other.m_source->tell());
 }
 
 bool FlightView::RecordIterator::operator!=(const RecordIterator &other) const { return !(*this == other); }
@@ -117,10 +121,11 @@ bool FlightView::RecordIterator::operator!=(const RecordIterator &other) const {
 // FlightView Implementation
 // =============================================================================
 
-FlightView::FlightView(std::istream *stream, FlightFile *parser, std::shared_ptr<FlightHeader> header,
-                       std::shared_ptr<Flight> flight, std::streamoff startOffset, std::streamoff totalBytes)
-    : m_stream(stream), m_parser(parser), m_header(header), m_flight(flight), m_startOffset(startOffset),
-      m_totalBytes(totalBytes)
+FlightView::FlightView(std::shared_ptr<ByteSource> source, FlightFile *parser, std::shared_ptr<FlightHeader> header,
+                       std::shared_ptr<Flight> flight, std::streamoff startOffset, std::streamoff totalBytes,
+                       unsigned long stdRecCount, unsigned long fastRecCount)
+    : m_source(source), m_parser(parser), m_header(header), m_flight(flight), m_startOffset(startOffset),
+      m_totalBytes(totalBytes), m_stdRecCount(stdRecCount), m_fastRecCount(fastRecCount)
 {
     if (!m_header) {
         throw std::invalid_argument("FlightView: header cannot be null");
@@ -129,10 +134,12 @@ FlightView::FlightView(std::istream *stream, FlightFile *parser, std::shared_ptr
 
 FlightView::RecordIterator FlightView::begin() const
 {
-    if (!m_stream || !m_parser || !m_flight) {
+    if (!m_source || !m_parser || !m_flight) {
         return RecordIterator(); // Return end iterator
     }
-    return RecordIterator(m_stream, m_parser, m_flight, m_startOffset, m_totalBytes);
+    // Records are deltas from the one before, so decode into a Flight that
+    // hasn't seen any yet.
+    return recordsFrom(restoreCheckpoint(nullptr));
 }
 
 FlightView::RecordIterator FlightView::end() const
@@ -140,17 +147,120 @@ FlightView::RecordIterator FlightView::end() const
     return RecordIterator(); // Default-constructed is end iterator
 }
 
+void FlightView::buildCheckpoints(std::size_t interval)
+{
+    if (interval == 0) {
+        throw std::invalid_argument("FlightView: checkpoint interval must be positive");
+    }
+
+    auto checkpoints = std::make_shared<std::vector<RecordCheckpoint>>();
+    if (m_source && m_parser && m_flight) {
+        checkpoints->reserve(getTotalRecordCount() / interval + 1);
+
+        auto flight = restoreCheckpoint(nullptr);
+        std::time_t time = m_header->startTime();
+        const std::streamoff endOffset = m_startOffset + m_totalBytes;
+        for (std::size_t record = 0; m_source->tell() < endOffset; ++record) {
+            if (record % interval == 0) {
+                checkpoints->push_back(RecordCheckpoint{record, m_source->tell(), time, flight->saveState()});
+            }
+            m_parser->replayFlightDataRec(*m_source, flight);
+            time += flight->secondsToNextRecord();
+        }
+    }
+
+    m_checkpointInterval = interval;
+    m_checkpoints = checkpoints;
+}
+
+void FlightView::setMetricSelection(const MetricSet &metrics)
+{
+    if (!m_flight) {
+        return;
+    }
+    // Every decode starts from a copy of m_flight's settings, so this is where the selection lives
+    auto flight = std::make_shared<Flight>(m_flight->m_metadata,
+                                           metrics.empty() ? std::nullopt : std::optional<MetricSet>(metrics));
+    flight->m_flightHeader = m_header;
+    m_flight = flight;
+    m_checkpointInterval = 0;
+    m_checkpoints.reset();
+}
+
+FlightView::RecordIterator FlightView::seekToRecord(std::size_t n) const
+{
+    if (!m_source || !m_parser || !m_flight || n >= getTotalRecordCount()) {
+        return end();
+    }
+
+    // Checkpoints are evenly spaced, so the nearest one is found by division
+    const RecordCheckpoint *cp = nullptr;
+    if (m_checkpoints && !m_checkpoints->empty()) {
+        cp = &(*m_checkpoints)[std::min(n / m_checkpointInterval, m_checkpoints->size() - 1)];
+    }
+
+    auto flight = restoreCheckpoint(cp);
+    for (std::size_t record = cp ? cp->recordIndex : 0; record < n; ++record) {
+        m_parser->replayFlightDataRec(*m_source, flight);
+    }
+    return recordsFrom(flight);
+}
+
+FlightView::RecordIterator FlightView::seekToTime(std::time_t t) const
+{
+    if (!m_source || !m_parser || !m_flight) {
+        return end();
+    }
+
+    // The last checkpoint that isn't after t
+    const RecordCheckpoint *cp = nullptr;
+    if (m_checkpoints) {
+        auto after = std::upper_bound(m_checkpoints->begin(), m_checkpoints->end(), t,
+                                      [](std::time_t time, const RecordCheckpoint &c) { return time < c.time; });
+        if (after != m_checkpoints->begin()) {
+            cp = &*std::prev(after);
+        }
+    }
+
+    auto flight = restoreCheckpoint(cp);
+    std::time_t time = cp ? cp->time : m_header->startTime();
+    const std::streamoff endOffset = m_startOffset + m_totalBytes;
+    while (time < t && m_source->tell() < endOffset) {
+        m_parser->replayFlightDataRec(*m_source, flight);
+        time += flight->secondsToNextRecord();
+    }
+    return recordsFrom(flight);
+}
+
+std::shared_ptr<Flight> FlightView::restoreCheckpoint(const RecordCheckpoint *cp) const
+{
+    auto flight = std::make_shared<Flight>(m_flight->m_metadata, m_flight->metricSelection());
+    flight->m_flightHeader = m_header;
+    if (cp) {
+        flight->restoreState(cp->state);
+    }
+    m_source->seek(cp ? cp->offset : m_startOffset);
+    return flight;
+}
+
+FlightView::RecordIterator FlightView::recordsFrom(const std::shared_ptr<Flight> &flight) const
+{
+    auto offset = m_source->tell();
+    return RecordIterator(m_source, m_parser, flight, offset, m_startOffset + m_totalBytes - offset);
+}
+
 // =============================================================================
 // FlightIterator Implementation
 // =============================================================================
 
-FlightIterator::FlightIterator(std::istream *stream, FlightFile *parser, std::shared_ptr<Metadata> metadata,
+FlightIterator::FlightIterator(std::shared_ptr<ByteSource> source, FlightFile *parser,
+                               std::shared_ptr<Metadata> metadata,
                                const std::vector<std::pair<int, long>> *flightDataCounts, std::streamoff headerSize,
-                               size_t index)
-    : m_stream(stream), m_parser(parser), m_metadata(metadata), m_flightDataCounts(flightDataCounts),
-      m_headerSize(headerSize), m_index(index), m_isEnd(false)
+                               size_t index, std::streamoff offset)
+    : m_source(source), m_parser(parser), m_metadata(metadata), m_flightDataCounts(flightDataCounts),
+      m_headerSize(headerSize), m_index(index), m_offset(offset), m_isEnd(false)
 {
-    if (!m_stream || !m_parser || !m_metadata || !m_flightDataCounts) {
+    if (!m_source || !m_parser || !m_metadata || !m_flightDataCounts) {
         m_isEnd = true;
         return;
     }
@@ -160,19 +270,13 @@ FlightIterator::FlightIterator(std::istream *stream, FlightFile *parser, std::sh
         return;
     }
 
-    // The stream should already be positioned correctly by FlightRange::begin() for index 0.
-    // For index > 0, we would need to calculate the offset, but iterators are normally
-    // created with index 0 and incremented, so advance() maintains position.
-    // Just ensure stream is in a good state - don't reposition it
-    m_stream->clear();
-
     // Parse the flight at m_index
     advance();
 }
 
 void FlightIterator::advance()
 {
-    if (m_isEnd || !m_stream || !m_parser || !m_flightDataCounts) {
+    if (m_isEnd || !m_source || !m_parser || !m_flightDataCounts) {
         m_isEnd = true;
         return;
     }
@@ -183,74 +287,17 @@ void FlightIterator::advance()
     }
 
     try {
-        const auto &flightDataCount = (*m_flightDataCounts)[m_index];
-
-        auto startOff = m_stream->tellg();
-        if (startOff == -1) {
-            throw std::runtime_error("Failed to get stream position before reading flight data");
-        }
+        // Only the flight's framing is walked to find where it ends; its
+        // records aren't decoded until the FlightView is iterated.
+        auto entry = m_parser->locateFlight(*m_source, m_index, m_offset, m_headerSize);
 
-        // Validate flight data count - be more lenient for legacy models
-        const std::streamoff MAX_FLIGHT_RECORDS = 1000000;
-        bool isLegacyModel =
-            (m_metadata && m_metadata->m_configInfo.edm_model > 0 && m_metadata->m_configInfo.edm_model < 800);
-
-        // For legacy models, allow 0 (header only, no data records)
-        if (flightDataCount.second < 0 || flightDataCount.second > MAX_FLIGHT_RECORDS) {
-            if (!isLegacyModel || flightDataCount.second < 0) {
-                throw std::runtime_error("Invalid flight data count");
-            }
-        }
-
-        // Calculate flight data section size
-        // flightDataCount.second gives the size in "byte pairs" (need to multiply by 2)
-        // This represents the TOTAL size of the flight data section
-        // The callback API uses (flightDataCount.second - 1) * 2 as a loop limit,
-        // but the actual flight size is flightDataCount.second * 2
-        std::streamoff flightDataSize;
-        if (flightDataCount.second > std::numeric_limits<std::streamoff>::max() / 2) {
-            throw std::runtime_error("Flight data count too large");
-        }
-        flightDataSize = flightDataCount.second * 2;
-
-        // Create flight object
-        auto flight = std::make_shared<Flight>(m_metadata);
-
-        // Parse flight header
-        auto flightHeader = m_parser->parseFlightHeader(*m_stream, flightDataCount.first, m_headerSize);
-        flight->m_flightHeader = flightHeader;
-
-        if (!m_stream->good()) {
-            throw std::runtime_error("Stream error after reading flight header");
-        }
-
-        // Record position after header for data records
-        auto dataStartOff = m_stream->tellg();
-        if (dataStartOff == -1) {
-            throw std::runtime_error("Failed to get stream position after flight header");
-        }
-
-        // Create FlightView (records will be parsed lazily)
-        // For FlightView, we still use the callback API's calculation for data size
-        std::streamoff recordCount = (flightDataCount.second > 0) ? (flightDataCount.second - 1L) : 0L;
-        std::streamoff totalBytes = recordCount * 2;
-        m_currentFlight = FlightView(m_stream, m_parser, flightHeader, flight, dataStartOff, totalBytes);
-
-        // Read all data records to find where this flight ends (matching callback API behavior)
-        // The callback API loop: while ((stream.tellg() - startOff) < totalBytes) { parseFlightDataRec(...); }
-        // We must do the same to ensure stream position matches
-        while ((m_stream->tellg() - startOff) < totalBytes) {
-            if (!m_stream->good()) {
-                throw std::runtime_error("Stream error while skipping flight data records");
-            }
-            m_parser->parseFlightDataRec(*m_stream, flight);
-        }
-
-        // Stream is now positioned at the start of the next flight
-        if (!m_stream->good()) {
-            throw std::runtime_error("Stream error after reading flight data");
-        }
+        auto flight = m_parser->makeFlight(m_metadata);
+        flight->m_flightHeader = entry.header;
+        m_currentFlight = FlightView(m_source, m_parser, entry.header, flight, entry.dataOffset,
+                                     entry.endOffset - entry.dataOffset, entry.stdRecCount, entry.fastRecCount);
 
+        // The next flight starts where this one ends
+        m_offset = entry.endOffset;
     } catch (const std::exception &) {
         m_isEnd = true;
         throw;
@@ -298,8 +345,8 @@ bool FlightIterator::operator==(const FlightIterator &other) const
     if (m_isEnd != other.m_isEnd) {
         return false;
     }
-    // Both are valid - compare stream and index
-    return (m_stream == other.m_stream) && (m_index == other.m_index);
+    // Both are valid - compare source and index
+    return (m_source == other.m_source) && (m_index == other.m_index);
 }
 
 bool FlightIterator::operator!=(const FlightIterator &other) const { return !(*this == other); }
@@ -308,31 +355,60 @@ bool FlightIterator::operator!=(const FlightIterator &other) const { return !(*t
 // FlightRange Implementation
 // =============================================================================
 
-FlightRange::FlightRange(std::istream *stream, FlightFile *parser, std::shared_ptr<Metadata> metadata,
+FlightRange::FlightRange(std::shared_ptr<ByteSource> source, FlightFile *parser, std::shared_ptr<Metadata> metadata,
                          const std::vector<std::pair<int, long>> *flightDataCounts, std::streamoff headerSize,
                          std::streamoff flightDataStartPos)
-    : m_stream(stream), m_parser(parser), m_metadata(metadata), m_flightDataCounts(flightDataCounts),
+    : m_source(source), m_parser(parser), m_metadata(metadata), m_flightDataCounts(flightDataCounts),
       m_headerSize(headerSize), m_flightDataStartPos(flightDataStartPos)
 {
 }
 
 FlightIterator FlightRange::begin() const
 {
-    if (!m_stream || !m_parser || !m_metadata || !m_flightDataCounts || m_flightDataCounts->empty()) {
+    if (!m_source || !m_parser || !m_metadata || !m_flightDataCounts || m_flightDataCounts->empty()) {
         return FlightIterator(); // Return end iterator
     }
-    // Position stream at start of flight data
-    m_stream->clear();
-    m_stream->seekg(m_flightDataStartPos, std::ios::beg);
-    return FlightIterator(m_stream, m_parser, m_metadata, m_flightDataCounts, m_headerSize, 0);
+    return FlightIterator(m_source, m_parser, m_metadata, m_flightDataCounts, m_headerSize, 0, m_flightDataStartPos);
 }
 
 FlightIterator FlightRange::end() const
 {
-    if (!m_stream || !m_parser || !m_metadata || !m_flightDataCounts) {
+    if (!m_source || !m_parser || !m_metadata || !m_flightDataCounts) {
         return FlightIterator(); // Return end iterator
     }
-    return FlightIterator(m_stream, m_parser, m_metadata, m_flightDataCounts, m_headerSize, m_flightDataCounts->size());
+    return FlightIterator(m_source, m_parser, m_metadata, m_flightDataCounts, m_headerSize, m_flightDataCounts->size());
+}
+
+std::size_t FlightRange::size() const { return m_flightDataCounts ? m_flightDataCounts->size() : 0; }
+
+FlightView FlightRange::at(std::size_t index) const
+{
+    if (!m_source || !m_parser || !m_metadata || index >= size()) {
+        std::stringstream msg;
+        msg << "FlightRange: no flight at index " << index << " (file has " << size() << ")";
+        throw std::out_of_range(msg.str());
+    }
+    return *iteratorAt(index);
+}
+
+FlightIterator FlightRange::findFlight(int flightNumber) const
+{
+    if (!m_source || !m_parser || !m_metadata || !m_flightDataCounts) {
+        return end();
+    }
+    for (std::size_t i = 0; i < m_flightDataCounts->size(); ++i) {
+        if ((*m_flightDataCounts)[i].first == flightNumber) {
+            return iteratorAt(i);
+        }
+    }
+    return end();
+}
+
+FlightIterator FlightRange::iteratorAt(std::size_t index) const
+{
+    const auto &flightIndex = m_parser->ensureFlightIndex(*m_source, m_flightDataStartPos, m_headerSize);
+    return FlightIterator(m_source, m_parser, m_metadata, m_flightDataCounts, m_headerSize, index,
+                          flightIndex[index].headerOffset);
 }
 
 } // namespace jpi_edm
@@ -17,13 +17,18 @@
 
 #pragma once
 
+#include <cstddef>
+#include <ctime>
 #include <iostream>
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <vector>
 
+#include "ByteSource.hpp"
 #include "Flight.hpp"
 #include "Metadata.hpp"
+#include "ProtocolConstants.hpp"
 
 namespace jpi_edm {
 
@@ -45,6 +50,11 @@ class FlightView
      *
      * This is a streaming iterator that parses flight data records
      * on-demand as you iterate. It does NOT load all records into memory.
+     *
+     * Each step reuses the previous record's storage unless something else
+     * still holds a copy of its shared_ptr, so a plain range-for allocates
+     * nothing per record. Keep the shared_ptr, not a raw pointer or a
+     * reference to the record, to hold on to one.
      */
     class RecordIterator
     {
@@ -59,7 +69,7 @@ class FlightView
         RecordIterator() = default;
 
         // Construct begin iterator
-        RecordIterator(std::istream *stream, FlightFile *parser, std::shared_ptr<Flight> flight,
+        RecordIterator(std::shared_ptr<ByteSource> source, FlightFile *parser, std::shared_ptr<Flight> flight,
                        std::streamoff startOffset, std::streamoff totalBytes);
 
         // Iterator operations
@@ -74,7 +84,7 @@ class FlightView
       private:
         void advance();
 
-        std::istream *m_stream{nullptr};
+        std::shared_ptr<ByteSource> m_source;
         FlightFile *m_parser{nullptr};
         std::shared_ptr<Flight> m_flight;
         std::streamoff m_startOffset{0};
@@ -86,27 +96,84 @@ class FlightView
 
     FlightView() = default;
 
-    FlightView(std::istream *stream, FlightFile *parser, std::shared_ptr<FlightHeader> header,
-               std::shared_ptr<Flight> flight, std::streamoff startOffset, std::streamoff totalBytes);
+    // startOffset is the flight's first data record, and totalBytes the size
+    // of all its records. The record counts come from the flight's framing.
+    FlightView(std::shared_ptr<ByteSource> source, FlightFile *parser, std::shared_ptr<FlightHeader> header,
+               std::shared_ptr<Flight> flight, std::streamoff startOffset, std::streamoff totalBytes,
+               unsigned long stdRecCount, unsigned long fastRecCount);
 
     // Access to flight metadata
     [[nodiscard]] const FlightHeader &getHeader() const { return *m_header; }
     [[nodiscard]] std::shared_ptr<FlightHeader> getHeaderPtr() const { return m_header; }
-    [[nodiscard]] unsigned long getStandardRecordCount() const { return (m_flight) ? m_flight->m_stdRecCount : 0UL; }
-    [[nodiscard]] unsigned long getFastRecordCount() const { return (m_flight) ? m_flight->m_fastRecCount : 0UL; }
+    [[nodiscard]] unsigned long getStandardRecordCount() const { return m_stdRecCount; }
+    [[nodiscard]] unsigned long getFastRecordCount() const { return m_fastRecCount; }
     [[nodiscard]] unsigned long getTotalRecordCount() const { return getStandardRecordCount() + getFastRecordCount(); }
 
-    // Iterator interface for records (lazy parsing)
+    // Iterator interface for records (lazy parsing). Every begin() starts
+    // decoding afresh from the first record.
     [[nodiscard]] RecordIterator begin() const;
     [[nodiscard]] RecordIterator end() const;
 
+    /**
+     * @brief Decode the flight once, saving the decoder state every interval records.
+     *
+     * Records are deltas from the one before, so getting to record n
+     * normally means decoding every record before it. With checkpoints,
+     * seekToRecord() and seekToTime() restore the nearest earlier checkpoint
+     * and decode at most interval - 1 records to get there. Copies of this
+     * FlightView share its checkpoints. Record callbacks don't fire.
+     *
+     * @throws std::invalid_argument if interval is 0
+     */
+    void buildCheckpoints(std::size_t interval = DEFAULT_CHECKPOINT_INTERVAL);
+    [[nodiscard]] bool hasCheckpoints() const { return m_checkpoints != nullptr; }
+
+    /**
+     * @brief Only decode some metrics when iterating this flight.
+     *
+     * Overrides FlightFile::setMetricSelection() for this view and its
+     * copies made afterwards. An empty set means every metric. Checkpoints
+     * hold the old selection's values, so they're dropped.
+     */
+    void setMetricSelection(const MetricSet &metrics);
+
+    /**
+     * @brief Records from record n (counting from 0) to the end of the flight.
+     *
+     * Without checkpoints this decodes all the records before n; record
+     * callbacks only fire for the records the returned iterator visits.
+     *
+     * @return An iterator on record n, or end() if the flight has n or fewer records
+     */
+    [[nodiscard]] RecordIterator seekToRecord(std::size_t n) const;
+
+    /**
+     * @brief Records from the first one logged at or after time t.
+     *
+     * Record times start at the header's start date and advance by the
+     * flight's interval, or by one second in fast mode.
+     *
+     * @return An iterator on that record, or end() if every record is earlier than t
+     */
+    [[nodiscard]] RecordIterator seekToTime(std::time_t t) const;
+
   private:
-    std::istream *m_stream{nullptr};
+    // A fresh Flight and the source positioned at a checkpoint, or at the first record if cp is null
+    [[nodiscard]] std::shared_ptr<Flight> restoreCheckpoint(const RecordCheckpoint *cp) const;
+
+    // Records from the source's current position to the end of the flight
+    [[nodiscard]] RecordIterator recordsFrom(const std::shared_ptr<Flight> &flight) const;
+
+    std::shared_ptr<ByteSource> m_source;
     FlightFile *m_parser{nullptr};
     std::shared_ptr<FlightHeader> m_header;
     std::shared_ptr<Flight> m_flight;
     std::streamoff m_startOffset{0};
     std::streamoff m_totalBytes{0};
+    unsigned long m_stdRecCount{0};
+    unsigned long m_fastRecCount{0};
+    std::size_t m_checkpointInterval{0};
+    std::shared_ptr<const std::vector<RecordCheckpoint>> m_checkpoints;
 };
 
 /**
@@ -142,9 +209,10 @@ class FlightIterator
     FlightIterator() = default;
 
     // Construct begin iterator
-    FlightIterator(std::istream *stream, FlightFile *parser, std::shared_ptr<Metadata> metadata,
+    // offset is where the flight at index starts
+    FlightIterator(std::shared_ptr<ByteSource> source, FlightFile *parser, std::shared_ptr<Metadata> metadata,
                    const std::vector<std::pair<int, long>> *flightDataCounts, std::streamoff headerSize,
-                   size_t index = 0);
+                   size_t index = 0, std::streamoff offset = 0);
 
     // Iterator operations
     reference operator*() const;
@@ -158,12 +226,13 @@ class FlightIterator
   private:
     void advance();
 
-    std::istream *m_stream{nullptr};
+    std::shared_ptr<ByteSource> m_source;
     FlightFile *m_parser{nullptr};
     std::shared_ptr<Metadata> m_metadata;
     const std::vector<std::pair<int, long>> *m_flightDataCounts{nullptr};
     std::streamoff m_headerSize{0};
     size_t m_index{0};
+    std::streamoff m_offset{0}; // start of the flight at m_index
     FlightView m_currentFlight;
     bool m_isEnd{true};
 };
@@ -177,15 +246,47 @@ class FlightIterator
 class FlightRange
 {
   public:
-    FlightRange(std::istream *stream, FlightFile *parser, std::shared_ptr<Metadata> metadata,
+    FlightRange(std::shared_ptr<ByteSource> source, FlightFile *parser, std::shared_ptr<Metadata> metadata,
                 const std::vector<std::pair<int, long>> *flightDataCounts, std::streamoff headerSize,
                 std::streamoff flightDataStartPos);
 
     [[nodiscard]] FlightIterator begin() const;
     [[nodiscard]] FlightIterator end() const;
 
+    /// Number of flights in the file
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+    /**
+     * @brief The flight at a position in the file, without decoding the
+     * flights before it.
+     *
+     * The first call builds the file's flight boundary index by walking
+     * the records' framing (or uses the parser's index, if it was loaded
+     * with FlightFile::loadFlightIndex()); after that any flight can be
+     * reached with a single seek.
+     *
+     * @param index Position of the flight in the file, from 0
+     * @throws std::out_of_range if there's no flight at that position
+     */
+    [[nodiscard]] FlightView at(std::size_t index) const;
+
+    /**
+     * @brief Find a flight by its flight number, without decoding the
+     * flights before it.
+     *
+     * Like at(), this uses the flight boundary index. Incrementing the
+     * returned iterator carries on with the following flights.
+     *
+     * @return An iterator positioned on the flight, or end() if the file
+     *         has no flight with that number
+     */
+    [[nodiscard]] FlightIterator findFlight(int flightNumber) const;
+
   private:
-    std::istream *m_stream;
+    [[nodiscard]] FlightIterator iteratorAt(std::size_t index) const;
+
+    std::shared_ptr<ByteSource> m_source;
     FlightFile *m_parser;
     std::shared_ptr<Metadata> m_metadata;
     const std::vector<std::pair<int, long>> *m_flightDataCounts;
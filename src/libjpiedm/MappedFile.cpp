@@ -0,0 +1,157 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Read-only memory mapping of an EDM file.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.hpp"
+
+namespace jpi_edm {
+
+namespace {
+[[noreturn]] void throwMapError(const std::string &what, const std::string &path)
+{
+    std::stringstream msg;
+    msg << what << " " << path;
+#ifndef _WIN32
+    msg << " (" << std::strerror(errno) << ")";
+#endif
+    throw std::runtime_error(msg.str());
+}
+} // namespace
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path) : m_path(path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throwMapError("Couldn't open", path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throwMapError("Couldn't get the size of", path);
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    // An empty file can't be mapped; leave it as an empty span.
+    if (m_size > 0) {
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            CloseHandle(file);
+            throwMapError("Couldn't map", path);
+        }
+        m_data = static_cast<const uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data) {
+            CloseHandle(m_mapping);
+            CloseHandle(file);
+            throwMapError("Couldn't map", path);
+        }
+    }
+    CloseHandle(file);
+}
+
+void MappedFile::unmap()
+{
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_size = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) : m_path(path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throwMapError("Couldn't open", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throwMapError("Couldn't get the size of", path);
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+
+    // An empty file can't be mapped; leave it as an empty span.
+    if (m_size > 0) {
+        void *addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            m_size = 0;
+            throwMapError("Couldn't map", path);
+        }
+        // The parser reads front to back
+        ::madvise(addr, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t *>(addr);
+    }
+    ::close(fd);
+}
+
+void MappedFile::unmap()
+{
+    if (m_data) {
+        ::munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_path(std::move(other.m_path)), m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+      ,
+      m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        m_path = std::move(other.m_path);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+} // namespace jpi_edm
@@ -0,0 +1,54 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Read-only memory mapping of an EDM file.
+ *
+ * EDM files are small enough to map whole, and once they're mapped the
+ * parser can read headers and records straight out of the page cache by
+ * offset, with no istream state to check and nothing copied. Use
+ * FlightFile::open() to get one.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jpi_edm {
+
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+
+    /**
+     * Maps the whole file read-only.
+     *
+     * @throws std::runtime_error if the file can't be opened or mapped
+     */
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    [[nodiscard]] const uint8_t *data() const { return m_data; }
+    [[nodiscard]] std::size_t size() const { return m_size; }
+    [[nodiscard]] const std::string &path() const { return m_path; }
+
+  private:
+    void unmap();
+
+    std::string m_path;
+    const uint8_t *m_data{nullptr};
+    std::size_t m_size{0};
+#ifdef _WIN32
+    void *m_mapping{nullptr};
+#endif
+};
+
+} // namespace jpi_edm
@@ -40,6 +40,8 @@ EDMVersion Metadata::ProtoVersion() const
 
 bool Metadata::IsOldRecFormat() const { return (ProtoVersion() == EDMVersion::V1 || ProtoVersion() == EDMVersion::V2); }
 
+int Metadata::RecordMaskSize() const { return IsOldRecFormat() ? OLD_RECORD_MASK_SIZE : RECORD_MASK_SIZE; }
+
 HeaderVersion Metadata::GuessFlightHeaderVersion() const
 {
     if (m_protoHeader.value > PROTO_HEADER_THRESHOLD || m_configInfo.edm_model >= EDM_MODEL_SINGLE_THRESHOLD) {
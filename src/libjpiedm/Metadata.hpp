@@ -44,6 +44,8 @@ class Metadata
     [[nodiscard]] int NumCylinders() const;
     [[nodiscard]] EDMVersion ProtoVersion() const;
     [[nodiscard]] bool IsOldRecFormat() const;
+    /// How wide the population bitmaps in the data records are
+    [[nodiscard]] int RecordMaskSize() const;
     [[nodiscard]] HeaderVersion GuessFlightHeaderVersion() const;
 
   public:
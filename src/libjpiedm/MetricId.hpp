@@ -131,4 +131,7 @@ enum MetricId {
     DIF2, // temp diff between hottest and coldest EGT, engine 2
 };
 
+/// Number of MetricIds. Keep in step with the last entry above.
+constexpr int METRIC_ID_COUNT = DIF2 + 1;
+
 } // namespace jpi_edm
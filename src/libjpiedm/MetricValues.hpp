@@ -0,0 +1,246 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Dense, MetricId-indexed containers for per-record metric data.
+ *
+ * A FlightMetricsRecord is created for every data record in a file, and it
+ * used to carry a std::map and two std::sets - a heap allocation per metric.
+ * These replacements are flat: a fixed array of values plus a presence
+ * bitset, so copying a record is a memcpy.
+ *
+ * They keep the parts of the std::map/std::set interface that callers
+ * actually use (operator[], find, count, size, iteration in MetricId order),
+ * so code like `rec->m_metrics.find(EGT11)->second` keeps working. Code that
+ * really needs the node-based containers can use toMap()/toSet().
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "MetricId.hpp"
+
+namespace jpi_edm {
+
+/**
+ * A set of MetricIds, stored as a bitset.
+ */
+class MetricSet
+{
+  public:
+    using Bits = std::bitset<METRIC_ID_COUNT>;
+
+    class const_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MetricId;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const MetricId *;
+        using reference = MetricId;
+
+        const_iterator() = default;
+        const_iterator(const Bits *bits, int idx) : m_bits(bits), m_idx(idx) { skipAbsent(); }
+
+        reference operator*() const { return static_cast<MetricId>(m_idx); }
+        const_iterator &operator++()
+        {
+            ++m_idx;
+            skipAbsent();
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+        bool operator==(const const_iterator &other) const { return m_idx == other.m_idx; }
+        bool operator!=(const const_iterator &other) const { return m_idx != other.m_idx; }
+
+      private:
+        void skipAbsent()
+        {
+            while (m_idx < METRIC_ID_COUNT && !m_bits->test(m_idx)) {
+                ++m_idx;
+            }
+        }
+
+        const Bits *m_bits{nullptr};
+        int m_idx{METRIC_ID_COUNT};
+    };
+    using iterator = const_iterator;
+
+    MetricSet() = default;
+    explicit MetricSet(const std::set<MetricId> &ids)
+    {
+        for (auto id : ids) {
+            insert(id);
+        }
+    }
+
+    void insert(MetricId id) { m_bits.set(id); }
+    void erase(MetricId id) { m_bits.reset(id); }
+    void clear() { m_bits.reset(); }
+
+    [[nodiscard]] bool contains(MetricId id) const { return m_bits.test(id); }
+    [[nodiscard]] std::size_t count(MetricId id) const { return contains(id) ? 1 : 0; }
+    [[nodiscard]] std::size_t size() const { return m_bits.count(); }
+    [[nodiscard]] bool empty() const { return m_bits.none(); }
+
+    [[nodiscard]] const_iterator begin() const { return const_iterator(&m_bits, 0); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(&m_bits, METRIC_ID_COUNT); }
+
+    [[nodiscard]] const Bits &bits() const { return m_bits; }
+
+    /// Compatibility accessor for code that wants the old std::set.
+    [[nodiscard]] std::set<MetricId> toSet() const { return std::set<MetricId>(begin(), end()); }
+
+    bool operator==(const MetricSet &other) const { return m_bits == other.m_bits; }
+    bool operator!=(const MetricSet &other) const { return m_bits != other.m_bits; }
+
+  private:
+    Bits m_bits;
+};
+
+/**
+ * A MetricId -> float map, stored as a flat array plus a presence bitset.
+ *
+ * Like std::map, operator[] on a missing id adds it with a value of 0, and
+ * iteration visits the present ids in increasing MetricId order, yielding
+ * (MetricId, value) pairs.
+ */
+class MetricValues
+{
+  public:
+    using key_type = MetricId;
+    using mapped_type = float;
+    using value_type = std::pair<MetricId, float>;
+
+    class const_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MetricValues::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        const_iterator() = default;
+        const_iterator(const MetricValues *values, int idx) : m_values(values), m_idx(idx) { load(); }
+
+        reference operator*() const { return m_current; }
+        pointer operator->() const { return &m_current; }
+        const_iterator &operator++()
+        {
+            ++m_idx;
+            load();
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+        bool operator==(const const_iterator &other) const { return m_idx == other.m_idx; }
+        bool operator!=(const const_iterator &other) const { return m_idx != other.m_idx; }
+
+      private:
+        // Move to the next present id at or after m_idx and cache its pair
+        void load()
+        {
+            while (m_idx < METRIC_ID_COUNT && !m_values->m_present.contains(static_cast<MetricId>(m_idx))) {
+                ++m_idx;
+            }
+            if (m_idx < METRIC_ID_COUNT) {
+                m_current = value_type{static_cast<MetricId>(m_idx), m_values->m_values[m_idx]};
+            }
+        }
+
+        const MetricValues *m_values{nullptr};
+        int m_idx{METRIC_ID_COUNT};
+        value_type m_current{};
+    };
+    using iterator = const_iterator;
+
+    MetricValues() = default;
+    explicit MetricValues(const std::map<MetricId, float> &metrics)
+    {
+        for (const auto &[id, value] : metrics) {
+            (*this)[id] = value;
+        }
+    }
+
+    float &operator[](MetricId id)
+    {
+        if (!m_present.contains(id)) {
+            m_present.insert(id);
+            m_values[id] = 0.0f;
+        }
+        return m_values[id];
+    }
+
+    /// Throws std::out_of_range if the id isn't present.
+    [[nodiscard]] float at(MetricId id) const
+    {
+        if (!m_present.contains(id)) {
+            throw std::out_of_range("MetricValues::at: metric not present");
+        }
+        return m_values[id];
+    }
+
+    [[nodiscard]] float get(MetricId id, float defaultValue) const
+    {
+        return m_present.contains(id) ? m_values[id] : defaultValue;
+    }
+
+    void erase(MetricId id) { m_present.erase(id); }
+    void clear() { m_present.clear(); }
+
+    [[nodiscard]] const_iterator find(MetricId id) const
+    {
+        return m_present.contains(id) ? const_iterator(this, id) : end();
+    }
+    [[nodiscard]] bool contains(MetricId id) const { return m_present.contains(id); }
+    [[nodiscard]] std::size_t count(MetricId id) const { return m_present.count(id); }
+    [[nodiscard]] std::size_t size() const { return m_present.size(); }
+    [[nodiscard]] bool empty() const { return m_present.empty(); }
+
+    [[nodiscard]] const_iterator begin() const { return const_iterator(this, 0); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(this, METRIC_ID_COUNT); }
+
+    /// The ids that have values
+    [[nodiscard]] const MetricSet &ids() const { return m_present; }
+
+    /// Compatibility accessor for code that wants the old std::map.
+    [[nodiscard]] std::map<MetricId, float> toMap() const { return std::map<MetricId, float>(begin(), end()); }
+
+    bool operator==(const MetricValues &other) const
+    {
+        if (m_present != other.m_present) {
+            return false;
+        }
+        for (const auto &[id, value] : *this) {
+            if (other.m_values[id] != value) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const MetricValues &other) const { return !(*this == other); }
+
+  private:
+    std::array<float, METRIC_ID_COUNT> m_values{};
+    MetricSet m_present;
+};
+
+} // namespace jpi_edm
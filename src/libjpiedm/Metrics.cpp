@@ -25,36 +25,145 @@
  *  limitations under the License.
  */
 
+#include <array>
 #include <iostream>
 #include <map>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 
 #include "Metadata.hpp"
 #include "MetricId.hpp"
 #include "Metrics.hpp"
+#include "ProtocolConstants.hpp"
 
 // #define DEBUG_METRICS 1
 
 namespace jpi_edm {
 
+namespace {
+
+// Number of EDMVersion values; each one is a single bit
+constexpr std::size_t EDM_VERSION_COUNT = 5;
+
+// Turns an EDMVersion into an index for the per-version caches
+std::size_t versionSlot(EDMVersion edmversion)
+{
+    switch (edmversion) {
+    case V1:
+        return 0;
+    case V2:
+        return 1;
+    case V3:
+        return 2;
+    case V4:
+        return 3;
+    case V5:
+        return 4;
+    }
+    std::stringstream msg;
+    msg << "Unknown EDM protocol version " << static_cast<int>(edmversion);
+    throw std::runtime_error(msg.str());
+}
+
+} // namespace
+
 // Maps low-byte bit indexes to Metric entries.
 // Only the low byte indexes are mapped.
-std::map<int, Metric> Metrics::getBitToMetricMap(const EDMVersion &edmversion)
+const std::map<int, Metric> &Metrics::getBitToMetricMap(const EDMVersion &edmversion)
 {
-    std::map<int, Metric> result;
-
-    for (const auto &metric : m_metrics) {
-        if ((metric.getVersionMask() & edmversion) > 0) {
+    static const auto maps = [] {
+        std::array<std::map<int, Metric>, EDM_VERSION_COUNT> result;
+        for (std::size_t slot = 0; slot < EDM_VERSION_COUNT; ++slot) {
+            int versionBit = 1 << slot;
+            for (const auto &metric : m_metrics) {
+                if ((metric.getVersionMask() & versionBit) > 0) {
 #if DEBUG_METRICS
-            if (result.count(metric.getLowByteBitIdx()) > 0) {
-                std::cout << "Duplicate metric entry for " << metric.getLowByteBitIdx() << std::endl;
-            }
+                    if (result[slot].count(metric.getLowByteBitIdx()) > 0) {
+                        std::cout << "Duplicate metric entry for " << metric.getLowByteBitIdx() << std::endl;
+                    }
 #endif
-            result.emplace(metric.getLowByteBitIdx(), metric);
+                    result[slot].emplace(metric.getLowByteBitIdx(), metric);
+                }
+            }
         }
-    }
+        return result;
+    }();
 
-    return result;
+    return maps[versionSlot(edmversion)];
+}
+
+const MetricDecodeTable &Metrics::getDecodeTable(const EDMVersion &edmversion)
+{
+    static const auto tables = [] {
+        std::array<MetricDecodeTable, EDM_VERSION_COUNT> result{};
+        for (std::size_t slot = 0; slot < EDM_VERSION_COUNT; ++slot) {
+            auto version = static_cast<EDMVersion>(1 << slot);
+            for (const auto &[bitIdx, metric] : getBitToMetricMap(version)) {
+                if (bitIdx < 0 || bitIdx >= MAX_METRIC_FIELDS) {
+                    continue;
+                }
+                auto &entry = result[slot][bitIdx];
+                entry.isValid = true;
+                entry.metricId = metric.getMetricId();
+                entry.isGps = (entry.metricId == LAT || entry.metricId == LNG);
+                entry.isSecondEngine = isSecondEngineMetric(entry.metricId);
+                entry.highByteBitIdx = static_cast<int8_t>(metric.getHighByteBitIdx().value_or(-1));
+
+                auto divisor = static_cast<float>(METRIC_SCALE_DIVISOR);
+                auto scale = metric.getScaleFactor();
+                entry.scaleDivisor[0] = (scale == Metric::ScaleFactor::TEN) ? divisor : 1.0f;
+                entry.scaleDivisor[1] = (scale == Metric::ScaleFactor::NONE) ? 1.0f : divisor;
+            }
+        }
+        return result;
+    }();
+
+    return tables[versionSlot(edmversion)];
+}
+
+bool Metrics::isSecondEngineMetric(MetricId metricId)
+{
+    switch (metricId) {
+    case EGT21:
+    case EGT22:
+    case EGT23:
+    case EGT24:
+    case EGT25:
+    case EGT26:
+    case EGT27:
+    case EGT28:
+    case EGT29:
+    case CHT21:
+    case CHT22:
+    case CHT23:
+    case CHT24:
+    case CHT25:
+    case CHT26:
+    case CHT27:
+    case CHT28:
+    case CHT29:
+    case CLD2:
+    case TIT21:
+    case TIT22:
+    case OILT2:
+    case OILP2:
+    case CRB2:
+    case IAT2:
+    case MAP2:
+    case FF21:
+    case FF22:
+    case FUSD21:
+    case FUSD22:
+    case FP2:
+    case HP2:
+    case RPM2:
+    case HRS2:
+    case TORQ2:
+        return true;
+    default:
+        return false;
+    }
 }
 
 #define IDSTR(x) x, #x
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -35,6 +36,7 @@
 
 #include "Metadata.hpp"
 #include "MetricId.hpp"
+#include "ProtocolConstants.hpp"
 
 namespace jpi_edm {
 
@@ -84,10 +86,42 @@ class Metric
     float m_initialValue;
 };
 
+/**
+ * One slot of a MetricDecodeTable: everything Flight::updateMetrics needs to
+ * know about a record field, flattened out of the Metric so that decoding a
+ * value is an array index rather than a map lookup.
+ *
+ * Only low-byte bit indexes are valid; high bytes are picked up through the
+ * highByteBitIdx of their low byte.
+ */
+struct MetricDecodeEntry {
+    bool isValid{false};
+    bool isGps{false};          // LAT/LNG, which need the baseline handshake
+    bool isSecondEngine{false}; // seeing one of these means it's a twin
+    int8_t highByteBitIdx{-1};  // -1 if the value is a single byte
+    MetricId metricId{};
+    float scaleDivisor[2]{1.0f, 1.0f}; // indexed by Metadata::IsGPH()
+};
+
+using MetricDecodeTable = std::array<MetricDecodeEntry, MAX_METRIC_FIELDS>;
+
 class Metrics
 {
   public:
-    static std::map<int, Metric> getBitToMetricMap(const EDMVersion &edmversion);
+    /**
+     * The bit index -> Metric map for a protocol version. It's built the first
+     * time a version is asked for and shared from then on.
+     */
+    static const std::map<int, Metric> &getBitToMetricMap(const EDMVersion &edmversion);
+
+    /**
+     * The flat decode table for a protocol version, indexed by bit index.
+     * Built once per version alongside getBitToMetricMap(), and shared by
+     * every Flight.
+     */
+    static const MetricDecodeTable &getDecodeTable(const EDMVersion &edmversion);
+
+    [[nodiscard]] static bool isSecondEngineMetric(MetricId metricId);
 
   private:
     static const std::vector<Metric> m_metrics;
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <climits>
+#include <cstddef>
 #include <cstdint>
 
 namespace jpi_edm {
@@ -28,6 +29,15 @@ constexpr int HEADER_BUFFER_SIZE = 1024;
 /// Maximum number of metric fields supported in a data record
 constexpr int MAX_METRIC_FIELDS = 128;
 
+/// Largest flight, in 16-bit words, that a $D record may give
+constexpr long MAX_FLIGHT_DATA_WORDS = 1000000;
+
+/// Chunk size used when buffering reads from a std::istream
+constexpr std::size_t STREAM_READ_CHUNK_SIZE = 64 * 1024;
+
+/// Records between the decoder state snapshots FlightView::buildCheckpoints() takes by default
+constexpr std::size_t DEFAULT_CHECKPOINT_INTERVAL = 256;
+
 // ============================================================================
 // EDM Model Identification
 // ============================================================================
@@ -176,6 +186,17 @@ constexpr int BITS_PER_BYTE = 8;
 /// Byte mask for extracting single byte (0xFF)
 constexpr uint8_t BYTE_MASK = 0xFF;
 
+/// Size in bytes of each population bitmap in a (new format) data record
+constexpr int RECORD_MASK_SIZE = 2;
+
+/// Size in bytes of each population bitmap in an old format (V1 and V2) data record
+constexpr int OLD_RECORD_MASK_SIZE = 1;
+
+/// Largest possible data record: two population bitmaps, the repeat count,
+/// full field and sign maps, one byte per metric field, and the checksum
+constexpr int MAX_DATA_RECORD_SIZE =
+    RECORD_MASK_SIZE * 2 + 1 + 2 * (MAX_METRIC_FIELDS / BITS_PER_BYTE) + MAX_METRIC_FIELDS + 1;
+
 // ============================================================================
 // Metric Scaling
 // ============================================================================
@@ -199,6 +220,9 @@ constexpr int GPS_MINUTES_DECIMAL_DIVISOR = 100;
 // Mark Indicators (Special Event Markers)
 // ============================================================================
 
+/// Record field (bit index) that carries the mark codes below
+constexpr int MARK_IDX = 16;
+
 /// Mark code indicating start of marked region
 constexpr uint8_t MARK_START = 0x02;
 
@@ -215,6 +239,9 @@ constexpr uint8_t MARK_UNKNOWN = 0x04;
 /// Cylinder count for typical 4-cylinder single engine
 constexpr int SINGLE_ENGINE_CYLINDER_COUNT = 4;
 
+/// Most cylinders per engine that have EGT/CHT metrics (EGTx1 - EGTx9)
+constexpr int MAX_CYLINDERS_PER_ENGINE = 9;
+
 // ============================================================================
 // Time Calculation Constants
 // ============================================================================
@@ -0,0 +1,205 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Decoding and framing of binary data records.
+ */
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+#include "BitOps.hpp"
+#include "ByteReader.hpp"
+#include "RecordDecoder.hpp"
+
+namespace jpi_edm {
+
+namespace {
+
+// The EGT high bytes don't have sign bytes; they use the signs of their low bytes
+constexpr unsigned UNSIGNED_FIELD_BYTES = (1U << EGT_HIGHBYTE_IDX_1) | (1U << EGT_HIGHBYTE_IDX_2);
+
+// Each 64 bit word of a field or sign map holds 8 map bytes
+constexpr int FIELDS_PER_WORD = 64;
+
+// Sizes that follow from the width of the population map
+template <int MaskSize> struct RecordLayout {
+    static_assert(MaskSize == OLD_RECORD_MASK_SIZE || MaskSize == RECORD_MASK_SIZE,
+                  "population maps are one or two bytes wide");
+
+    static constexpr std::size_t popMapBytes = MaskSize * 2; // both copies
+    static constexpr int fieldWords = MaskSize * BITS_PER_BYTE * BITS_PER_BYTE / FIELDS_PER_WORD;
+};
+
+// The first copy of the population map; two-byte maps are big-endian
+template <int MaskSize> unsigned readPopMap(const uint8_t *bytes)
+{
+    if constexpr (MaskSize == 1) {
+        return bytes[0];
+    } else {
+        return (static_cast<unsigned>(bytes[0]) << 8) | bytes[1];
+    }
+}
+
+std::size_t countBits(unsigned bits) { return static_cast<std::size_t>(popCount(bits)); }
+
+} // namespace
+
+template <int MaskSize> std::optional<RecordFrame> frameRecord(const uint8_t *data, std::size_t size)
+{
+    using Layout = RecordLayout<MaskSize>;
+    if (size < Layout::popMapBytes + 1) {
+        return std::nullopt;
+    }
+    const unsigned popMap = readPopMap<MaskSize>(data);
+
+    // field map bytes first, then a sign byte for each of them except the EGT high bytes
+    const std::size_t fieldBytes = countBits(popMap);
+    const std::size_t signBytes = fieldBytes - countBits(popMap & UNSIGNED_FIELD_BYTES);
+    const std::size_t fieldMapStart = Layout::popMapBytes + 1;
+    const std::size_t signMapStart = fieldMapStart + fieldBytes;
+    const std::size_t valuesStart = signMapStart + signBytes;
+    if (valuesStart > size) {
+        return std::nullopt;
+    }
+
+    // One value byte per bit set in the field maps
+    std::size_t valueBytes = 0;
+    for (std::size_t i = 0; i < fieldBytes; ++i) {
+        valueBytes += countBits(data[fieldMapStart + i]);
+    }
+
+    RecordFrame frame;
+    frame.length = valuesStart + valueBytes + 1; // and the checksum
+    if (frame.length > size) {
+        return std::nullopt;
+    }
+
+    // The mark, if there is one, says whether the recorder switched to or from fast mode
+    constexpr int markByte = MARK_IDX / BITS_PER_BYTE;
+    constexpr int markBit = MARK_IDX % BITS_PER_BYTE;
+    if (popMap & (1U << markByte)) {
+        const unsigned lowerBytes = popMap & ((1U << markByte) - 1);
+        const std::size_t markFieldIdx = countBits(lowerBytes);
+        const uint8_t fields = data[fieldMapStart + markFieldIdx];
+        if (fields & (1 << markBit)) {
+            // values are in field order, so the mark's value follows all the lower fields'
+            std::size_t markPos = valuesStart + countBits(fields & ((1U << markBit) - 1));
+            for (std::size_t i = 0; i < markFieldIdx; ++i) {
+                markPos += countBits(data[fieldMapStart + i]);
+            }
+            int mark = data[markPos];
+            const std::size_t markSignIdx = markFieldIdx - countBits(lowerBytes & UNSIGNED_FIELD_BYTES);
+            bool hasSign = (UNSIGNED_FIELD_BYTES & (1U << markByte)) == 0;
+            bool isNegative = hasSign && (data[signMapStart + markSignIdx] & (1 << markBit));
+            frame.mark = isNegative ? -mark : mark;
+        }
+    }
+    return frame;
+}
+
+template <int MaskSize>
+DecodedRecord decodeRecord(const uint8_t *data, std::size_t size, unsigned long recordSeq, RecordDeltas &values)
+{
+    using Layout = RecordLayout<MaskSize>;
+    ByteReader reader(data, size);
+    DecodedRecord result;
+
+    // A pair of population maps, which should be identical. They say which
+    // bytes of the field map are present. Compare byte-by-byte to avoid
+    // endianness issues.
+    if (!reader.has(Layout::popMapBytes + 1)) {
+        std::stringstream msg;
+        msg << "Failed to read bmPopMap in flight data record " << recordSeq;
+        throw std::runtime_error(msg.str());
+    }
+    const uint8_t *popMapBytes = reader.read(Layout::popMapBytes);
+    result.popMapsMatch = std::equal(popMapBytes, popMapBytes + MaskSize, popMapBytes + MaskSize);
+    const unsigned popMap = readPopMap<MaskSize>(popMapBytes);
+
+    (void)reader.readU8(); // repeat count
+
+    // The field map says which measurements are present, and the sign map
+    // whether each one is added to or subtracted from the previous value.
+    // Both are gathered into 64 bit words, one per 8 map bytes, with field
+    // i at bit i % 64 of word i / 64.
+    const unsigned signedBytes = popMap & ~UNSIGNED_FIELD_BYTES;
+    const auto fieldMapBytes = static_cast<std::size_t>(popCount(popMap));
+    const auto signMapBytes = static_cast<std::size_t>(popCount(signedBytes));
+    if (!reader.has(fieldMapBytes + signMapBytes)) {
+        std::stringstream msg;
+        msg << "Failed to read " << (reader.has(fieldMapBytes) ? "sign" : "field") << " map in flight data record "
+            << recordSeq;
+        throw std::runtime_error(msg.str());
+    }
+    std::array<uint64_t, Layout::fieldWords> fieldWords{};
+    std::array<uint64_t, Layout::fieldWords> signWords{};
+    const uint8_t *mapBytes = reader.read(fieldMapBytes);
+    forEachSetBit(popMap, [&fieldWords, &mapBytes](int byteIdx) {
+        fieldWords[byteIdx / BITS_PER_BYTE] |= static_cast<uint64_t>(*mapBytes++)
+                                               << (byteIdx % BITS_PER_BYTE * BITS_PER_BYTE);
+    });
+    mapBytes = reader.read(signMapBytes);
+    forEachSetBit(signedBytes, [&signWords, &mapBytes](int byteIdx) {
+        signWords[byteIdx / BITS_PER_BYTE] |= static_cast<uint64_t>(*mapBytes++)
+                                              << (byteIdx % BITS_PER_BYTE * BITS_PER_BYTE);
+    });
+
+    // One value byte per field, in field order, then the checksum
+    std::size_t valueCount = 0;
+    for (uint64_t word : fieldWords) {
+        valueCount += static_cast<std::size_t>(popCount(word));
+    }
+    if (!reader.has(valueCount + 1)) {
+        std::stringstream msg;
+        msg << "Failed to read " << (reader.has(valueCount) ? "checksum" : "metric values")
+            << " from flight data record " << recordSeq;
+        throw std::runtime_error(msg.str());
+    }
+    const uint8_t *valueBytes = reader.read(valueCount);
+    values.clear();
+    for (int w = 0; w < Layout::fieldWords; ++w) {
+        const uint64_t signs = signWords[w];
+        const int firstField = w * FIELDS_PER_WORD;
+        forEachSetBit(fieldWords[w], [&values, &valueBytes, signs, firstField](int bitIdx) {
+            int val = *valueBytes++;
+            values.set(firstField + bitIdx, ((signs >> bitIdx) & 1) ? -val : val);
+        });
+    }
+
+    // The checksum covers everything before it
+    const std::size_t checksummed = reader.position();
+    BinaryChecksum checksum;
+    checksum.add(data, checksummed);
+    result.checksumOk = checksum.matches(reader.readU8());
+    result.length = reader.position();
+    return result;
+}
+
+template std::optional<RecordFrame> frameRecord<OLD_RECORD_MASK_SIZE>(const uint8_t *data, std::size_t size);
+template std::optional<RecordFrame> frameRecord<RECORD_MASK_SIZE>(const uint8_t *data, std::size_t size);
+template DecodedRecord decodeRecord<OLD_RECORD_MASK_SIZE>(const uint8_t *data, std::size_t size,
+                                                          unsigned long recordSeq, RecordDeltas &values);
+template DecodedRecord decodeRecord<RECORD_MASK_SIZE>(const uint8_t *data, std::size_t size, unsigned long recordSeq,
+                                                      RecordDeltas &values);
+
+const RecordCodec &recordCodec(int maskSize)
+{
+    static constexpr RecordCodec OLD_CODEC{OLD_RECORD_MASK_SIZE, &decodeRecord<OLD_RECORD_MASK_SIZE>,
+                                           &frameRecord<OLD_RECORD_MASK_SIZE>};
+    static constexpr RecordCodec NEW_CODEC{RECORD_MASK_SIZE, &decodeRecord<RECORD_MASK_SIZE>,
+                                           &frameRecord<RECORD_MASK_SIZE>};
+    switch (maskSize) {
+    case OLD_RECORD_MASK_SIZE:
+        return OLD_CODEC;
+    case RECORD_MASK_SIZE:
+        return NEW_CODEC;
+    }
+    std::stringstream msg;
+    msg << "Data records can't have " << maskSize << " byte population maps";
+    throw std::runtime_error(msg.str());
+}
+
+} // namespace jpi_edm
@@ -0,0 +1,76 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Decoding and framing of binary data records, compiled separately
+ * for each width of population map.
+ *
+ * A data record starts with two copies of a population map saying which
+ * field map bytes follow. Old (V1 and V2) recorders write one-byte maps,
+ * so their records can only carry field bytes 0-7; later ones write
+ * two-byte maps covering all 16. Each layout gets its own instantiation of
+ * the decoder, with the map sizes as constants. A Flight picks its
+ * RecordCodec once, from its protocol version, and every record goes
+ * through that.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "ProtocolConstants.hpp"
+#include "RecordDeltas.hpp"
+
+namespace jpi_edm {
+
+/// What the framing of a data record says about it, without decoding it
+struct RecordFrame {
+    std::size_t length{0};   ///< including the checksum byte
+    std::optional<int> mark; ///< the signed MARK_IDX value, if the record has one
+};
+
+/// What decodeRecord() found out about a record besides its values
+struct DecodedRecord {
+    std::size_t length{0};   ///< including the checksum byte
+    bool popMapsMatch{true}; ///< the two copies of the population map agreed (the first is used if not)
+    bool checksumOk{true};
+};
+
+/**
+ * Work out the length of the data record at the start of data from its
+ * population and field maps, without decoding any values other than the
+ * mark, which says whether the recorder switched to or from fast mode.
+ *
+ * @return nullopt if the record runs past the end of data
+ */
+template <int MaskSize>
+[[nodiscard]] std::optional<RecordFrame> frameRecord(const uint8_t *data, std::size_t size);
+
+/**
+ * Decode the signed field values of the data record at the start of data
+ * into values, which is cleared first.
+ *
+ * @param recordSeq Only used in error messages
+ * @throws std::runtime_error if the record runs past the end of data
+ */
+template <int MaskSize>
+DecodedRecord decodeRecord(const uint8_t *data, std::size_t size, unsigned long recordSeq, RecordDeltas &values);
+
+/// The decoder and framer for one record layout
+struct RecordCodec {
+    int maskSize;
+    DecodedRecord (*decode)(const uint8_t *data, std::size_t size, unsigned long recordSeq, RecordDeltas &values);
+    std::optional<RecordFrame> (*frame)(const uint8_t *data, std::size_t size);
+};
+
+/**
+ * The codec for records with population maps maskSize bytes wide, i.e.
+ * OLD_RECORD_MASK_SIZE or RECORD_MASK_SIZE (see Metadata::RecordMaskSize()).
+ *
+ * @throws std::runtime_error for any other size
+ */
+[[nodiscard]] const RecordCodec &recordCodec(int maskSize);
+
+} // namespace jpi_edm
@@ -0,0 +1,65 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief The raw, signed field values decoded from one data record.
+ *
+ * Every data record carries a delta for some subset of the (at most
+ * MAX_METRIC_FIELDS) fields. These are kept in a fixed array indexed by
+ * field (bit) index, plus a bitset saying which fields were present, so
+ * decoding a record never touches the heap.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <map>
+
+#include "ProtocolConstants.hpp"
+
+namespace jpi_edm {
+
+class RecordDeltas
+{
+  public:
+    using Bits = std::bitset<MAX_METRIC_FIELDS>;
+
+    RecordDeltas() = default;
+
+    /// Compatibility constructor; entries outside [0, MAX_METRIC_FIELDS) are ignored.
+    explicit RecordDeltas(const std::map<int, int> &values)
+    {
+        for (const auto &[fieldIdx, value] : values) {
+            if (fieldIdx >= 0 && fieldIdx < MAX_METRIC_FIELDS) {
+                set(fieldIdx, value);
+            }
+        }
+    }
+
+    void set(int fieldIdx, int value)
+    {
+        m_values[fieldIdx] = value;
+        m_present.set(fieldIdx);
+    }
+
+    void clear() { m_present.reset(); }
+
+    [[nodiscard]] bool contains(int fieldIdx) const { return m_present.test(fieldIdx); }
+
+    /// The delta for a field, or 0 if it wasn't in the record.
+    [[nodiscard]] int operator[](int fieldIdx) const { return m_present.test(fieldIdx) ? m_values[fieldIdx] : 0; }
+
+    [[nodiscard]] std::size_t size() const { return m_present.count(); }
+    [[nodiscard]] bool empty() const { return m_present.none(); }
+
+    /// Which fields were present in the record
+    [[nodiscard]] const Bits &present() const { return m_present; }
+
+  private:
+    std::array<int, MAX_METRIC_FIELDS> m_values{};
+    Bits m_present;
+};
+
+} // namespace jpi_edm
@@ -0,0 +1,35 @@
+/*
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ */
+
+#pragma once
+
+#include <istream>
+#include <optional>
+#include <ostream>
+
+#include "libjpiedm/CompressedInput.hpp"
+
+namespace parseedmlog::csv {
+
+/**
+ * Write every flight in the file, or just flightId, as CSV. With verbose,
+ * the file metadata and each flight's header come first. The file can be
+ * gzip or zstd compressed if every flight is wanted.
+ */
+void printFlightData(const jpi_edm::MappedFile &file, std::optional<int> flightId, std::ostream &outStream,
+                     bool verbose);
+
+/**
+ * Write every flight in a file read from inStream as CSV, printing each one
+ * as soon as it has arrived. inStream needn't be seekable, e.g. std::cin
+ * reading a pipe, and can be gzip or zstd compressed.
+ */
+void printFlightData(std::istream &inStream, std::ostream &outStream, bool verbose);
+
+/// Write every flight in a member of a zip archive as CSV, inflating it as it goes
+void printFlightData(const jpi_edm::ZipArchive &archive, const jpi_edm::ZipArchive::Entry &entry,
+                     std::ostream &outStream, bool verbose);
+
+} // namespace parseedmlog::csv
@@ -6,6 +6,7 @@
 #include "KmlExporter.hpp"
 
 #include "MetricUtils.hpp"
+#include "libjpiedm/CompressedInput.hpp"
 #include "libjpiedm/FlightFile.hpp"
 #include "libjpiedm/MetricId.hpp"
 #include "libjpiedm/ProtocolConstants.hpp"
@@ -111,22 +112,6 @@ bool endsWithIgnoreCase(const std::string &value, const std::string &suffix)
     return true;
 }
 
-uint32_t crc32(const std::string &data)
-{
-    uint32_t crc = 0xFFFFFFFF;
-    for (unsigned char ch : data) {
-        crc ^= ch;
-        for (int i = 0; i < 8; ++i) {
-            if (crc & 1U) {
-                crc = (crc >> 1U) ^ 0xEDB88320U;
-            } else {
-                crc >>= 1U;
-            }
-        }
-    }
-    return crc ^ 0xFFFFFFFFU;
-}
-
 void toDosDateTime(std::time_t t, uint16_t &dosDate, uint16_t &dosTime)
 {
     std::tm tmStruct;
@@ -169,7 +154,8 @@ std::vector<std::uint8_t> buildKmzArchive(const std::string &kmlContent, const s
     std::vector<std::uint8_t> buffer;
     buffer.reserve(kmlContent.size() + 256);
 
-    std::uint32_t crc = crc32(kmlContent);
+    std::uint32_t crc =
+        jpi_edm::crc32(reinterpret_cast<const std::uint8_t *>(kmlContent.data()), kmlContent.size());
     std::uint32_t size = static_cast<std::uint32_t>(kmlContent.size());
     std::time_t now = std::time(nullptr);
     uint16_t dosDate = 0;
@@ -230,15 +216,19 @@ std::vector<std::uint8_t> buildKmzArchive(const std::string &kmlContent, const s
 
 } // namespace
 
-std::optional<FlightTrackData> collectFlightTrackData(std::istream &stream, int flightId)
+std::optional<FlightTrackData> collectFlightTrackData(const jpi_edm::MappedFile &file, int flightId)
 {
-    stream.clear();
-    stream.seekg(0);
-
     jpi_edm::FlightFile ff;
     FlightTrackData trackData;
     std::time_t recordTime = 0;
 
+    // The track only needs the position, so don't decode anything else
+    jpi_edm::MetricSet trackMetrics;
+    for (auto id : {jpi_edm::LAT, jpi_edm::LNG, jpi_edm::ALT, jpi_edm::SPD}) {
+        trackMetrics.insert(id);
+    }
+    ff.setMetricSelection(trackMetrics);
+
     ff.setMetadataCompletionCb([&](std::shared_ptr<jpi_edm::Metadata>) {
         // Metadata is not currently used for KML export, but hook retained for future enhancements.
     });
@@ -280,7 +270,7 @@ std::optional<FlightTrackData> collectFlightTrackData(std::istream &stream, int
     });
 
     try {
-        ff.processFile(stream, flightId);
+        ff.processFile(file, flightId);
     } catch (const std::exception &ex) {
         std::cerr << "Failed to parse flight #" << flightId << " for KML export: " << ex.what() << "\n";
         return std::nullopt;
@@ -7,7 +7,6 @@
 
 #include <ctime>
 #include <filesystem>
-#include <istream>
 #include <optional>
 #include <string>
 #include <vector>
@@ -17,6 +16,7 @@
 namespace jpi_edm {
 class FlightHeader;
 class FlightMetricsRecord;
+class MappedFile;
 } // namespace jpi_edm
 
 namespace parseedmlog::kml {
@@ -34,7 +34,7 @@ struct FlightTrackData {
     std::vector<FlightTrackPoint> samples;
 };
 
-std::optional<FlightTrackData> collectFlightTrackData(std::istream &stream, int flightId);
+std::optional<FlightTrackData> collectFlightTrackData(const jpi_edm::MappedFile &file, int flightId);
 
 void writeKmlOrKmz(const std::filesystem::path &outputPath, const FlightTrackData &trackData,
                    const std::string &sourceName);
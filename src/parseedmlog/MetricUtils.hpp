@@ -5,13 +5,12 @@
 
 #pragma once
 
-#include <map>
-
 #include "libjpiedm/MetricId.hpp"
+#include "libjpiedm/MetricValues.hpp"
 
 namespace parseedmlog {
 
-inline float getMetric(const std::map<jpi_edm::MetricId, float> &metrics, jpi_edm::MetricId id,
+inline float getMetric(const jpi_edm::MetricValues &metrics, jpi_edm::MetricId id,
                        float defaultValue = 0.0f)
 {
     auto it = metrics.find(id);
@@ -0,0 +1,44 @@
+cmake_minimum_required(VERSION 3.15)
+
+# Converts every case in one parseedmlog run on several threads, and checks
+# that the output is each case's expected output, in the order given.
+
+foreach(var ROOTNAMES JOBS SOURCE_DIR BINARY_DIR PARSEEDMLOG_EXECUTABLE)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "${var} variable is required")
+    endif()
+endforeach()
+
+string(REPLACE "," ";" ROOTNAMES "${ROOTNAMES}")
+set(OUTPUT "${BINARY_DIR}/batch_j${JOBS}.out")
+set(EXPECTED "${BINARY_DIR}/batch_j${JOBS}.expected")
+
+set(INPUTS)
+file(WRITE "${EXPECTED}" "")
+foreach(rootname ${ROOTNAMES})
+    list(APPEND INPUTS "${SOURCE_DIR}/${rootname}.jpi")
+    file(READ "${SOURCE_DIR}/${rootname}.expected" expected_content)
+    file(APPEND "${EXPECTED}" "${expected_content}")
+endforeach()
+
+file(MAKE_DIRECTORY "${BINARY_DIR}")
+
+execute_process(
+    COMMAND "${PARSEEDMLOG_EXECUTABLE}" -v -j ${JOBS} -o "${OUTPUT}" ${INPUTS}
+    WORKING_DIRECTORY "${BINARY_DIR}"
+    RESULT_VARIABLE parse_result
+    OUTPUT_QUIET
+)
+
+if(NOT parse_result EQUAL 0)
+    message(FATAL_ERROR "parseedmlog -j ${JOBS} failed with exit code ${parse_result}")
+endif()
+
+execute_process(
+    COMMAND "${CMAKE_COMMAND}" -E compare_files "${OUTPUT}" "${EXPECTED}"
+    RESULT_VARIABLE cmp_result
+)
+
+if(NOT cmp_result EQUAL 0)
+    message(FATAL_ERROR "Output file ${OUTPUT} differs from the cases' expected output ${EXPECTED}")
+endif()
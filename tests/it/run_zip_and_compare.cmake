@@ -0,0 +1,59 @@
+cmake_minimum_required(VERSION 3.15)
+
+# Zips every case, with a file that isn't a .jpi among them, and checks that
+# parseedmlog prints each .jpi member's expected output, in archive order.
+
+foreach(var ROOTNAMES SOURCE_DIR BINARY_DIR PARSEEDMLOG_EXECUTABLE)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "${var} variable is required")
+    endif()
+endforeach()
+
+string(REPLACE "," ";" ROOTNAMES "${ROOTNAMES}")
+set(STAGING "${BINARY_DIR}/zip_staging")
+set(ARCHIVE "${BINARY_DIR}/cases.zip")
+set(OUTPUT "${BINARY_DIR}/zip.out")
+set(EXPECTED "${BINARY_DIR}/zip.expected")
+
+file(REMOVE_RECURSE "${STAGING}")
+file(MAKE_DIRECTORY "${STAGING}")
+file(WRITE "${STAGING}/notes.txt" "not a flight log\n")
+
+set(MEMBERS notes.txt)
+file(WRITE "${EXPECTED}" "")
+foreach(rootname ${ROOTNAMES})
+    file(COPY "${SOURCE_DIR}/${rootname}.jpi" DESTINATION "${STAGING}")
+    list(APPEND MEMBERS "${rootname}.jpi")
+    file(READ "${SOURCE_DIR}/${rootname}.expected" expected_content)
+    file(APPEND "${EXPECTED}" "${expected_content}")
+endforeach()
+
+execute_process(
+    COMMAND "${CMAKE_COMMAND}" -E tar cf "${ARCHIVE}" --format=zip ${MEMBERS}
+    WORKING_DIRECTORY "${STAGING}"
+    RESULT_VARIABLE zip_result
+)
+
+if(NOT zip_result EQUAL 0)
+    message(FATAL_ERROR "Couldn't write ${ARCHIVE}")
+endif()
+
+execute_process(
+    COMMAND "${PARSEEDMLOG_EXECUTABLE}" -v -o "${OUTPUT}" "${ARCHIVE}"
+    WORKING_DIRECTORY "${BINARY_DIR}"
+    RESULT_VARIABLE parse_result
+    OUTPUT_QUIET
+)
+
+if(NOT parse_result EQUAL 0)
+    message(FATAL_ERROR "parseedmlog failed for ${ARCHIVE} with exit code ${parse_result}")
+endif()
+
+execute_process(
+    COMMAND "${CMAKE_COMMAND}" -E compare_files "${OUTPUT}" "${EXPECTED}"
+    RESULT_VARIABLE cmp_result
+)
+
+if(NOT cmp_result EQUAL 0)
+    message(FATAL_ERROR "Output file ${OUTPUT} differs from the cases' expected output ${EXPECTED}")
+endif()
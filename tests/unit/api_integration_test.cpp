@@ -9,46 +9,14 @@
 
 #include "FlightFile.hpp"
 #include "FlightIterator.hpp"
+#include "test_helpers.hpp"
 
 #include <fstream>
 #include <map>
 #include <vector>
 
 using namespace jpi_edm;
-
-namespace {
-
-// Helper to find test files in tests/it directory
-std::string findTestFile(const std::string& filename)
-{
-    // Try multiple possible paths (for different working directories)
-    std::vector<std::string> possiblePaths = {
-        filename, // Current directory
-        "tests/it/" + filename,
-        "../tests/it/" + filename,
-        "../../tests/it/" + filename,
-        "../../../tests/it/" + filename,
-        "../../../../tests/it/" + filename,
-    };
-
-    for (const auto& path : possiblePaths) {
-        std::ifstream testFile(path, std::ios::binary);
-        if (testFile.good()) {
-            return path;
-        }
-    }
-    return "";
-}
-
-// Test files to process
-const std::vector<std::string> TEST_FILES = {
-    "830_6cyl.jpi",
-    "930_6cyl.jpi",
-    "930_6cyl_turbo.jpi",
-    "960_4cyl_twin.jpi",
-};
-
-} // anonymous namespace
+using namespace jpi_edm::test;
 
 class ApiIntegrationTest : public ::testing::Test
 {
@@ -218,6 +186,77 @@ TEST_F(ApiIntegrationTest, CallbackAPI_RecordsContainValidMetrics)
     }
 }
 
+TEST_F(ApiIntegrationTest, CallbackAPI_RecordViewsMatchRecords)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        std::vector<FlightMetricsRecord> viewed;
+        std::vector<std::shared_ptr<FlightMetricsRecord>> records;
+
+        parser.setFlightRecordViewCb([&viewed, &records](const FlightRecordView& view) {
+            // The view fires first, before the copy for the other callback is made
+            EXPECT_EQ(viewed.size(), records.size());
+            viewed.push_back(view.toRecord());
+        });
+        parser.setFlightRecordCompletionCb([&records](std::shared_ptr<FlightMetricsRecord> rec) {
+            records.push_back(rec);
+        });
+
+        std::ifstream stream(filepath, std::ios::binary);
+        ASSERT_TRUE(stream.is_open());
+        parser.processFile(stream);
+
+        ASSERT_FALSE(records.empty());
+        ASSERT_EQ(viewed.size(), records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            EXPECT_EQ(viewed[i].m_isFast, records[i]->m_isFast);
+            EXPECT_EQ(viewed[i].m_recordSeq, records[i]->m_recordSeq);
+            EXPECT_EQ(viewed[i].m_metrics, records[i]->m_metrics) << "Record " << i;
+            EXPECT_EQ(viewed[i].m_updatedMetrics, records[i]->m_updatedMetrics) << "Record " << i;
+            EXPECT_EQ(viewed[i].m_supportedMetrics, records[i]->m_supportedMetrics);
+        }
+    }
+}
+
+TEST_F(ApiIntegrationTest, CallbackAPI_RecordViewsOnlyForRequestedFlight)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile detectParser;
+        std::ifstream detectStream(filepath, std::ios::binary);
+        auto flights = detectParser.detectFlights(detectStream);
+        if (flights.size() < 2) {
+            continue;
+        }
+        int flightNumber = flights.back().flightNumber;
+
+        FlightFile parser;
+        size_t views = 0;
+        unsigned long totalRecords = 0;
+        parser.setFlightRecordViewCb([&views](const FlightRecordView& view) {
+            EXPECT_GT(view.metrics().size(), 0u);
+            ++views;
+        });
+        parser.setFlightCompletionCb(
+            [&totalRecords](unsigned long stdRecs, unsigned long fastRecs) { totalRecords = stdRecs + fastRecs; });
+
+        std::ifstream stream(filepath, std::ios::binary);
+        parser.processFile(stream, flightNumber);
+        EXPECT_EQ(views, totalRecords);
+    }
+}
+
 // =============================================================================
 // Iterator API Tests
 // =============================================================================
@@ -296,6 +335,297 @@ TEST_F(ApiIntegrationTest, IteratorAPI_CanIterateRecordsInFlight)
     }
 }
 
+TEST_F(ApiIntegrationTest, IteratorAPI_ReusesRecordsNobodyHolds)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        std::ifstream stream(filepath, std::ios::binary);
+        auto range = parser.flights(stream);
+        ASSERT_FALSE(range.empty());
+        auto flight = range.at(0);
+        ASSERT_GT(flight.getTotalRecordCount(), 3u);
+
+        // Nothing holds on to the records, so they all share one buffer
+        const FlightMetricsRecord* buffer = nullptr;
+        for (const auto& record : flight) {
+            if (!buffer) {
+                buffer = record.get();
+            }
+            EXPECT_EQ(buffer, record.get()) << "Record " << record->m_recordSeq;
+        }
+
+        // A record someone kept isn't overwritten by the ones after it
+        auto it = flight.begin();
+        std::shared_ptr<FlightMetricsRecord> first = *it;
+        FlightMetricsRecord firstCopy = *first;
+        ++it;
+        ++it;
+        EXPECT_NE(first.get(), it->get());
+        EXPECT_EQ(firstCopy.m_recordSeq, first->m_recordSeq);
+        EXPECT_EQ(firstCopy.m_metrics, first->m_metrics);
+        EXPECT_EQ(firstCopy.m_recordSeq + 2, (*it)->m_recordSeq);
+
+        // Post-increment hands back the old record intact
+        auto before = it++;
+        EXPECT_EQ((*before)->m_recordSeq + 1, (*it)->m_recordSeq);
+    }
+}
+
+TEST_F(ApiIntegrationTest, MetricSelection_MatchesFullDecode)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    MetricSet selection;
+    selection.insert(EGT11);
+    selection.insert(CHT11);
+    selection.insert(FF11);
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        std::vector<FlightMetricsRecord> full;
+        FlightFile fullParser;
+        fullParser.setFlightRecordViewCb([&full](const FlightRecordView& view) { full.push_back(view.toRecord()); });
+        std::ifstream fullStream(filepath, std::ios::binary);
+        fullParser.processFile(fullStream);
+
+        std::vector<FlightMetricsRecord> selected;
+        FlightFile parser;
+        parser.setMetricSelection(selection);
+        parser.setFlightRecordViewCb(
+            [&selected](const FlightRecordView& view) { selected.push_back(view.toRecord()); });
+        std::ifstream stream(filepath, std::ios::binary);
+        parser.processFile(stream);
+
+        ASSERT_EQ(full.size(), selected.size());
+        for (size_t i = 0; i < full.size(); ++i) {
+            EXPECT_EQ(full[i].m_recordSeq, selected[i].m_recordSeq);
+            EXPECT_EQ(full[i].m_isFast, selected[i].m_isFast);
+            for (auto id : selected[i].m_metrics.ids()) {
+                EXPECT_TRUE(selection.contains(id)) << "Record " << i << " has metric " << id;
+                EXPECT_FLOAT_EQ(full[i].m_metrics.at(id), selected[i].m_metrics.at(id)) << "Record " << i;
+            }
+        }
+    }
+}
+
+TEST_F(ApiIntegrationTest, MetricSelection_AppliesToFlightViews)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        MetricSet parserSelection;
+        parserSelection.insert(RPM1);
+        parser.setMetricSelection(parserSelection);
+        std::ifstream stream(filepath, std::ios::binary);
+        auto range = parser.flights(stream);
+        ASSERT_FALSE(range.empty());
+
+        auto flight = range.at(0);
+        for (const auto& record : flight) {
+            EXPECT_EQ(parserSelection, record->m_metrics.ids());
+            break;
+        }
+
+        // The view's own selection wins, and is used when seeking too
+        MetricSet viewSelection;
+        viewSelection.insert(DIF1);
+        flight.setMetricSelection(viewSelection);
+        flight.buildCheckpoints(16);
+        auto it = flight.seekToRecord(flight.getTotalRecordCount() / 2);
+        ASSERT_NE(flight.end(), it);
+        EXPECT_EQ(1u, (*it)->m_metrics.count(DIF1));
+        EXPECT_EQ(1u, (*it)->m_metrics.count(EGT11));
+        EXPECT_EQ(0u, (*it)->m_metrics.count(RPM1));
+
+        // An empty selection goes back to every metric
+        flight.setMetricSelection(MetricSet{});
+        EXPECT_EQ(1u, (*flight.begin())->m_metrics.count(RPM1));
+    }
+}
+
+namespace {
+
+struct TimedRecord {
+    unsigned long seq{0};
+    std::time_t time{0};
+    float rpm{0};
+};
+
+// Every record in a file, or the ones the parser lets through
+std::vector<TimedRecord> timedRecords(FlightFile& parser, const std::string& filepath)
+{
+    std::vector<TimedRecord> records;
+    parser.setFlightRecordViewCb([&records](const FlightRecordView& view) {
+        records.push_back({view.recordSeq(), view.time(), view.metrics().get(RPM1, 0.0f)});
+    });
+    std::ifstream stream(filepath, std::ios::binary);
+    parser.processFile(stream);
+    return records;
+}
+
+} // namespace
+
+TEST_F(ApiIntegrationTest, RecordFilter_RecordTimesFollowTheHeader)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        std::ifstream stream(filepath, std::ios::binary);
+        auto range = parser.flights(stream);
+        ASSERT_FALSE(range.empty());
+        auto flight = range.at(0);
+
+        std::vector<std::time_t> times;
+        FlightFile timer;
+        timer.setFlightRecordViewCb([&times](const FlightRecordView& view) { times.push_back(view.time()); });
+        std::ifstream timerStream(filepath, std::ios::binary);
+        timer.processFile(timerStream, static_cast<int>(flight.getHeader().flight_num));
+
+        ASSERT_EQ(flight.getTotalRecordCount(), times.size());
+        EXPECT_EQ(flight.getHeader().startTime(), times.front());
+        std::time_t expected = times.front();
+        bool isFast = false;
+        size_t i = 0;
+        for (const auto& record : flight) {
+            if (i > 0) {
+                expected += isFast ? 1 : static_cast<std::time_t>(flight.getHeader().interval);
+            }
+            EXPECT_EQ(expected, times[i]) << "Record " << i;
+            isFast = record->m_isFast;
+            ++i;
+        }
+    }
+}
+
+TEST_F(ApiIntegrationTest, RecordFilter_TimeWindowMatchesFilteringAfterwards)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile fullParser;
+        auto all = timedRecords(fullParser, filepath);
+        ASSERT_GT(all.size(), 10u);
+
+        // A window starting and ending part way through the file's records
+        std::time_t from = all[all.size() / 3].time;
+        std::time_t to = all[all.size() / 2].time;
+        std::vector<TimedRecord> expected;
+        for (const auto& rec : all) {
+            if (rec.time >= from && rec.time < to) {
+                expected.push_back(rec);
+            }
+        }
+        ASSERT_FALSE(expected.empty());
+
+        FlightFile parser;
+        parser.setTimeWindow(from, to);
+        unsigned long flightRecords = 0;
+        parser.setFlightCompletionCb(
+            [&flightRecords](unsigned long stdRecs, unsigned long fastRecs) { flightRecords += stdRecs + fastRecs; });
+        auto windowed = timedRecords(parser, filepath);
+
+        ASSERT_EQ(expected.size(), windowed.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(expected[i].seq, windowed[i].seq);
+            EXPECT_EQ(expected[i].time, windowed[i].time);
+            EXPECT_FLOAT_EQ(expected[i].rpm, windowed[i].rpm);
+        }
+        // Records past the window are still counted
+        EXPECT_EQ(all.size(), flightRecords);
+    }
+}
+
+TEST_F(ApiIntegrationTest, RecordFilter_PredicateSeesLiveValues)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile fullParser;
+        auto all = timedRecords(fullParser, filepath);
+        size_t expected = 0;
+        for (const auto& rec : all) {
+            expected += rec.rpm > 2000.0f ? 1 : 0;
+        }
+
+        size_t built = 0;
+        FlightFile parser;
+        parser.setRecordFilter([](const FlightRecordView& view) { return view.metrics().get(RPM1, 0.0f) > 2000.0f; });
+        parser.setFlightRecordCompletionCb([&built](std::shared_ptr<FlightMetricsRecord> rec) {
+            EXPECT_GT(rec->m_metrics.at(RPM1), 2000.0f);
+            ++built;
+        });
+        auto filtered = timedRecords(parser, filepath);
+        EXPECT_EQ(expected, filtered.size());
+        EXPECT_EQ(expected, built);
+
+        // FlightView iteration skips them too
+        size_t iterated = 0;
+        std::ifstream stream(filepath, std::ios::binary);
+        for (const auto& flight : parser.flights(stream)) {
+            for (const auto& record : flight) {
+                EXPECT_GT(record->m_metrics.at(RPM1), 2000.0f);
+                ++iterated;
+            }
+        }
+        EXPECT_EQ(expected, iterated);
+
+        parser.setFlightRecordCompletionCb(nullptr);
+        parser.clearRecordFilters();
+        EXPECT_EQ(all.size(), timedRecords(parser, filepath).size());
+    }
+}
+
+TEST_F(ApiIntegrationTest, Verify_SampleFilesAreIntact)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        auto file = FlightFile::open(filepath);
+        FlightFile parser;
+        auto report = parser.verify(file);
+        EXPECT_TRUE(report.ok()) << report.error;
+
+        auto index = parser.buildFlightIndex(file);
+        ASSERT_EQ(index.size(), report.flights.size());
+        for (size_t i = 0; i < index.size(); ++i) {
+            EXPECT_EQ(index[i].headerOffset, report.flights[i].headerOffset);
+            EXPECT_EQ(index[i].endOffset, report.flights[i].endOffset);
+            EXPECT_EQ(index[i].recordCount(), report.flights[i].checksums.recordCount);
+        }
+    }
+}
+
 TEST_F(ApiIntegrationTest, IteratorAPI_FlightViewMetadataIsValid)
 {
     if (availableFiles.empty()) {
@@ -499,3 +829,227 @@ TEST_F(ApiIntegrationTest, BothAPIs_FlightHeadersMatch)
     }
 }
 
+
+TEST_F(ApiIntegrationTest, BothAPIs_ProduceSameRecords)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        // Every record of every flight, from the callback API
+        FlightFile callbackParser;
+        std::vector<std::vector<MetricValues>> callbackFlights;
+        callbackParser.setFlightHeaderCompletionCb(
+            [&callbackFlights](std::shared_ptr<FlightHeader>) { callbackFlights.emplace_back(); });
+        callbackParser.setFlightRecordCompletionCb([&callbackFlights](std::shared_ptr<FlightMetricsRecord> rec) {
+            callbackFlights.back().push_back(rec->m_metrics);
+        });
+        std::ifstream callbackStream(filepath, std::ios::binary);
+        callbackParser.processFile(callbackStream);
+
+        FlightFile iteratorParser;
+        std::ifstream iteratorStream(filepath, std::ios::binary);
+        size_t flightIdx = 0;
+        for (const auto& flight : iteratorParser.flights(iteratorStream)) {
+            ASSERT_LT(flightIdx, callbackFlights.size());
+            const auto& expected = callbackFlights[flightIdx];
+            EXPECT_EQ(expected.size(), flight.getTotalRecordCount());
+
+            // Twice, to check that each pass starts decoding afresh
+            for (int pass = 0; pass < 2; ++pass) {
+                size_t recordIdx = 0;
+                for (const auto& record : flight) {
+                    ASSERT_LT(recordIdx, expected.size()) << "flight " << flight.getHeader().flight_num;
+                    ASSERT_EQ(expected[recordIdx], record->m_metrics)
+                        << "flight " << flight.getHeader().flight_num << " record " << recordIdx;
+                    ++recordIdx;
+                }
+                EXPECT_EQ(expected.size(), recordIdx) << "flight " << flight.getHeader().flight_num;
+            }
+            ++flightIdx;
+        }
+        EXPECT_EQ(callbackFlights.size(), flightIdx);
+    }
+}
+
+// =============================================================================
+// Random Access Tests
+// =============================================================================
+
+TEST_F(ApiIntegrationTest, RandomAccess_AtMatchesSequentialIteration)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile sequentialParser;
+        std::ifstream sequentialStream(filepath, std::ios::binary);
+        std::vector<std::pair<unsigned int, std::vector<MetricValues>>> sequential;
+        for (const auto& flight : sequentialParser.flights(sequentialStream)) {
+            std::vector<MetricValues> records;
+            for (const auto& record : flight) {
+                records.push_back(record->m_metrics);
+            }
+            sequential.emplace_back(flight.getHeader().flight_num, std::move(records));
+        }
+
+        FlightFile parser;
+        auto file = FlightFile::open(filepath);
+        auto range = parser.flights(file);
+        ASSERT_EQ(sequential.size(), range.size());
+
+        // Backwards, so no flight is reached by iterating past the one before it
+        for (size_t i = range.size(); i-- > 0;) {
+            auto flight = range.at(i);
+            EXPECT_EQ(sequential[i].first, flight.getHeader().flight_num);
+            EXPECT_EQ(sequential[i].second.size(), flight.getTotalRecordCount());
+
+            std::vector<MetricValues> records;
+            for (const auto& record : flight) {
+                records.push_back(record->m_metrics);
+            }
+            EXPECT_TRUE(sequential[i].second == records) << "flight " << sequential[i].first;
+        }
+
+        EXPECT_THROW((void)range.at(range.size()), std::out_of_range);
+    }
+}
+
+TEST_F(ApiIntegrationTest, RandomAccess_FindFlightDecodesOnlyThatFlight)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        std::vector<unsigned int> headers;
+        size_t recordCallbacks = 0;
+        parser.setFlightHeaderCompletionCb(
+            [&headers](std::shared_ptr<FlightHeader> hdr) { headers.push_back(hdr->flight_num); });
+        parser.setFlightRecordCompletionCb([&recordCallbacks](std::shared_ptr<FlightMetricsRecord>) {
+            ++recordCallbacks;
+        });
+
+        std::ifstream stream(filepath, std::ios::binary);
+        auto range = parser.flights(stream);
+        ASSERT_FALSE(range.empty());
+
+        EXPECT_EQ(range.end(), range.findFlight(-1));
+
+        int lastFlight = static_cast<int>(range.at(range.size() - 1).getHeader().flight_num);
+        headers.clear();
+        auto it = range.findFlight(lastFlight);
+        ASSERT_NE(range.end(), it);
+        EXPECT_EQ(std::vector<unsigned int>{static_cast<unsigned int>(lastFlight)}, headers);
+        EXPECT_EQ(0u, recordCallbacks);
+
+        size_t records = 0;
+        for (const auto& record : *it) {
+            (void)record;
+            ++records;
+        }
+        EXPECT_EQ(it->getTotalRecordCount(), records);
+        EXPECT_EQ(records, recordCallbacks);
+
+        ++it;
+        EXPECT_EQ(range.end(), it);
+    }
+}
+
+TEST_F(ApiIntegrationTest, RandomAccess_SeekToRecordMatchesSequentialIteration)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        auto file = FlightFile::open(filepath);
+        auto range = parser.flights(file);
+        ASSERT_FALSE(range.empty());
+        auto flight = range.at(range.size() / 2);
+
+        std::vector<std::pair<unsigned long, MetricValues>> sequential;
+        for (const auto& record : flight) {
+            sequential.emplace_back(record->m_recordSeq, record->m_metrics);
+        }
+        size_t count = sequential.size();
+        ASSERT_GT(count, 0u);
+
+        auto expectRecordsFrom = [&](size_t n, const FlightView::RecordIterator& from) {
+            auto it = from;
+            for (size_t i = n; i < std::min(count, n + 3); ++i, ++it) {
+                ASSERT_NE(flight.end(), it) << "record " << i;
+                EXPECT_EQ(sequential[i].first, (*it)->m_recordSeq) << "record " << i;
+                EXPECT_TRUE(sequential[i].second == (*it)->m_metrics) << "record " << i;
+            }
+        };
+
+        // Without checkpoints, seeking replays from the first record
+        EXPECT_FALSE(flight.hasCheckpoints());
+        expectRecordsFrom(count / 2, flight.seekToRecord(count / 2));
+
+        flight.buildCheckpoints(7);
+        EXPECT_TRUE(flight.hasCheckpoints());
+        for (size_t n : {size_t{0}, size_t{1}, size_t{6}, size_t{7}, size_t{8}, count / 3, count - 1}) {
+            if (n < count) {
+                expectRecordsFrom(n, flight.seekToRecord(n));
+            }
+        }
+        EXPECT_EQ(flight.end(), flight.seekToRecord(count));
+
+        EXPECT_THROW(flight.buildCheckpoints(0), std::invalid_argument);
+    }
+}
+
+TEST_F(ApiIntegrationTest, RandomAccess_SeekToTimeFindsFirstRecordAtOrAfter)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto& [filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        auto file = FlightFile::open(filepath);
+        auto range = parser.flights(file);
+        ASSERT_FALSE(range.empty());
+        auto flight = range.at(range.size() - 1);
+
+        // Each record's time, and its sequence number
+        std::vector<std::pair<std::time_t, unsigned long>> timeline;
+        std::time_t time = flight.getHeader().startTime();
+        for (const auto& record : flight) {
+            timeline.emplace_back(time, record->m_recordSeq);
+            time += record->m_isFast ? 1 : static_cast<std::time_t>(flight.getHeader().interval);
+        }
+        ASSERT_FALSE(timeline.empty());
+
+        flight.buildCheckpoints(5);
+        EXPECT_EQ(timeline.front().second, (*flight.seekToTime(timeline.front().first - 100))->m_recordSeq);
+        for (size_t i : {size_t{0}, size_t{4}, size_t{5}, timeline.size() / 2, timeline.size() - 1}) {
+            if (i >= timeline.size()) {
+                continue;
+            }
+            EXPECT_EQ(timeline[i].second, (*flight.seekToTime(timeline[i].first))->m_recordSeq) << "record " << i;
+            if (i > 0 && timeline[i].first - timeline[i - 1].first > 1) {
+                // Between two records: the later one
+                EXPECT_EQ(timeline[i].second, (*flight.seekToTime(timeline[i].first - 1))->m_recordSeq)
+                    << "record " << i;
+            }
+        }
+        EXPECT_EQ(flight.end(), flight.seekToTime(timeline.back().first + 1));
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * Unit tests for ByteReader, BinaryChecksum and the byte sum kernels
+ */
+
+#include <gtest/gtest.h>
+#include <ByteReader.hpp>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+using namespace jpi_edm;
+
+TEST(ByteReaderTest, ReadsBytesInOrder) {
+    const std::vector<uint8_t> data = {0x01, 0x02, 0x03};
+    ByteReader reader(data.data(), data.size());
+
+    EXPECT_EQ(0u, reader.position());
+    EXPECT_EQ(3u, reader.remaining());
+    EXPECT_EQ(0x01, reader.readU8());
+    EXPECT_EQ(0x02, reader.readU8());
+    EXPECT_EQ(1u, reader.remaining());
+    EXPECT_EQ(0x03, reader.readU8());
+    EXPECT_EQ(0u, reader.remaining());
+}
+
+TEST(ByteReaderTest, ReadsBigEndianWords) {
+    const std::vector<uint8_t> data = {0x12, 0x34, 0xAB, 0xCD};
+    ByteReader reader(data.data(), data.size());
+
+    EXPECT_EQ(0x1234, reader.readU16BE());
+    EXPECT_EQ(0xABCD, reader.readU16BE());
+}
+
+TEST(ByteReaderTest, ReadReturnsPointerIntoSpan) {
+    const std::vector<uint8_t> data = {0x01, 0x02, 0x03, 0x04};
+    ByteReader reader(data.data(), data.size());
+
+    reader.skip(1);
+    const uint8_t *p = reader.read(2);
+    EXPECT_EQ(data.data() + 1, p);
+    EXPECT_EQ(3u, reader.position());
+}
+
+TEST(ByteReaderTest, ThrowsWhenReadingPastEnd) {
+    const std::vector<uint8_t> data = {0x01};
+    ByteReader reader(data.data(), data.size());
+
+    EXPECT_FALSE(reader.has(2));
+    EXPECT_THROW(reader.readU16BE(), std::runtime_error);
+    // A failed read doesn't move the cursor
+    EXPECT_EQ(0u, reader.position());
+    EXPECT_THROW(reader.read(2), std::runtime_error);
+    EXPECT_THROW(reader.seek(2), std::runtime_error);
+}
+
+TEST(BinaryChecksumTest, AccumulatesSumAndXor) {
+    const std::vector<uint8_t> data = {0x10, 0x20, 0xF0};
+    BinaryChecksum checksum;
+    checksum.add(data.data(), data.size());
+
+    EXPECT_EQ(static_cast<uint8_t>(0x10 + 0x20 + 0xF0), checksum.sum);
+    EXPECT_EQ(static_cast<uint8_t>(0x10 ^ 0x20 ^ 0xF0), checksum.xorSum);
+}
+
+TEST(BinaryChecksumTest, MatchesNegatedSumOrXor) {
+    const std::vector<uint8_t> data = {0x10, 0x20, 0xF0};
+    BinaryChecksum checksum;
+    checksum.add(data.data(), data.size());
+
+    EXPECT_TRUE(checksum.matches(static_cast<uint8_t>(-(0x10 + 0x20 + 0xF0))));
+    EXPECT_TRUE(checksum.matches(static_cast<uint8_t>(0x10 ^ 0x20 ^ 0xF0)));
+    EXPECT_FALSE(checksum.matches(0x00));
+}
+
+TEST(BinaryChecksumTest, AddingInPiecesMatchesAddingAtOnce) {
+    std::vector<uint8_t> data(300);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    BinaryChecksum whole;
+    whole.add(data.data(), data.size());
+
+    BinaryChecksum pieces;
+    pieces.add(data.data(), 7);
+    pieces.add(data.data() + 7, 100);
+    pieces.add(data[107]);
+    pieces.add(data.data() + 108, data.size() - 108);
+
+    EXPECT_EQ(whole.sum, pieces.sum);
+    EXPECT_EQ(whole.xorSum, pieces.xorSum);
+}
+
+TEST(SumBytesTest, VectorKernelMatchesScalar) {
+    const std::string kernel = sumBytesKernel();
+    EXPECT_TRUE(kernel == "avx2" || kernel == "sse2" || kernel == "scalar") << kernel;
+
+    std::vector<uint8_t> data(600);
+    uint32_t state = 12345;
+    for (auto &byte : data) {
+        state = state * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(state >> 16);
+    }
+
+    // Every alignment, and lengths either side of the vector widths
+    for (size_t offset = 0; offset < 32; ++offset) {
+        for (size_t len = 0; len + offset <= data.size(); len += (len < 70 ? 1 : 53)) {
+            auto expected = sumBytesScalar(data.data() + offset, len);
+            auto actual = sumBytes(data.data() + offset, len);
+            ASSERT_EQ(expected.sum, actual.sum) << "offset " << offset << " len " << len;
+            ASSERT_EQ(expected.xorSum, actual.xorSum) << "offset " << offset << " len " << len;
+        }
+    }
+}
+
+TEST(SumBytesTest, SumWrapsAt256) {
+    const std::vector<uint8_t> data(1000, 0xFF);
+    auto sums = sumBytes(data.data(), data.size());
+    EXPECT_EQ(static_cast<uint8_t>(1000 * 0xFF), sums.sum);
+    EXPECT_EQ(0u, sums.xorSum);
+}
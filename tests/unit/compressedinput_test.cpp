@@ -0,0 +1,185 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * Unit tests for compressed and zipped input
+ */
+
+#include <gtest/gtest.h>
+#include <CompressedInput.hpp>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace jpi_edm;
+
+namespace {
+
+const std::string CONTENT = "$L,1*4C\r\n$L,1*4C\r\n$L,1*4C\r\n";
+
+// CONTENT, gzipped
+const std::vector<uint8_t> GZIPPED = {0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x53,
+                                      0xF1, 0xD1, 0x31, 0xD4, 0x32, 0x71, 0xE6, 0xE5, 0x52, 0xC1, 0x60,
+                                      0x00, 0x00, 0xAC, 0x97, 0xAF, 0x60, 0x1B, 0x00, 0x00, 0x00};
+
+// CONTENT, zstd compressed with a content checksum
+const std::vector<uint8_t> ZSTD_COMPRESSED = {0x28, 0xB5, 0x2F, 0xFD, 0x24, 0x1B, 0x85, 0x00, 0x00, 0x50,
+                                              0x24, 0x4C, 0x2C, 0x31, 0x2A, 0x34, 0x43, 0x0D, 0x0A, 0x24,
+                                              0x01, 0x00, 0x9C, 0x0B, 0x12, 0xA5, 0x86, 0x2B, 0x94};
+
+// A zip archive of CONTENT deflated as LOG.JPI, and "hi" stored as notes.txt
+const std::vector<uint8_t> ZIPPED = {
+    0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0xAC, 0x97, 0xAF, 0x60,
+    0x0E, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x4C, 0x4F, 0x47, 0x2E, 0x4A, 0x50,
+    0x49, 0x53, 0xF1, 0xD1, 0x31, 0xD4, 0x32, 0x71, 0xE6, 0xE5, 0x52, 0xC1, 0x60, 0x00, 0x00, 0x50, 0x4B, 0x03,
+    0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xAC, 0x2A, 0x93, 0xD8, 0x02, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x6E, 0x6F, 0x74, 0x65, 0x73, 0x2E, 0x74, 0x78, 0x74,
+    0x68, 0x69, 0x50, 0x4B, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00,
+    0xAC, 0x97, 0xAF, 0x60, 0x0E, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x4C, 0x4F, 0x47, 0x2E, 0x4A, 0x50,
+    0x49, 0x50, 0x4B, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xAC,
+    0x2A, 0x93, 0xD8, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x33, 0x00, 0x00, 0x00, 0x6E, 0x6F, 0x74, 0x65, 0x73, 0x2E, 0x74,
+    0x78, 0x74, 0x50, 0x4B, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x6C, 0x00, 0x00, 0x00,
+    0x5C, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+// A sink that collects everything it's given
+ByteSink collectInto(std::string &out)
+{
+    return [&out](const uint8_t *data, std::size_t len) { out.append(reinterpret_cast<const char *>(data), len); };
+}
+
+} // namespace
+
+TEST(CompressedInputTest, DetectsFormatsByMagicNumber) {
+    EXPECT_EQ(InputFormat::GZIP, detectInputFormat(GZIPPED.data(), GZIPPED.size()));
+    EXPECT_EQ(InputFormat::ZIP, detectInputFormat(ZIPPED.data(), ZIPPED.size()));
+    const uint8_t zstd[] = {0x28, 0xB5, 0x2F, 0xFD, 0x00};
+    EXPECT_EQ(InputFormat::ZSTD, detectInputFormat(zstd, sizeof(zstd)));
+    EXPECT_EQ(InputFormat::RAW, detectInputFormat(reinterpret_cast<const uint8_t *>(CONTENT.data()), CONTENT.size()));
+    EXPECT_EQ(InputFormat::RAW, detectInputFormat(GZIPPED.data(), 1));
+    EXPECT_TRUE(canDecompress(InputFormat::RAW));
+}
+
+TEST(CompressedInputTest, Crc32MatchesTheStandardCheckValue) {
+    const std::string check = "123456789";
+    auto data = reinterpret_cast<const uint8_t *>(check.data());
+    EXPECT_EQ(0xCBF43926U, crc32(data, check.size()));
+    EXPECT_EQ(0xCBF43926U, crc32(data + 4, 5, crc32(data, 4)));
+    EXPECT_EQ(0U, crc32(data, 0));
+}
+
+TEST(CompressedInputTest, RawStreamsPassThrough) {
+    std::istringstream stream(CONTENT);
+    std::string out;
+    readDecompressed(stream, collectInto(out));
+    EXPECT_EQ(CONTENT, out);
+}
+
+TEST(CompressedInputTest, GzipIsInflated) {
+    if (!canDecompress(InputFormat::GZIP)) {
+        EXPECT_THROW((void)Decompressor::create(InputFormat::GZIP), std::runtime_error);
+        GTEST_SKIP() << "Built without zlib";
+    }
+
+    std::string out;
+    readDecompressed(GZIPPED.data(), GZIPPED.size(), collectInto(out));
+    EXPECT_EQ(CONTENT, out);
+
+    // A byte at a time, through the decompressor directly
+    out.clear();
+    auto sink = collectInto(out);
+    auto decompressor = Decompressor::create(InputFormat::GZIP);
+    for (auto byte : GZIPPED) {
+        decompressor->write(&byte, 1, sink);
+    }
+    decompressor->finish(sink);
+    EXPECT_EQ(CONTENT, out);
+}
+
+TEST(CompressedInputTest, TruncatedGzipThrows) {
+    if (!canDecompress(InputFormat::GZIP)) {
+        GTEST_SKIP() << "Built without zlib";
+    }
+
+    std::string truncated(reinterpret_cast<const char *>(GZIPPED.data()), GZIPPED.size() - 6);
+    std::istringstream stream(truncated);
+    std::string out;
+    EXPECT_THROW(readDecompressed(stream, collectInto(out)), std::runtime_error);
+}
+
+TEST(CompressedInputTest, ZstdIsDecompressed) {
+    if (!canDecompress(InputFormat::ZSTD)) {
+        EXPECT_THROW((void)Decompressor::create(InputFormat::ZSTD), std::runtime_error);
+        GTEST_SKIP() << "Built without libzstd";
+    }
+
+    std::string out;
+    readDecompressed(ZSTD_COMPRESSED.data(), ZSTD_COMPRESSED.size(), collectInto(out));
+    EXPECT_EQ(CONTENT, out);
+
+    // A byte at a time, through the decompressor directly
+    out.clear();
+    auto sink = collectInto(out);
+    auto decompressor = Decompressor::create(InputFormat::ZSTD);
+    for (auto byte : ZSTD_COMPRESSED) {
+        decompressor->write(&byte, 1, sink);
+    }
+    decompressor->finish(sink);
+    EXPECT_EQ(CONTENT, out);
+
+    // Concatenated frames decompress to their contents, one after the other
+    auto twice = ZSTD_COMPRESSED;
+    twice.insert(twice.end(), ZSTD_COMPRESSED.begin(), ZSTD_COMPRESSED.end());
+    std::istringstream stream(std::string(twice.begin(), twice.end()));
+    out.clear();
+    readDecompressed(stream, collectInto(out));
+    EXPECT_EQ(CONTENT + CONTENT, out);
+}
+
+TEST(CompressedInputTest, TruncatedZstdThrows) {
+    if (!canDecompress(InputFormat::ZSTD)) {
+        GTEST_SKIP() << "Built without libzstd";
+    }
+
+    std::string truncated(reinterpret_cast<const char *>(ZSTD_COMPRESSED.data()), ZSTD_COMPRESSED.size() - 6);
+    std::istringstream stream(truncated);
+    std::string out;
+    EXPECT_THROW(readDecompressed(stream, collectInto(out)), std::runtime_error);
+}
+
+TEST(CompressedInputTest, ZipArchiveListsAndReadsMembers) {
+    ZipArchive archive(ZIPPED.data(), ZIPPED.size());
+    ASSERT_EQ(2u, archive.entries().size());
+    EXPECT_EQ("LOG.JPI", archive.entries()[0].name);
+    EXPECT_EQ("notes.txt", archive.entries()[1].name);
+
+    auto jpis = archive.jpiEntries();
+    ASSERT_EQ(1u, jpis.size());
+    EXPECT_EQ("LOG.JPI", jpis[0].name);
+
+    std::string notes;
+    archive.read(archive.entries()[1], collectInto(notes));
+    EXPECT_EQ("hi", notes);
+
+    if (canDecompress(InputFormat::ZIP)) {
+        std::string log;
+        archive.read(jpis[0], collectInto(log));
+        EXPECT_EQ(CONTENT, log);
+    }
+}
+
+TEST(CompressedInputTest, ZipMemberWithBadCrcThrows) {
+    ZipArchive archive(ZIPPED.data(), ZIPPED.size());
+    auto entry = archive.entries()[1];
+    entry.crc32 ^= 1;
+    std::string out;
+    EXPECT_THROW(archive.read(entry, collectInto(out)), std::runtime_error);
+}
+
+TEST(CompressedInputTest, NotAZipArchiveThrows) {
+    EXPECT_THROW(ZipArchive(GZIPPED.data(), GZIPPED.size()), std::runtime_error);
+    EXPECT_THROW(ZipArchive(ZIPPED.data(), 10), std::runtime_error);
+}
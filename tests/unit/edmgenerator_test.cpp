@@ -0,0 +1,438 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Tests that the synthetic EDM file generator writes files the parser reads back cleanly
+ */
+
+#include <gtest/gtest.h>
+
+#include "EdmGenerator.hpp"
+#include "FlightFile.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace jpi_edm;
+using edmgen::EdmGenerator;
+using edmgen::GeneratorOptions;
+
+namespace {
+
+std::string generate(const GeneratorOptions &options)
+{
+    std::ostringstream out;
+    EdmGenerator(options).write(out);
+    return out.str();
+}
+
+// Redirects std::cerr for the lifetime of the object
+class CerrCapture
+{
+  public:
+    CerrCapture() : m_old(std::cerr.rdbuf(m_captured.rdbuf())) {}
+    ~CerrCapture() { std::cerr.rdbuf(m_old); }
+
+    std::string text() const { return m_captured.str(); }
+
+  private:
+    std::ostringstream m_captured;
+    std::streambuf *m_old;
+};
+
+// Writes bytes to a file that's removed again with the object
+class TempFile
+{
+  public:
+    explicit TempFile(const std::string &contents)
+    {
+        static int counter = 0;
+        m_path = (std::filesystem::temp_directory_path() /
+                  ("jpiedm_edmgenerator_test_" + std::to_string(::getpid()) + "_" + std::to_string(counter++)))
+                     .string();
+        std::ofstream out(m_path, std::ios::binary);
+        out << contents;
+    }
+    ~TempFile() { std::remove(m_path.c_str()); }
+
+    const std::string &path() const { return m_path; }
+
+  private:
+    std::string m_path;
+};
+
+struct ParsedFlight {
+    unsigned int flightNumber{0};
+    std::time_t startTime{0};
+    unsigned long stdRecCount{0};
+    unsigned long fastRecCount{0};
+};
+
+struct ParsedFile {
+    std::shared_ptr<Metadata> metadata;
+    std::vector<ParsedFlight> flights;
+    unsigned long records{0};
+    std::string warnings;
+};
+
+ParsedFile parse(const std::string &bytes)
+{
+    ParsedFile result;
+    FlightFile parser;
+    parser.setMetadataCompletionCb([&result](std::shared_ptr<Metadata> md) { result.metadata = md; });
+    parser.setFlightHeaderCompletionCb([&result](std::shared_ptr<FlightHeader> hdr) {
+        result.flights.push_back({hdr->flight_num, hdr->startTime(), 0, 0});
+    });
+    parser.setFlightRecordCompletionCb([&result](std::shared_ptr<FlightMetricsRecord>) { ++result.records; });
+    parser.setFlightCompletionCb([&result](unsigned long stdRecs, unsigned long fastRecs) {
+        result.flights.back().stdRecCount = stdRecs;
+        result.flights.back().fastRecCount = fastRecs;
+    });
+
+    CerrCapture capture;
+    std::istringstream stream(bytes);
+    parser.processFile(stream);
+    result.warnings = capture.text();
+    return result;
+}
+
+void expectRoundTrip(const GeneratorOptions &options)
+{
+    EdmGenerator generator(options);
+    std::ostringstream out;
+    generator.write(out);
+
+    auto parsed = parse(out.str());
+    EXPECT_EQ(parsed.warnings, "");
+    ASSERT_NE(parsed.metadata, nullptr);
+    EXPECT_EQ(parsed.metadata->ProtoVersion(), options.version);
+    EXPECT_EQ(parsed.metadata->IsTwin(), options.twin);
+    EXPECT_EQ(parsed.metadata->NumCylinders(), options.cylinders);
+
+    const auto &expected = generator.flights();
+    ASSERT_EQ(parsed.flights.size(), expected.size());
+    unsigned long expectedRecords = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(parsed.flights[i].flightNumber, expected[i].flightNumber);
+        EXPECT_EQ(parsed.flights[i].startTime, expected[i].startTime);
+        EXPECT_EQ(parsed.flights[i].stdRecCount, expected[i].stdRecCount);
+        EXPECT_EQ(parsed.flights[i].fastRecCount, expected[i].fastRecCount);
+        expectedRecords += expected[i].stdRecCount + expected[i].fastRecCount;
+    }
+    EXPECT_EQ(parsed.records, expectedRecords);
+}
+
+GeneratorOptions smallFile(EDMVersion version, bool twin)
+{
+    GeneratorOptions options;
+    options.version = version;
+    options.twin = twin;
+    options.cylinders = 4;
+    options.flights = 3;
+    options.recordsPerFlight = 150;
+    return options;
+}
+
+} // namespace
+
+TEST(EdmGeneratorTest, V1RoundTrips) { expectRoundTrip(smallFile(V1, false)); }
+
+TEST(EdmGeneratorTest, V2TwinRoundTrips) { expectRoundTrip(smallFile(V2, true)); }
+
+TEST(EdmGeneratorTest, V4RoundTrips) { expectRoundTrip(smallFile(V4, false)); }
+
+TEST(EdmGeneratorTest, V5TwinRoundTrips) { expectRoundTrip(smallFile(V5, true)); }
+
+TEST(EdmGeneratorTest, GpsAndFastModeRoundTrip)
+{
+    auto options = smallFile(V4, false);
+    options.cylinders = 6;
+    options.gps = true;
+    options.fastFraction = 0.25;
+    options.fastRunLength = 20;
+    expectRoundTrip(options);
+
+    options = smallFile(V5, true);
+    options.gps = true;
+    options.fastFraction = 0.5;
+    options.fastRunLength = 10;
+    expectRoundTrip(options);
+}
+
+TEST(EdmGeneratorTest, NineCylindersRoundTrip)
+{
+    auto options = smallFile(V1, false);
+    options.cylinders = 9;
+    expectRoundTrip(options);
+}
+
+TEST(EdmGeneratorTest, SameSeedSameBytes)
+{
+    auto options = smallFile(V5, true);
+    options.gps = true;
+    options.fastFraction = 0.1;
+    EXPECT_EQ(generate(options), generate(options));
+
+    auto reseeded = options;
+    reseeded.seed = options.seed + 1;
+    EXPECT_NE(generate(options), generate(reseeded));
+}
+
+TEST(EdmGeneratorTest, FlightsArePlannedInOrder)
+{
+    auto options = smallFile(V4, false);
+    options.firstFlightNumber = 41;
+    options.fastFraction = 0.2;
+    options.fastRunLength = 10;
+    EdmGenerator generator(options);
+
+    const auto &flights = generator.flights();
+    ASSERT_EQ(flights.size(), 3u);
+    for (size_t i = 0; i < flights.size(); ++i) {
+        EXPECT_EQ(flights[i].flightNumber, 41 + i);
+        EXPECT_EQ(flights[i].stdRecCount + flights[i].fastRecCount, options.recordsPerFlight);
+        EXPECT_GT(flights[i].fastRecCount, 0u);
+        if (i > 0) {
+            EXPECT_GT(flights[i].startTime, flights[i - 1].startTime);
+        }
+    }
+    EXPECT_EQ(flights[0].startTime, options.startTime);
+}
+
+TEST(EdmGeneratorTest, IndexMatchesPlan)
+{
+    auto options = smallFile(V5, true);
+    options.gps = true;
+    options.fastFraction = 0.3;
+    EdmGenerator generator(options);
+    std::ostringstream out;
+    generator.write(out);
+
+    FlightFile parser;
+    std::istringstream stream(out.str());
+    auto index = parser.buildFlightIndex(stream);
+    const auto &expected = generator.flights();
+    ASSERT_EQ(index.size(), expected.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        EXPECT_EQ(index[i].flightNumber, static_cast<int>(expected[i].flightNumber));
+        EXPECT_EQ(index[i].stdRecCount, expected[i].stdRecCount);
+        EXPECT_EQ(index[i].fastRecCount, expected[i].fastRecCount);
+    }
+    EXPECT_EQ(index.back().endOffset, static_cast<std::streamoff>(out.str().size()));
+}
+
+TEST(EdmGeneratorTest, SkippingLandsOnEveryFlight)
+{
+    auto options = smallFile(V5, true);
+    options.gps = true;
+    options.flights = 6;
+    options.fastFraction = 0.3;
+    options.fastRunLength = 15;
+    EdmGenerator generator(options);
+    auto bytes = generate(options);
+
+    // Parsing just one flight skips all the ones before it
+    for (const auto &expected : generator.flights()) {
+        SCOPED_TRACE(expected.flightNumber);
+        std::vector<unsigned int> headers;
+        unsigned long stdRecs = 0;
+        unsigned long fastRecs = 0;
+        FlightFile parser;
+        parser.setFlightHeaderCompletionCb(
+            [&headers](std::shared_ptr<FlightHeader> hdr) { headers.push_back(hdr->flight_num); });
+        parser.setFlightCompletionCb([&](unsigned long stdCount, unsigned long fastCount) {
+            stdRecs = stdCount;
+            fastRecs = fastCount;
+        });
+        std::istringstream stream(bytes);
+        parser.processFile(stream, static_cast<int>(expected.flightNumber));
+
+        EXPECT_EQ(headers, std::vector<unsigned int>{expected.flightNumber});
+        EXPECT_EQ(stdRecs, expected.stdRecCount);
+        EXPECT_EQ(fastRecs, expected.fastRecCount);
+    }
+}
+
+TEST(EdmGeneratorTest, FlightChecksumsVerify)
+{
+    auto options = smallFile(V4, false);
+    options.gps = true;
+    options.fastFraction = 0.2;
+    auto bytes = generate(options);
+
+    auto check = [](const std::string &fileBytes) {
+        TempFile temp(fileBytes);
+        auto file = FlightFile::open(temp.path());
+        FlightFile parser;
+        auto index = parser.buildFlightIndex(file);
+        std::vector<FlightFile::FlightChecksums> results;
+        for (const auto &entry : index) {
+            results.push_back(FlightFile::verifyFlightChecksums(file, entry));
+        }
+        return std::make_pair(index, results);
+    };
+
+    auto [index, results] = check(bytes);
+    ASSERT_EQ(results.size(), 3u);
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_TRUE(results[i].headerOk);
+        EXPECT_EQ(results[i].recordCount, index[i].recordCount());
+        EXPECT_EQ(results[i].badRecordCount, 0u);
+        EXPECT_FALSE(results[i].firstBadOffset.has_value());
+    }
+
+    // Damage the checksum byte of the middle flight's last record
+    auto damaged = bytes;
+    damaged[static_cast<size_t>(index[1].endOffset - 1)] ^= 0x5A;
+    auto [damagedIndex, damagedResults] = check(damaged);
+    EXPECT_EQ(damagedResults[0].badRecordCount, 0u);
+    EXPECT_EQ(damagedResults[1].badRecordCount, 1u);
+    EXPECT_TRUE(damagedResults[1].headerOk);
+    ASSERT_TRUE(damagedResults[1].firstBadOffset.has_value());
+    EXPECT_GT(*damagedResults[1].firstBadOffset, index[1].dataOffset);
+    EXPECT_LT(*damagedResults[1].firstBadOffset, index[1].endOffset);
+    EXPECT_EQ(damagedResults[2].badRecordCount, 0u);
+
+    // and the last flight's header
+    damaged = bytes;
+    damaged[static_cast<size_t>(index[2].headerOffset + 4)] ^= 0x01;
+    auto [headerIndex, headerResults] = check(damaged);
+    EXPECT_FALSE(headerResults[2].headerOk);
+    EXPECT_EQ(headerResults[2].firstBadOffset, index[2].headerOffset);
+}
+
+TEST(EdmGeneratorTest, VerifyPassesAnUndamagedFile)
+{
+    auto options = smallFile(V5, true);
+    options.gps = true;
+    options.fastFraction = 0.2;
+    EdmGenerator generator(options);
+    auto bytes = generate(options);
+
+    int callbacks = 0;
+    FlightFile parser;
+    parser.setMetadataCompletionCb([&callbacks](std::shared_ptr<Metadata>) { ++callbacks; });
+    parser.setFlightHeaderCompletionCb([&callbacks](std::shared_ptr<FlightHeader>) { ++callbacks; });
+    parser.setFlightRecordViewCb([&callbacks](const FlightRecordView &) { ++callbacks; });
+    parser.setFlightCompletionCb([&callbacks](unsigned long, unsigned long) { ++callbacks; });
+
+    std::istringstream stream(bytes);
+    auto report = parser.verify(stream);
+    EXPECT_TRUE(report.ok()) << report.error;
+    EXPECT_EQ(callbacks, 0);
+    EXPECT_EQ(report.badHeaderLines, 0u);
+    EXPECT_GT(report.headerLines, 5u);
+    EXPECT_FALSE(report.firstBadOffset.has_value());
+
+    const auto &expected = generator.flights();
+    ASSERT_EQ(report.flights.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(report.flights[i].flightNumber, static_cast<int>(expected[i].flightNumber));
+        EXPECT_EQ(report.flights[i].checksums.okRecordCount(), expected[i].stdRecCount + expected[i].fastRecCount);
+        if (i > 0) {
+            EXPECT_EQ(report.flights[i].headerOffset, report.flights[i - 1].endOffset);
+        }
+    }
+    EXPECT_EQ(report.flights.back().endOffset, static_cast<std::streamoff>(bytes.size()));
+
+    // The same from a mapped file
+    TempFile temp(bytes);
+    auto mapped = parser.verify(FlightFile::open(temp.path()));
+    EXPECT_TRUE(mapped.ok());
+    EXPECT_EQ(mapped.flights.size(), report.flights.size());
+}
+
+TEST(EdmGeneratorTest, VerifyFindsDamage)
+{
+    auto options = smallFile(V4, false);
+    auto bytes = generate(options);
+    FlightFile parser;
+    std::istringstream cleanStream(bytes);
+    auto clean = parser.verify(cleanStream);
+    ASSERT_TRUE(clean.ok());
+    const auto &flights = clean.flights;
+
+    // A header line: the tail number in $U
+    auto damaged = bytes;
+    damaged[bytes.find("N12345")] = 'X';
+    {
+        CerrCapture quiet;
+        std::istringstream stream(damaged);
+        auto report = parser.verify(stream);
+        EXPECT_FALSE(report.ok());
+        EXPECT_EQ(report.badHeaderLines, 1u);
+        EXPECT_EQ(report.firstBadOffset, std::streamoff{0});
+        EXPECT_EQ(report.flights.size(), flights.size());
+        EXPECT_TRUE(report.error.empty());
+    }
+
+    // The last record of the second flight
+    damaged = bytes;
+    damaged[static_cast<size_t>(flights[1].endOffset - 1)] ^= 0x5A;
+    {
+        std::istringstream stream(damaged);
+        auto report = parser.verify(stream);
+        EXPECT_FALSE(report.ok());
+        ASSERT_EQ(report.flights.size(), flights.size());
+        EXPECT_TRUE(report.flights[0].ok());
+        EXPECT_FALSE(report.flights[1].ok());
+        EXPECT_EQ(report.flights[1].checksums.badRecordCount, 1u);
+        EXPECT_EQ(report.flights[1].checksums.okRecordCount(), flights[1].checksums.recordCount - 1);
+        EXPECT_TRUE(report.flights[2].ok());
+        EXPECT_EQ(report.firstBadOffset, report.flights[1].checksums.firstBadOffset);
+    }
+
+    // Cut off part way through the last flight
+    damaged = bytes.substr(0, static_cast<size_t>(flights[2].headerOffset + 100));
+    {
+        std::istringstream stream(damaged);
+        auto report = parser.verify(stream);
+        EXPECT_FALSE(report.ok());
+        EXPECT_NE(report.error.find("Truncated"), std::string::npos) << report.error;
+        EXPECT_EQ(report.flights.size(), 2u);
+    }
+}
+
+TEST(EdmGeneratorTest, RejectsImpossibleOptions)
+{
+    auto options = smallFile(V4, false);
+    options.twin = true;
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+
+    options = smallFile(V1, false);
+    options.gps = true;
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+
+    options = smallFile(V3, false);
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+
+    options = smallFile(V4, false);
+    options.cylinders = 0;
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+
+    options = smallFile(V4, false);
+    options.cylinders = 10;
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+
+    options = smallFile(V4, false);
+    options.fastFraction = 1.5;
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+
+    options = smallFile(V4, false);
+    options.flights = -1;
+    EXPECT_THROW(EdmGenerator{options}, std::invalid_argument);
+}
@@ -383,3 +383,144 @@ TEST_F(FlightTest, RecordCountsCanBeTracked) {
     EXPECT_EQ(100, flight->m_stdRecCount);
     EXPECT_EQ(50, flight->m_fastRecCount);
 }
+
+TEST(RecordDeltasTest, TracksPresentFields) {
+    RecordDeltas deltas;
+    EXPECT_TRUE(deltas.empty());
+
+    deltas.set(5, -12);
+    deltas.set(127, 3);
+
+    EXPECT_EQ(2u, deltas.size());
+    EXPECT_TRUE(deltas.contains(5));
+    EXPECT_FALSE(deltas.contains(6));
+    EXPECT_EQ(-12, deltas[5]);
+    EXPECT_EQ(0, deltas[6]);
+
+    deltas.clear();
+    EXPECT_TRUE(deltas.empty());
+    EXPECT_EQ(0, deltas[5]);
+}
+
+TEST(RecordDeltasTest, MapConstructorDropsOutOfRangeFields) {
+    RecordDeltas deltas(std::map<int, int>{{-1, 1}, {0, 7}, {128, 2}, {999, 3}});
+
+    EXPECT_EQ(1u, deltas.size());
+    EXPECT_EQ(7, deltas[0]);
+}
+
+TEST_F(FlightTest, UpdateMetricsFromRecordDeltasMatchesMap) {
+    createFlight();
+    auto mapFlight = std::make_shared<Flight>(metadata);
+
+    // a delta for every mapped field, including the high bytes
+    std::map<int, int> values;
+    int delta = 1;
+    for (const auto &[bitIdx, metric] : flight->m_bit2MetricMap) {
+        values[bitIdx] = (delta % 2) ? delta : -delta;
+        if (metric.getHighByteBitIdx().has_value()) {
+            values[metric.getHighByteBitIdx().value()] = 1;
+        }
+        ++delta;
+    }
+
+    flight->updateMetrics(RecordDeltas(values));
+    mapFlight->updateMetrics(values);
+
+    EXPECT_EQ(mapFlight->m_metricValues, flight->m_metricValues);
+    EXPECT_EQ(mapFlight->m_lastUpdatedMetrics, flight->m_lastUpdatedMetrics);
+}
+
+TEST_F(FlightTest, RestoredStateDecodesLikeTheOriginal) {
+    createFlight();
+    auto first = std::map<int, int>{{0, 10}, {1, -4}, {2, 7}};
+    auto second = std::map<int, int>{{0, 3}, {2, -1}};
+
+    flight->updateMetrics(first);
+    flight->incrementSequence();
+    flight->setFastFlag(true);
+    auto saved = flight->saveState();
+
+    auto resumed = std::make_shared<Flight>(metadata);
+    resumed->restoreState(saved);
+    EXPECT_EQ(flight->m_recordSeq, resumed->m_recordSeq);
+    EXPECT_TRUE(resumed->m_fastFlag);
+
+    flight->updateMetrics(second);
+    resumed->updateMetrics(second);
+    EXPECT_EQ(flight->m_metricValues, resumed->m_metricValues);
+    EXPECT_EQ(flight->m_lastUpdatedMetrics, resumed->m_lastUpdatedMetrics);
+}
+
+TEST_F(FlightTest, SelectedMetricsDecodeLikeAFullFlight) {
+    createFlight();
+    MetricSet selection;
+    selection.insert(RPM1);
+    selection.insert(FF11);
+    auto selected = std::make_shared<Flight>(metadata, selection);
+
+    // a delta for every mapped field, including the high bytes
+    std::map<int, int> values;
+    int delta = 1;
+    for (const auto &[bitIdx, metric] : flight->m_bit2MetricMap) {
+        values[bitIdx] = delta++;
+        if (metric.getHighByteBitIdx().has_value()) {
+            values[metric.getHighByteBitIdx().value()] = 1;
+        }
+    }
+    flight->updateMetrics(values);
+    selected->updateMetrics(values);
+
+    EXPECT_EQ(2u, selected->m_metricValues.size());
+    EXPECT_EQ(selection, selected->m_lastUpdatedMetrics);
+    EXPECT_FLOAT_EQ(flight->m_metricValues[RPM1], selected->m_metricValues[RPM1]);
+    EXPECT_FLOAT_EQ(flight->m_metricValues[FF11], selected->m_metricValues[FF11]);
+    EXPECT_EQ(0u, selected->m_metricValues.count(DIF1));
+
+    // The protocol's metrics are still all supported
+    EXPECT_EQ(flight->m_supportedMetrics, selected->m_supportedMetrics);
+}
+
+TEST_F(FlightTest, SelectingDifSelectsItsEgts) {
+    createFlight();
+    MetricSet selection;
+    selection.insert(DIF1);
+    auto selected = std::make_shared<Flight>(metadata, selection);
+    ASSERT_TRUE(selected->metricSelection().has_value());
+    EXPECT_TRUE(selected->metricSelection()->contains(EGT11));
+    EXPECT_TRUE(selected->metricSelection()->contains(EGT19));
+    EXPECT_FALSE(selected->metricSelection()->contains(EGT21));
+
+    std::map<int, int> values;
+    int delta = 10;
+    for (const auto &[bitIdx, metric] : flight->m_bit2MetricMap) {
+        values[bitIdx] = delta;
+        delta += 10;
+    }
+    flight->updateMetrics(values);
+    selected->updateMetrics(values);
+
+    EXPECT_FLOAT_EQ(flight->m_metricValues[DIF1], selected->m_metricValues[DIF1]);
+    EXPECT_GT(selected->m_metricValues[DIF1], 0.0f);
+    EXPECT_EQ(0u, selected->m_metricValues.count(DIF2));
+    EXPECT_EQ(0u, selected->m_metricValues.count(RPM1));
+}
+
+TEST_F(FlightTest, UnselectedSecondEngineFieldsStillMarkATwin) {
+    metadata->m_configInfo.edm_model = 960;
+    MetricSet selection;
+    selection.insert(RPM1);
+    auto selected = std::make_shared<Flight>(metadata, selection);
+
+    int egt21BitIdx = -1;
+    for (const auto &[bitIdx, metric] : selected->m_bit2MetricMap) {
+        if (metric.getMetricId() == EGT21) {
+            egt21BitIdx = bitIdx;
+        }
+    }
+    ASSERT_GE(egt21BitIdx, 0);
+
+    selected->updateMetrics(std::map<int, int>{{egt21BitIdx, 5}});
+    EXPECT_TRUE(metadata->IsTwin());
+    EXPECT_TRUE(selected->m_lastUpdatedMetrics.empty());
+}
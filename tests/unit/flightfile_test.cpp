@@ -10,9 +10,14 @@
 #include <FlightFile.hpp>
 #include <Metadata.hpp>
 #include <Flight.hpp>
+#include <FlightIterator.hpp>
+#include <ProtocolConstants.hpp>
 #include <sstream>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace jpi_edm;
 
@@ -493,3 +498,413 @@ TEST_F(FlightFileTest, ProcessFileWithFlightIdCallsNewCodePath) {
         SUCCEED();
     }
 }
+
+// Columnar API
+TEST_F(FlightFileIntegrationTest, LoadFlightColumnsMatchesRecordCallbacks) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    std::ifstream detectStream(testFilePath, std::ios::binary);
+    FlightFile detector;
+    auto flights = detector.detectFlights(detectStream);
+    ASSERT_FALSE(flights.empty());
+    int targetFlightId = flights[flights.size() / 2].flightNumber;
+
+    // The reference: the same flight through the record callback
+    std::vector<std::shared_ptr<FlightMetricsRecord>> records;
+    FlightFile callbackParser;
+    callbackParser.setFlightRecordCompletionCb(
+        [&records](std::shared_ptr<FlightMetricsRecord> rec) { records.push_back(rec); });
+    std::ifstream callbackStream(testFilePath, std::ios::binary);
+    callbackParser.processFile(callbackStream, targetFlightId);
+    ASSERT_FALSE(records.empty());
+
+    FlightFile parser;
+    std::ifstream fileStream(testFilePath, std::ios::binary);
+    auto columns = parser.loadFlightColumns(fileStream, targetFlightId);
+
+    ASSERT_NE(nullptr, columns.m_header);
+    EXPECT_EQ(targetFlightId, static_cast<int>(columns.m_header->flight_num));
+    ASSERT_EQ(records.size(), columns.size());
+    ASSERT_EQ(records.size(), columns.m_isFast.size());
+    EXPECT_EQ(records.front()->m_metrics.ids(), columns.metrics());
+
+    for (size_t row = 0; row < records.size(); ++row) {
+        EXPECT_EQ(records[row]->m_isFast ? 1 : 0, columns.m_isFast[row]);
+        for (const auto &[id, value] : records[row]->m_metrics) {
+            ASSERT_FLOAT_EQ(value, columns.column(id)[row]) << "row " << row << " metric " << id;
+        }
+        if (row > 0) {
+            auto step = columns.m_timestamps[row] - columns.m_timestamps[row - 1];
+            EXPECT_EQ(records[row - 1]->m_isFast ? 1 : static_cast<long>(columns.m_header->interval), step);
+        }
+    }
+}
+
+TEST_F(FlightFileIntegrationTest, LoadFlightColumnsOnlyLoadsRequestedMetrics) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    FlightFile parser;
+    auto file = FlightFile::open(testFilePath);
+    auto flights = parser.detectFlights(file);
+    ASSERT_FALSE(flights.empty());
+
+    MetricSet wanted;
+    wanted.insert(EGT11);
+    wanted.insert(CHT11);
+    wanted.insert(HRS2); // not on a single engine 930
+
+    auto columns = parser.loadFlightColumns(file, flights.back().flightNumber, wanted);
+
+    EXPECT_TRUE(columns.hasColumn(EGT11));
+    EXPECT_TRUE(columns.hasColumn(CHT11));
+    EXPECT_FALSE(columns.hasColumn(HRS2));
+    EXPECT_FALSE(columns.hasColumn(OAT));
+    EXPECT_THROW((void)columns.column(OAT), std::out_of_range);
+    EXPECT_EQ(columns.size(), columns.column(EGT11).size());
+    EXPECT_EQ(columns.size(), columns.column(EGT11).capacity()) << "columns should be sized up front";
+    EXPECT_TRUE(columns.m_columns[OAT].empty());
+}
+
+TEST_F(FlightFileIntegrationTest, LoadFlightColumnsHonorsTimeWindow) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    FlightFile parser;
+    auto file = FlightFile::open(testFilePath);
+    auto flights = parser.detectFlights(file);
+    ASSERT_FALSE(flights.empty());
+    int targetFlightId = flights.back().flightNumber;
+
+    auto all = parser.loadFlightColumns(file, targetFlightId);
+    ASSERT_GT(all.size(), 10u);
+    std::time_t from = all.m_timestamps[all.size() / 4];
+    std::time_t to = all.m_timestamps[all.size() / 2];
+
+    parser.setTimeWindow(from, to);
+    auto windowed = parser.loadFlightColumns(file, targetFlightId);
+
+    size_t first = all.size() / 4;
+    ASSERT_EQ(all.size() / 2 - first, windowed.size());
+    for (size_t row = 0; row < windowed.size(); ++row) {
+        EXPECT_EQ(all.m_timestamps[first + row], windowed.m_timestamps[row]);
+        EXPECT_EQ(all.m_isFast[first + row], windowed.m_isFast[row]);
+        EXPECT_FLOAT_EQ(all.column(EGT11)[first + row], windowed.column(EGT11)[row]);
+    }
+}
+
+TEST_F(FlightFileIntegrationTest, LoadFlightColumnsUnknownFlightThrows) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    FlightFile parser;
+    auto file = FlightFile::open(testFilePath);
+    EXPECT_THROW((void)parser.loadFlightColumns(file, 999999), std::runtime_error);
+}
+
+// Flight index and parallel decoding
+TEST_F(FlightFileIntegrationTest, FlightIndexMatchesSerialParse) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    struct SerialFlight {
+        unsigned int flightNum;
+        unsigned long stdRecs;
+        unsigned long fastRecs;
+    };
+    std::vector<SerialFlight> serial;
+    FlightFile serialParser;
+    serialParser.setFlightHeaderCompletionCb(
+        [&serial](std::shared_ptr<FlightHeader> hdr) { serial.push_back({hdr->flight_num, 0, 0}); });
+    serialParser.setFlightCompletionCb([&serial](unsigned long stdRecs, unsigned long fastRecs) {
+        serial.back().stdRecs = stdRecs;
+        serial.back().fastRecs = fastRecs;
+    });
+    std::ifstream serialStream(testFilePath, std::ios::binary);
+    serialParser.processFile(serialStream);
+
+    FlightFile parser;
+    int headerCallbacks = 0;
+    parser.setFlightHeaderCompletionCb([&headerCallbacks](std::shared_ptr<FlightHeader>) { ++headerCallbacks; });
+    std::ifstream stream(testFilePath, std::ios::binary);
+    auto index = parser.buildFlightIndex(stream);
+
+    EXPECT_EQ(0, headerCallbacks);
+    ASSERT_EQ(serial.size(), index.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        ASSERT_NE(nullptr, index[i].header);
+        EXPECT_EQ(serial[i].flightNum, index[i].header->flight_num);
+        EXPECT_EQ(serial[i].stdRecs, index[i].stdRecCount) << "flight " << serial[i].flightNum;
+        EXPECT_EQ(serial[i].fastRecs, index[i].fastRecCount) << "flight " << serial[i].flightNum;
+        EXPECT_LT(index[i].headerOffset, index[i].dataOffset);
+        EXPECT_LE(index[i].dataOffset, index[i].endOffset);
+        if (i + 1 < index.size()) {
+            EXPECT_EQ(index[i].endOffset, index[i + 1].headerOffset);
+        }
+    }
+}
+
+TEST_F(FlightFileIntegrationTest, ForEachFlightParallelMatchesSerialDecode) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    std::vector<std::vector<MetricValues>> serial;
+    FlightFile serialParser;
+    serialParser.setFlightHeaderCompletionCb([&serial](std::shared_ptr<FlightHeader>) { serial.emplace_back(); });
+    serialParser.setFlightRecordCompletionCb(
+        [&serial](std::shared_ptr<FlightMetricsRecord> rec) { serial.back().push_back(rec->m_metrics); });
+    std::ifstream serialStream(testFilePath, std::ios::binary);
+    serialParser.processFile(serialStream);
+
+    FlightFile parser;
+    auto file = FlightFile::open(testFilePath);
+    auto index = parser.buildFlightIndex(file);
+    ASSERT_EQ(serial.size(), index.size());
+
+    std::vector<std::vector<MetricValues>> parallel(index.size());
+    parser.forEachFlightParallel(
+        file, index,
+        [&parallel](size_t i, const FlightView &flight) {
+            for (const auto &rec : flight) {
+                parallel[i].push_back(rec->m_metrics);
+            }
+        },
+        4);
+
+    for (size_t i = 0; i < index.size(); ++i) {
+        ASSERT_EQ(serial[i].size(), parallel[i].size()) << "flight " << index[i].flightNumber;
+        EXPECT_EQ(index[i].recordCount(), parallel[i].size());
+        for (size_t r = 0; r < serial[i].size(); ++r) {
+            ASSERT_EQ(serial[i][r], parallel[i][r]) << "flight " << index[i].flightNumber << " record " << r;
+        }
+    }
+}
+
+TEST_F(FlightFileIntegrationTest, ForEachFlightParallelRethrowsWorkerExceptions) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    FlightFile parser;
+    auto file = FlightFile::open(testFilePath);
+    EXPECT_THROW(parser.forEachFlightParallel(
+                     file, [](size_t i, const FlightView &) {
+                         if (i == 1) {
+                             throw std::logic_error("worker failure");
+                         }
+                     }),
+                 std::logic_error);
+}
+
+namespace {
+
+// Everything the callbacks saw, in order
+struct ParseEvents {
+    std::vector<std::string> events;
+    std::vector<MetricValues> records;
+
+    void attach(FlightFile &parser)
+    {
+        parser.setMetadataCompletionCb([this](std::shared_ptr<Metadata>) { events.push_back("metadata"); });
+        parser.setFlightHeaderCompletionCb([this](std::shared_ptr<FlightHeader> hdr) {
+            events.push_back("flight " + std::to_string(hdr->flight_num));
+        });
+        parser.setFlightRecordCompletionCb(
+            [this](std::shared_ptr<FlightMetricsRecord> rec) { records.push_back(rec->m_metrics); });
+        parser.setFlightCompletionCb([this](unsigned long stdRecs, unsigned long fastRecs) {
+            events.push_back("done " + std::to_string(stdRecs) + "/" + std::to_string(fastRecs));
+        });
+        parser.setFileFooterCompletionCb([this]() { events.push_back("footer"); });
+    }
+};
+
+void putLE(std::vector<uint8_t> &out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+// A zip archive holding data, stored uncompressed, as its only member
+std::vector<uint8_t> storedZip(const std::string &name, const uint8_t *data, std::size_t size)
+{
+    const auto crc = crc32(data, size);
+    const auto len = static_cast<uint32_t>(size);
+    std::vector<uint8_t> zip;
+
+    putLE(zip, 0x04034B50, 4); // local file header
+    putLE(zip, 20, 2);         // version needed
+    putLE(zip, 0, 2);          // flags
+    putLE(zip, 0, 2);          // stored
+    putLE(zip, 0, 4);          // time, date
+    putLE(zip, crc, 4);
+    putLE(zip, len, 4);
+    putLE(zip, len, 4);
+    putLE(zip, static_cast<uint32_t>(name.size()), 2);
+    putLE(zip, 0, 2); // extra length
+    zip.insert(zip.end(), name.begin(), name.end());
+    zip.insert(zip.end(), data, data + size);
+
+    const auto centralOffset = static_cast<uint32_t>(zip.size());
+    putLE(zip, 0x02014B50, 4); // central directory header
+    putLE(zip, 20, 2);         // version made by
+    putLE(zip, 20, 2);         // version needed
+    putLE(zip, 0, 2);          // flags
+    putLE(zip, 0, 2);          // stored
+    putLE(zip, 0, 4);          // time, date
+    putLE(zip, crc, 4);
+    putLE(zip, len, 4);
+    putLE(zip, len, 4);
+    putLE(zip, static_cast<uint32_t>(name.size()), 2);
+    putLE(zip, 0, 2); // extra length
+    putLE(zip, 0, 2); // comment length
+    putLE(zip, 0, 4); // disk, internal attributes
+    putLE(zip, 0, 4); // external attributes
+    putLE(zip, 0, 4); // local header offset
+    zip.insert(zip.end(), name.begin(), name.end());
+    const auto centralSize = static_cast<uint32_t>(zip.size()) - centralOffset;
+
+    putLE(zip, 0x06054B50, 4); // end of central directory
+    putLE(zip, 0, 4);          // disk numbers
+    putLE(zip, 1, 2);          // entries on this disk
+    putLE(zip, 1, 2);          // entries
+    putLE(zip, centralSize, 4);
+    putLE(zip, centralOffset, 4);
+    putLE(zip, 0, 2); // comment length
+    return zip;
+}
+
+} // namespace
+
+TEST_F(FlightFileIntegrationTest, FeedMatchesProcessFileForAnyChunkSize) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    auto file = FlightFile::open(testFilePath);
+    FlightFile serialParser;
+    ParseEvents serial;
+    serial.attach(serialParser);
+    serialParser.processFile(file);
+    ASSERT_FALSE(serial.records.empty());
+
+    for (std::size_t chunk : {std::size_t{1}, std::size_t{7}, std::size_t{4096}, file.size()}) {
+        FlightFile parser;
+        ParseEvents fed;
+        fed.attach(parser);
+        for (std::size_t pos = 0; pos < file.size(); pos += chunk) {
+            parser.feed(file.data() + pos, std::min(chunk, file.size() - pos));
+        }
+        parser.finish();
+
+        EXPECT_EQ(serial.events, fed.events) << "chunk " << chunk;
+        ASSERT_EQ(serial.records.size(), fed.records.size()) << "chunk " << chunk;
+        for (std::size_t r = 0; r < serial.records.size(); ++r) {
+            ASSERT_EQ(serial.records[r], fed.records[r]) << "chunk " << chunk << " record " << r;
+        }
+    }
+}
+
+TEST_F(FlightFileIntegrationTest, FeedOnlyKeepsUnparsedBytes) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    auto file = FlightFile::open(testFilePath);
+    FlightFile parser;
+    bool headersParsed = false;
+    parser.setMetadataCompletionCb([&headersParsed](std::shared_ptr<Metadata>) { headersParsed = true; });
+
+    std::size_t maxBacklog = 0;
+    for (std::size_t pos = 0; pos < file.size(); ++pos) {
+        parser.feed(file.data() + pos, 1);
+        if (headersParsed) {
+            maxBacklog = std::max(maxBacklog, parser.feedBacklog());
+        }
+    }
+    parser.finish();
+
+    EXPECT_TRUE(headersParsed);
+    EXPECT_LT(maxBacklog, static_cast<std::size_t>(MAX_DATA_RECORD_SIZE));
+    EXPECT_EQ(0u, parser.feedBacklog());
+}
+
+TEST_F(FlightFileIntegrationTest, FinishOnTruncatedFeedThrows) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    auto file = FlightFile::open(testFilePath);
+    FlightFile parser;
+    parser.feed(file.data(), file.size() / 2);
+    EXPECT_THROW(parser.finish(), std::runtime_error);
+
+    // The next feed() starts over
+    ParseEvents fed;
+    fed.attach(parser);
+    parser.feed(file.data(), file.size());
+    parser.finish();
+    ASSERT_FALSE(fed.events.empty());
+    EXPECT_EQ("metadata", fed.events.front());
+    EXPECT_EQ("footer", fed.events.back());
+}
+
+TEST_F(FlightFileTest, FinishWithoutInputThrows) {
+    EXPECT_THROW(flightFile.finish(), std::exception);
+}
+
+TEST_F(FlightFileIntegrationTest, ProcessCompressedFileParsesUncompressedInput) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    FlightFile serialParser;
+    ParseEvents serial;
+    serial.attach(serialParser);
+    serialParser.processFile(FlightFile::open(testFilePath));
+
+    FlightFile parser;
+    ParseEvents fed;
+    fed.attach(parser);
+    std::ifstream stream(testFilePath, std::ios::binary);
+    parser.processCompressedFile(stream);
+
+    EXPECT_EQ(serial.events, fed.events);
+    EXPECT_EQ(serial.records.size(), fed.records.size());
+}
+
+TEST_F(FlightFileIntegrationTest, ProcessZipEntryMatchesProcessFile) {
+    if (!testFileExists) {
+        GTEST_SKIP() << "Test file not available: " << testFilePath;
+    }
+
+    auto file = FlightFile::open(testFilePath);
+    FlightFile serialParser;
+    ParseEvents serial;
+    serial.attach(serialParser);
+    serialParser.processFile(file);
+    ASSERT_FALSE(serial.records.empty());
+
+    auto zip = storedZip("930_6CYL.JPI", file.data(), file.size());
+    ZipArchive archive(zip.data(), zip.size());
+    auto entries = archive.jpiEntries();
+    ASSERT_EQ(1u, entries.size());
+
+    FlightFile parser;
+    ParseEvents zipped;
+    zipped.attach(parser);
+    parser.processZipEntry(archive, entries[0]);
+
+    EXPECT_EQ(serial.events, zipped.events);
+    ASSERT_EQ(serial.records.size(), zipped.records.size());
+    for (std::size_t r = 0; r < serial.records.size(); ++r) {
+        ASSERT_EQ(serial.records[r], zipped.records[r]) << "record " << r;
+    }
+}
@@ -0,0 +1,253 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Tests for flight index sidecar files and seeking with a flight index
+ */
+
+#include <gtest/gtest.h>
+
+#include "FlightFile.hpp"
+#include "FlightIndexFile.hpp"
+#include "FlightIterator.hpp"
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace jpi_edm;
+using namespace jpi_edm::test;
+
+namespace {
+
+// A copy of a sample file in a scratch directory, so sidecars don't land in the source tree
+class ScratchCopy
+{
+  public:
+    explicit ScratchCopy(const std::string &source)
+    {
+        static int counter = 0;
+        m_dir = std::filesystem::temp_directory_path() /
+                ("jpiedm_flightindex_test_" + std::to_string(::getpid()) + "_" + std::to_string(counter++));
+        std::filesystem::create_directories(m_dir);
+        m_path = (m_dir / std::filesystem::path(source).filename()).string();
+        std::filesystem::copy_file(source, m_path, std::filesystem::copy_options::overwrite_existing);
+    }
+    ~ScratchCopy()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+
+    const std::string &path() const { return m_path; }
+
+  private:
+    std::filesystem::path m_dir;
+    std::string m_path;
+};
+
+std::vector<RecordSnapshot> parseFlight(FlightFile &parser, const MappedFile &file, int flightId)
+{
+    std::vector<RecordSnapshot> records;
+    recordInto(parser, records);
+    parser.processFile(file, flightId);
+    return records;
+}
+
+void expectSameIndex(const std::vector<FlightFile::FlightIndexEntry> &expected,
+                     const std::vector<FlightFile::FlightIndexEntry> &actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].flightNumber, actual[i].flightNumber);
+        EXPECT_EQ(expected[i].headerOffset, actual[i].headerOffset);
+        EXPECT_EQ(expected[i].dataOffset, actual[i].dataOffset);
+        EXPECT_EQ(expected[i].endOffset, actual[i].endOffset);
+        EXPECT_EQ(expected[i].stdRecCount, actual[i].stdRecCount);
+        EXPECT_EQ(expected[i].fastRecCount, actual[i].fastRecCount);
+
+        const auto &a = *expected[i].header;
+        const auto &b = *actual[i].header;
+        EXPECT_EQ(a.flight_num, b.flight_num);
+        EXPECT_EQ(a.flags, b.flags);
+        EXPECT_EQ(a.startLat, b.startLat);
+        EXPECT_EQ(a.startLng, b.startLng);
+        EXPECT_EQ(a.interval, b.interval);
+        std::tm dateA = a.startDate;
+        std::tm dateB = b.startDate;
+        EXPECT_EQ(std::mktime(&dateA), std::mktime(&dateB));
+    }
+}
+
+} // anonymous namespace
+
+TEST(FlightIndexFileTest, LoadFlightIndexWritesSidecarThatReadsBack)
+{
+    auto source = findTestFile("930_6cyl.jpi");
+    if (source.empty()) {
+        GTEST_SKIP() << "Test file not available: 930_6cyl.jpi";
+    }
+    ScratchCopy copy(source);
+    auto file = FlightFile::open(copy.path());
+
+    EXPECT_FALSE(FlightIndexFile::read(file).has_value());
+
+    FlightFile parser;
+    auto index = parser.loadFlightIndex(file);
+    EXPECT_TRUE(std::filesystem::exists(FlightIndexFile::pathFor(copy.path())));
+
+    FlightFile builder;
+    expectSameIndex(builder.buildFlightIndex(file), index);
+
+    auto reread = FlightIndexFile::read(file);
+    ASSERT_TRUE(reread.has_value());
+    expectSameIndex(index, *reread);
+}
+
+TEST(FlightIndexFileTest, StaleSidecarIsRebuilt)
+{
+    auto source = findTestFile("930_6cyl.jpi");
+    if (source.empty()) {
+        GTEST_SKIP() << "Test file not available: 930_6cyl.jpi";
+    }
+    ScratchCopy copy(source);
+    auto file = FlightFile::open(copy.path());
+
+    FlightFile parser;
+    auto index = parser.loadFlightIndex(file);
+
+    auto mtime = std::filesystem::last_write_time(copy.path());
+    std::filesystem::last_write_time(copy.path(), mtime + std::chrono::seconds(10));
+    EXPECT_FALSE(FlightIndexFile::read(file).has_value());
+
+    expectSameIndex(index, parser.loadFlightIndex(file));
+    EXPECT_TRUE(FlightIndexFile::read(file).has_value());
+}
+
+TEST(FlightIndexFileTest, DamagedSidecarIsIgnored)
+{
+    auto source = findTestFile("930_6cyl.jpi");
+    if (source.empty()) {
+        GTEST_SKIP() << "Test file not available: 930_6cyl.jpi";
+    }
+    ScratchCopy copy(source);
+    auto file = FlightFile::open(copy.path());
+
+    FlightFile parser;
+    (void)parser.loadFlightIndex(file);
+    auto sidecar = FlightIndexFile::pathFor(copy.path());
+
+    std::fstream damage(sidecar, std::ios::binary | std::ios::in | std::ios::out);
+    damage.seekp(40);
+    damage.put('\xff');
+    damage.close();
+    EXPECT_FALSE(FlightIndexFile::read(file).has_value());
+
+    std::filesystem::resize_file(sidecar, 20);
+    EXPECT_FALSE(FlightIndexFile::read(file).has_value());
+}
+
+TEST(FlightIndexFileTest, ForEachFlightParallelWorksFromSidecar)
+{
+    auto source = findTestFile("930_6cyl.jpi");
+    if (source.empty()) {
+        GTEST_SKIP() << "Test file not available: 930_6cyl.jpi";
+    }
+    ScratchCopy copy(source);
+    auto file = FlightFile::open(copy.path());
+
+    auto decodeAll = [&file](FlightFile &parser, const std::vector<FlightFile::FlightIndexEntry> &index) {
+        std::vector<std::vector<MetricValues>> flights(index.size());
+        parser.forEachFlightParallel(
+            file, index,
+            [&flights](size_t i, const FlightView &flight) {
+                for (const auto &rec : flight) {
+                    flights[i].push_back(rec->m_metrics);
+                }
+            },
+            2);
+        return flights;
+    };
+
+    FlightFile builder;
+    auto built = builder.loadFlightIndex(file);
+    auto expected = decodeAll(builder, built);
+    ASSERT_TRUE(FlightIndexFile::read(file).has_value());
+
+    // A parser that has only ever seen the sidecar
+    FlightFile parser;
+    bool metadataCalled = false;
+    parser.setMetadataCompletionCb([&metadataCalled](std::shared_ptr<Metadata>) { metadataCalled = true; });
+    auto index = parser.loadFlightIndex(file);
+    EXPECT_FALSE(metadataCalled);
+    expectSameIndex(built, index);
+
+    auto actual = decodeAll(parser, index);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        EXPECT_EQ(index[i].recordCount(), actual[i].size()) << "flight " << index[i].flightNumber;
+        EXPECT_TRUE(expected[i] == actual[i]) << "flight " << index[i].flightNumber;
+    }
+}
+
+TEST(FlightIndexFileTest, SeekingWithIndexMatchesSkipping)
+{
+    for (const auto &name : TEST_FILES) {
+        auto source = findTestFile(name);
+        if (source.empty()) {
+            continue;
+        }
+        SCOPED_TRACE(name);
+        ScratchCopy copy(source);
+        auto file = FlightFile::open(copy.path());
+
+        FlightFile skipping;
+        FlightFile seeking;
+        auto index = seeking.loadFlightIndex(file);
+
+        // The first flight, one from the middle, and the last
+        ASSERT_FALSE(index.empty());
+        for (size_t i : {size_t{0}, index.size() / 2, index.size() - 1}) {
+            const auto &entry = index[i];
+            auto expected = parseFlight(skipping, file, entry.flightNumber);
+            auto actual = parseFlight(seeking, file, entry.flightNumber);
+            ASSERT_EQ(expected.size(), actual.size()) << "flight " << entry.flightNumber;
+            EXPECT_TRUE(expected == actual) << "flight " << entry.flightNumber;
+
+            auto expectedCols = skipping.loadFlightColumns(file, entry.flightNumber);
+            auto actualCols = seeking.loadFlightColumns(file, entry.flightNumber);
+            EXPECT_EQ(expectedCols.m_timestamps, actualCols.m_timestamps);
+            EXPECT_EQ(expectedCols.m_columns, actualCols.m_columns);
+        }
+    }
+}
+
+TEST(FlightIndexFileTest, IndexForAnotherFileIsNotUsed)
+{
+    auto source = findTestFile("930_6cyl.jpi");
+    auto other = findTestFile("830_6cyl.jpi");
+    if (source.empty() || other.empty()) {
+        GTEST_SKIP() << "Test files not available";
+    }
+    auto file = FlightFile::open(source);
+    auto otherFile = FlightFile::open(other);
+
+    FlightFile plain;
+    FlightFile seeking;
+    seeking.setFlightIndex(plain.buildFlightIndex(otherFile));
+
+    auto index = plain.buildFlightIndex(file);
+    ASSERT_FALSE(index.empty());
+    int flightId = index.back().flightNumber;
+    EXPECT_TRUE(parseFlight(plain, file, flightId) == parseFlight(seeking, file, flightId));
+}
@@ -0,0 +1,305 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Tests for memory-mapped input and the byte sources the parser reads from
+ */
+
+#include <gtest/gtest.h>
+
+#include "ByteSource.hpp"
+#include "FlightFile.hpp"
+#include "FlightIterator.hpp"
+#include "MappedFile.hpp"
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace jpi_edm;
+using namespace jpi_edm::test;
+
+namespace {
+
+
+class TempFile
+{
+  public:
+    explicit TempFile(const std::string &contents)
+    {
+        static int counter = 0;
+        m_path = (std::filesystem::temp_directory_path() /
+                  ("jpiedm_mappedfile_test_" + std::to_string(::getpid()) + "_" + std::to_string(counter++)))
+                     .string();
+        std::ofstream out(m_path, std::ios::binary);
+        out << contents;
+    }
+    ~TempFile() { std::remove(m_path.c_str()); }
+
+    const std::string &path() const { return m_path; }
+
+  private:
+    std::string m_path;
+};
+
+} // anonymous namespace
+
+// =============================================================================
+// MappedFile
+// =============================================================================
+
+TEST(MappedFileTest, MapsFileContents)
+{
+    TempFile tmp("$U,N12345*44\r\n");
+    auto file = FlightFile::open(tmp.path());
+
+    ASSERT_EQ(14u, file.size());
+    EXPECT_EQ(0, std::string(reinterpret_cast<const char *>(file.data()), file.size()).compare("$U,N12345*44\r\n"));
+}
+
+TEST(MappedFileTest, EmptyFileMapsToEmptySpan)
+{
+    TempFile tmp("");
+    auto file = FlightFile::open(tmp.path());
+
+    EXPECT_EQ(0u, file.size());
+    EXPECT_EQ(nullptr, file.data());
+}
+
+TEST(MappedFileTest, ThrowsForMissingFile)
+{
+    EXPECT_THROW(FlightFile::open("/nonexistent/file.jpi"), std::runtime_error);
+}
+
+TEST(MappedFileTest, MoveTransfersMapping)
+{
+    TempFile tmp("abc");
+    auto file = FlightFile::open(tmp.path());
+    const uint8_t *data = file.data();
+
+    MappedFile moved(std::move(file));
+    EXPECT_EQ(data, moved.data());
+    EXPECT_EQ(3u, moved.size());
+    EXPECT_EQ(nullptr, file.data());
+    EXPECT_EQ(0u, file.size());
+}
+
+TEST(MappedFileTest, EmptyMappingIsRejectedByParser)
+{
+    TempFile tmp("");
+    auto file = FlightFile::open(tmp.path());
+
+    FlightFile parser;
+    EXPECT_THROW(parser.processFile(file), std::runtime_error);
+}
+
+// =============================================================================
+// ByteSource
+// =============================================================================
+
+TEST(ByteSourceTest, MemorySourcePeeksWithoutConsuming)
+{
+    const std::vector<uint8_t> data = {1, 2, 3, 4, 5};
+    MemoryByteSource src(data.data(), data.size());
+
+    auto reader = src.peek(3);
+    EXPECT_EQ(3u, reader.size());
+    EXPECT_EQ(data.data(), reader.data());
+    EXPECT_EQ(0, src.tell());
+
+    src.consume(2);
+    EXPECT_EQ(2, src.tell());
+    EXPECT_EQ(3, src.peek(1).readU8());
+}
+
+TEST(ByteSourceTest, MemorySourcePeekIsShortAtEnd)
+{
+    const std::vector<uint8_t> data = {1, 2, 3};
+    MemoryByteSource src(data.data(), data.size());
+
+    src.seek(2);
+    EXPECT_EQ(1u, src.peek(10).size());
+    src.seek(10);
+    EXPECT_EQ(0u, src.peek(10).size());
+    EXPECT_EQ(10, src.tell());
+}
+
+TEST(ByteSourceTest, StreamSourceMatchesStreamContents)
+{
+    std::string contents;
+    for (int i = 0; i < 200000; ++i) {
+        contents.push_back(static_cast<char>(i % 251));
+    }
+    std::istringstream stream(contents);
+    StreamByteSource src(stream);
+
+    // Read across several buffer refills
+    std::streamoff pos = 0;
+    while (pos < static_cast<std::streamoff>(contents.size())) {
+        auto reader = src.peek(157);
+        ASSERT_GT(reader.size(), 0u);
+        EXPECT_EQ(static_cast<uint8_t>(contents[pos]), reader.data()[0]);
+        src.consume(reader.size());
+        pos += reader.size();
+        EXPECT_EQ(pos, src.tell());
+    }
+    EXPECT_EQ(0u, src.peek(1).size());
+
+    // Seek backwards, outside the current buffer
+    src.seek(1000);
+    EXPECT_EQ(static_cast<uint8_t>(contents[1000]), src.peek(1).readU8());
+}
+
+TEST(ByteSourceTest, StreamSourceRestoresStreamPosition)
+{
+    std::istringstream stream("0123456789");
+    {
+        StreamByteSource src(stream);
+        src.consume(4);
+        (void)src.peek(4);
+    }
+    EXPECT_EQ(4, stream.tellg());
+    EXPECT_EQ('4', stream.get());
+}
+
+// =============================================================================
+// Mapped vs. stream parsing
+// =============================================================================
+
+class MappedFileIntegrationTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        for (const auto &filename : TEST_FILES) {
+            std::string path = findTestFile(filename);
+            if (!path.empty()) {
+                availableFiles[filename] = path;
+            }
+        }
+    }
+
+    std::map<std::string, std::string> availableFiles;
+};
+
+TEST_F(MappedFileIntegrationTest, MappedRecordsMatchStreamRecords)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto &[filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        std::vector<RecordSnapshot> streamRecords;
+        FlightFile streamParser;
+        recordInto(streamParser, streamRecords);
+        std::ifstream stream(filepath, std::ios::binary);
+        streamParser.processFile(stream);
+
+        std::vector<RecordSnapshot> mappedRecords;
+        FlightFile mappedParser;
+        recordInto(mappedParser, mappedRecords);
+        auto file = FlightFile::open(filepath);
+        mappedParser.processFile(file);
+
+        ASSERT_FALSE(streamRecords.empty());
+        EXPECT_TRUE(streamRecords == mappedRecords);
+    }
+}
+
+TEST_F(MappedFileIntegrationTest, MappedSingleFlightMatchesStream)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto &[filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        auto file = FlightFile::open(filepath);
+        FlightFile detector;
+        auto flights = detector.detectFlights(file);
+        ASSERT_FALSE(flights.empty());
+        int flightId = flights.back().flightNumber;
+
+        std::vector<RecordSnapshot> streamRecords;
+        FlightFile streamParser;
+        recordInto(streamParser, streamRecords);
+        std::ifstream stream(filepath, std::ios::binary);
+        streamParser.processFile(stream, flightId);
+
+        std::vector<RecordSnapshot> mappedRecords;
+        FlightFile mappedParser;
+        recordInto(mappedParser, mappedRecords);
+        mappedParser.processFile(file, flightId);
+
+        EXPECT_TRUE(streamRecords == mappedRecords);
+    }
+}
+
+TEST_F(MappedFileIntegrationTest, MappedDetectFlightsMatchesStream)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto &[filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        FlightFile parser;
+        std::ifstream stream(filepath, std::ios::binary);
+        auto streamFlights = parser.detectFlights(stream);
+
+        auto file = FlightFile::open(filepath);
+        std::shared_ptr<Metadata> metadata;
+        auto mappedFlights = parser.detectFlights(file, metadata);
+
+        ASSERT_NE(nullptr, metadata);
+        ASSERT_EQ(streamFlights.size(), mappedFlights.size());
+        for (size_t i = 0; i < streamFlights.size(); ++i) {
+            EXPECT_EQ(streamFlights[i].flightNumber, mappedFlights[i].flightNumber);
+            EXPECT_EQ(streamFlights[i].recordCount, mappedFlights[i].recordCount);
+        }
+    }
+}
+
+TEST_F(MappedFileIntegrationTest, MappedIteratorMatchesStreamIterator)
+{
+    if (availableFiles.empty()) {
+        GTEST_SKIP() << "No test files available";
+    }
+
+    for (const auto &[filename, filepath] : availableFiles) {
+        SCOPED_TRACE(filename);
+
+        std::vector<std::pair<int, unsigned long>> streamFlights;
+        FlightFile streamParser;
+        std::ifstream stream(filepath, std::ios::binary);
+        for (const auto &flight : streamParser.flights(stream)) {
+            streamFlights.emplace_back(flight.getHeader().flight_num, flight.getTotalRecordCount());
+        }
+
+        std::vector<std::pair<int, unsigned long>> mappedFlights;
+        FlightFile mappedParser;
+        auto file = FlightFile::open(filepath);
+        for (const auto &flight : mappedParser.flights(file)) {
+            mappedFlights.emplace_back(flight.getHeader().flight_num, flight.getTotalRecordCount());
+        }
+
+        EXPECT_EQ(streamFlights, mappedFlights);
+    }
+}
@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 #include <Metadata.hpp>
+#include <ProtocolConstants.hpp>
 #include <sstream>
 
 using namespace jpi_edm;
@@ -107,6 +108,15 @@ TEST_F(MetadataTest, IsOldRecFormatReturnsFalseForV4) {
     EXPECT_FALSE(metadata.IsOldRecFormat());
 }
 
+TEST_F(MetadataTest, RecordMaskSizeIsOneByteForOldRecFormat) {
+    metadata.m_configInfo.edm_model = 760;
+    EXPECT_EQ(OLD_RECORD_MASK_SIZE, metadata.RecordMaskSize());
+
+    metadata.m_configInfo.edm_model = 930;
+    metadata.m_configInfo.firmware_version = 200;
+    EXPECT_EQ(RECORD_MASK_SIZE, metadata.RecordMaskSize());
+}
+
 // Test GuessFlightHeaderVersion()
 TEST_F(MetadataTest, GuessFlightHeaderVersionReturnsV1ForOldModel) {
     metadata.m_configInfo.edm_model = 800;
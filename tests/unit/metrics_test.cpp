@@ -116,3 +116,50 @@ TEST(MetricIdTest, MetricIdEnumValues) {
     EXPECT_NE(MetricId::TIT11, MetricId::TIT12);
     EXPECT_NE(MetricId::RPM1, MetricId::MAP1);
 }
+
+// Test the per-version lookup tables
+TEST(MetricsTest, BitToMetricMapIsSharedPerVersion) {
+    const auto &first = Metrics::getBitToMetricMap(EDMVersion::V4);
+    const auto &second = Metrics::getBitToMetricMap(EDMVersion::V4);
+    EXPECT_EQ(&first, &second);
+    EXPECT_NE(&first, &Metrics::getBitToMetricMap(EDMVersion::V1));
+}
+
+TEST(MetricsTest, DecodeTableMatchesBitToMetricMap) {
+    for (auto version : {EDMVersion::V1, EDMVersion::V2, EDMVersion::V3, EDMVersion::V4, EDMVersion::V5}) {
+        const auto &bitMap = Metrics::getBitToMetricMap(version);
+        const auto &table = Metrics::getDecodeTable(version);
+
+        for (int bitIdx = 0; bitIdx < MAX_METRIC_FIELDS; ++bitIdx) {
+            const auto &entry = table[bitIdx];
+            auto it = bitMap.find(bitIdx);
+            ASSERT_EQ(it != bitMap.end(), entry.isValid) << "version " << version << " bit " << bitIdx;
+            if (!entry.isValid) {
+                continue;
+            }
+
+            const Metric &metric = it->second;
+            EXPECT_EQ(metric.getMetricId(), entry.metricId);
+            EXPECT_EQ(metric.getHighByteBitIdx().value_or(-1), entry.highByteBitIdx);
+            EXPECT_EQ(metric.getMetricId() == LAT || metric.getMetricId() == LNG, entry.isGps);
+
+            float lphDivisor = metric.getScaleFactor() == Metric::ScaleFactor::TEN ? 10.0f : 1.0f;
+            float gphDivisor = metric.getScaleFactor() == Metric::ScaleFactor::NONE ? 1.0f : 10.0f;
+            EXPECT_FLOAT_EQ(lphDivisor, entry.scaleDivisor[0]);
+            EXPECT_FLOAT_EQ(gphDivisor, entry.scaleDivisor[1]);
+        }
+    }
+}
+
+TEST(MetricsTest, DecodeTableFlagsSecondEngineMetrics) {
+    EXPECT_TRUE(Metrics::isSecondEngineMetric(EGT21));
+    EXPECT_TRUE(Metrics::isSecondEngineMetric(RPM2));
+    EXPECT_FALSE(Metrics::isSecondEngineMetric(EGT11));
+
+    const auto &table = Metrics::getDecodeTable(EDMVersion::V5);
+    for (const auto &entry : table) {
+        if (entry.isValid) {
+            EXPECT_EQ(Metrics::isSecondEngineMetric(entry.metricId), entry.isSecondEngine);
+        }
+    }
+}
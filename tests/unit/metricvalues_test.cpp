@@ -0,0 +1,102 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * Unit tests for MetricValues and MetricSet
+ */
+
+#include <gtest/gtest.h>
+#include <MetricValues.hpp>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace jpi_edm;
+
+TEST(MetricSetTest, InsertCountAndErase) {
+    MetricSet ids;
+    EXPECT_TRUE(ids.empty());
+
+    ids.insert(EGT11);
+    ids.insert(DIF2);
+    ids.insert(EGT11);
+
+    EXPECT_EQ(2u, ids.size());
+    EXPECT_EQ(1u, ids.count(EGT11));
+    EXPECT_EQ(0u, ids.count(CHT11));
+    EXPECT_TRUE(ids.contains(DIF2));
+
+    ids.erase(EGT11);
+    EXPECT_EQ(1u, ids.size());
+    EXPECT_FALSE(ids.contains(EGT11));
+}
+
+TEST(MetricSetTest, IteratesInMetricIdOrder) {
+    MetricSet ids(std::set<MetricId>{LNG, EGT11, RPM1});
+
+    std::vector<MetricId> seen(ids.begin(), ids.end());
+    EXPECT_EQ((std::vector<MetricId>{EGT11, RPM1, LNG}), seen);
+    EXPECT_EQ((std::set<MetricId>{EGT11, RPM1, LNG}), ids.toSet());
+}
+
+TEST(MetricValuesTest, SubscriptAddsMissingMetricAsZero) {
+    MetricValues values;
+
+    EXPECT_FLOAT_EQ(0.0f, values[OAT]);
+    EXPECT_EQ(1u, values.size());
+
+    values[OAT] += 12.5f;
+    EXPECT_FLOAT_EQ(12.5f, values.at(OAT));
+}
+
+TEST(MetricValuesTest, FindAndCountBehaveLikeMap) {
+    MetricValues values;
+    values[EGT11] = 1450.0f;
+
+    auto it = values.find(EGT11);
+    ASSERT_NE(values.end(), it);
+    EXPECT_EQ(EGT11, it->first);
+    EXPECT_FLOAT_EQ(1450.0f, it->second);
+
+    EXPECT_EQ(values.end(), values.find(CHT11));
+    EXPECT_EQ(0u, values.count(CHT11));
+    EXPECT_FLOAT_EQ(-1.0f, values.get(CHT11, -1.0f));
+    EXPECT_THROW((void)values.at(CHT11), std::out_of_range);
+}
+
+TEST(MetricValuesTest, ErasedMetricIsReinitializedToZero) {
+    MetricValues values;
+    values[RPM1] = 2500.0f;
+    values.erase(RPM1);
+
+    EXPECT_TRUE(values.empty());
+    EXPECT_FLOAT_EQ(0.0f, values[RPM1]);
+}
+
+TEST(MetricValuesTest, RoundTripsThroughMap) {
+    std::map<MetricId, float> metrics{{EGT11, 1450.0f}, {CHT11, 380.0f}, {DIF1, 25.0f}};
+    MetricValues values(metrics);
+
+    EXPECT_EQ(metrics.size(), values.size());
+    EXPECT_EQ(metrics, values.toMap());
+
+    std::map<MetricId, float> iterated;
+    for (const auto &[id, value] : values) {
+        iterated[id] = value;
+    }
+    EXPECT_EQ(metrics, iterated);
+}
+
+TEST(MetricValuesTest, EqualityIgnoresAbsentSlots) {
+    MetricValues a;
+    MetricValues b;
+    a[EGT11] = 1.0f;
+    b[EGT12] = 5.0f;
+    b.erase(EGT12);
+    b[EGT11] = 1.0f;
+
+    EXPECT_TRUE(a == b);
+    b[EGT11] = 2.0f;
+    EXPECT_TRUE(a != b);
+}
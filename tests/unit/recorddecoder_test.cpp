@@ -0,0 +1,175 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * Unit tests for the data record decoders and framers
+ */
+
+#include <gtest/gtest.h>
+#include <BitOps.hpp>
+#include <RecordDecoder.hpp>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using namespace jpi_edm;
+
+namespace {
+
+// Packs signed field values into a data record with maskSize byte population maps
+std::vector<uint8_t> encodeRecord(const std::map<int, int> &values, int maskSize)
+{
+    uint8_t fieldBytes[16]{};
+    uint8_t signBytes[16]{};
+    unsigned popMap = 0;
+    for (const auto &[fieldIdx, value] : values) {
+        int byteIdx = fieldIdx / 8;
+        fieldBytes[byteIdx] |= static_cast<uint8_t>(1 << (fieldIdx % 8));
+        if (value < 0) {
+            signBytes[byteIdx] |= static_cast<uint8_t>(1 << (fieldIdx % 8));
+        }
+        popMap |= 1U << byteIdx;
+    }
+
+    std::vector<uint8_t> bytes;
+    for (int copy = 0; copy < 2; ++copy) {
+        if (maskSize == 2) {
+            bytes.push_back(static_cast<uint8_t>(popMap >> 8));
+        }
+        bytes.push_back(static_cast<uint8_t>(popMap));
+    }
+    bytes.push_back(0); // repeat count
+    for (int i = 0; i < maskSize * 8; ++i) {
+        if (popMap & (1U << i)) {
+            bytes.push_back(fieldBytes[i]);
+        }
+    }
+    for (int i = 0; i < maskSize * 8; ++i) {
+        if ((popMap & (1U << i)) && i != 6 && i != 7) {
+            bytes.push_back(signBytes[i]);
+        }
+    }
+    for (const auto &[fieldIdx, value] : values) {
+        bytes.push_back(static_cast<uint8_t>(value < 0 ? -value : value));
+    }
+    uint8_t sum = 0;
+    for (auto byte : bytes) {
+        sum = static_cast<uint8_t>(sum + byte);
+    }
+    bytes.push_back(static_cast<uint8_t>(-sum));
+    return bytes;
+}
+
+// Fields from the first eight map bytes only, so both layouts can carry them.
+// Field 48 is the high byte of the first EGT, which has no sign byte.
+const std::map<int, int> LOW_FIELDS = {{0, 12}, {8, -3}, {16, 2}, {17, -40}, {41, 200}, {48, 1}};
+
+} // namespace
+
+TEST(RecordDecoderTest, BothLayoutsDecodeTheSameValues) {
+    auto oldRecord = encodeRecord(LOW_FIELDS, OLD_RECORD_MASK_SIZE);
+    auto newRecord = encodeRecord(LOW_FIELDS, RECORD_MASK_SIZE);
+    EXPECT_EQ(newRecord.size(), oldRecord.size() + 2);
+
+    RecordDeltas oldValues;
+    auto oldResult = decodeRecord<OLD_RECORD_MASK_SIZE>(oldRecord.data(), oldRecord.size(), 1, oldValues);
+    RecordDeltas newValues;
+    auto newResult = decodeRecord<RECORD_MASK_SIZE>(newRecord.data(), newRecord.size(), 1, newValues);
+
+    EXPECT_EQ(oldRecord.size(), oldResult.length);
+    EXPECT_EQ(newRecord.size(), newResult.length);
+    EXPECT_TRUE(oldResult.popMapsMatch && oldResult.checksumOk);
+    EXPECT_TRUE(newResult.popMapsMatch && newResult.checksumOk);
+
+    EXPECT_EQ(LOW_FIELDS.size(), oldValues.size());
+    EXPECT_EQ(oldValues.present(), newValues.present());
+    for (const auto &[fieldIdx, value] : LOW_FIELDS) {
+        EXPECT_EQ(value, oldValues[fieldIdx]) << "field " << fieldIdx;
+        EXPECT_EQ(value, newValues[fieldIdx]) << "field " << fieldIdx;
+    }
+}
+
+TEST(RecordDecoderTest, FieldsInBothWordsOfTheMaps) {
+    // The first and last fields of each 64 bit half. 55 and 63 are in EGT high
+    // bytes, which are never negative.
+    const std::map<int, int> fields = {{0, -1}, {55, 3}, {63, 255}, {64, 7}, {102, -9}, {103, 1}, {127, 128}};
+    auto record = encodeRecord(fields, RECORD_MASK_SIZE);
+
+    RecordDeltas values;
+    auto result = decodeRecord<RECORD_MASK_SIZE>(record.data(), record.size(), 1, values);
+    EXPECT_EQ(record.size(), result.length);
+    EXPECT_TRUE(result.checksumOk);
+    EXPECT_EQ(fields.size(), values.size());
+    for (const auto &[fieldIdx, value] : fields) {
+        EXPECT_EQ(value, values[fieldIdx]) << "field " << fieldIdx;
+    }
+}
+
+TEST(RecordDecoderTest, OneBytePopulationMaps) {
+    // Both population maps say field byte 0; field 1 is present, negative, and 7
+    const std::vector<uint8_t> record = {0x01, 0x01, 0x00, 0x02, 0x02, 0x07, 0xF3};
+
+    RecordDeltas values;
+    auto result = decodeRecord<OLD_RECORD_MASK_SIZE>(record.data(), record.size(), 1, values);
+    EXPECT_EQ(record.size(), result.length);
+    EXPECT_TRUE(result.checksumOk);
+    ASSERT_EQ(1u, values.size());
+    EXPECT_EQ(-7, values[1]);
+}
+
+TEST(RecordDecoderTest, FramingMatchesDecoding) {
+    for (int maskSize : {OLD_RECORD_MASK_SIZE, RECORD_MASK_SIZE}) {
+        const RecordCodec &codec = recordCodec(maskSize);
+        EXPECT_EQ(maskSize, codec.maskSize);
+
+        auto record = encodeRecord(LOW_FIELDS, maskSize);
+        RecordDeltas values;
+        auto decoded = codec.decode(record.data(), record.size(), 1, values);
+        auto frame = codec.frame(record.data(), record.size());
+        ASSERT_TRUE(frame.has_value());
+        EXPECT_EQ(decoded.length, frame->length);
+        EXPECT_EQ(2, frame->mark);
+
+        EXPECT_FALSE(codec.frame(record.data(), record.size() - 1).has_value());
+    }
+}
+
+TEST(RecordDecoderTest, ReportsMismatchedMapsAndChecksums) {
+    auto record = encodeRecord(LOW_FIELDS, OLD_RECORD_MASK_SIZE);
+    record[1] ^= 0x80; // the second population map, which isn't used
+    RecordDeltas values;
+    auto result = decodeRecord<OLD_RECORD_MASK_SIZE>(record.data(), record.size(), 1, values);
+    EXPECT_FALSE(result.popMapsMatch);
+    EXPECT_FALSE(result.checksumOk);
+    EXPECT_EQ(LOW_FIELDS.size(), values.size());
+}
+
+TEST(RecordDecoderTest, TruncatedRecordThrows) {
+    auto record = encodeRecord(LOW_FIELDS, RECORD_MASK_SIZE);
+    RecordDeltas values;
+    EXPECT_THROW(decodeRecord<RECORD_MASK_SIZE>(record.data(), record.size() - 1, 1, values), std::runtime_error);
+    EXPECT_THROW(decodeRecord<RECORD_MASK_SIZE>(record.data(), 3, 1, values), std::runtime_error);
+}
+
+TEST(RecordDecoderTest, OnlyOneAndTwoByteMapsHaveCodecs) {
+    EXPECT_THROW((void)recordCodec(0), std::runtime_error);
+    EXPECT_THROW((void)recordCodec(3), std::runtime_error);
+}
+
+TEST(BitOpsTest, ForEachSetBitVisitsBitsInOrder) {
+    std::vector<int> seen;
+    forEachSetBit(uint64_t{0x8000000000000005ULL}, [&seen](int bitIdx) { seen.push_back(bitIdx); });
+    EXPECT_EQ((std::vector<int>{0, 2, 63}), seen);
+
+    std::bitset<128> bits;
+    for (int bitIdx : {1, 63, 64, 100, 127}) {
+        bits.set(bitIdx);
+    }
+    seen.clear();
+    forEachSetBit(bits, [&seen](int bitIdx) { seen.push_back(bitIdx); });
+    EXPECT_EQ((std::vector<int>{1, 63, 64, 100, 127}), seen);
+
+    EXPECT_EQ(5, popCount(0x8000000000000F00ULL));
+    EXPECT_EQ(8, countTrailingZeros(0x8000000000000F00ULL));
+}
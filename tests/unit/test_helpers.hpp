@@ -0,0 +1,70 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-NC-4.0
+ *
+ * @brief Helpers shared by the unit tests that parse the sample files in tests/it
+ */
+
+#pragma once
+
+#include "FlightFile.hpp"
+#include "MetricValues.hpp"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jpi_edm::test {
+
+// Find a sample file in tests/it, from whichever directory the tests run in.
+// Returns "" if it isn't there.
+inline std::string findTestFile(const std::string &filename)
+{
+    std::vector<std::string> possiblePaths = {
+        filename,
+        "tests/it/" + filename,
+        "../tests/it/" + filename,
+        "../../tests/it/" + filename,
+        "../../../tests/it/" + filename,
+        "../../../../tests/it/" + filename,
+    };
+
+    for (const auto &path : possiblePaths) {
+        std::ifstream testFile(path, std::ios::binary);
+        if (testFile.good()) {
+            return path;
+        }
+    }
+    return "";
+}
+
+// The sample files that parse cleanly
+inline const std::vector<std::string> TEST_FILES = {
+    "830_6cyl.jpi",
+    "930_6cyl.jpi",
+    "930_6cyl_turbo.jpi",
+    "960_4cyl_twin.jpi",
+};
+
+// What a record callback saw, kept after the parser reuses the record
+struct RecordSnapshot {
+    unsigned long recordSeq;
+    bool isFast;
+    MetricValues metrics;
+
+    bool operator==(const RecordSnapshot &other) const
+    {
+        return recordSeq == other.recordSeq && isFast == other.isFast && metrics == other.metrics;
+    }
+};
+
+// Append a snapshot of every record parser decodes to records
+inline void recordInto(FlightFile &parser, std::vector<RecordSnapshot> &records)
+{
+    parser.setFlightRecordCompletionCb([&records](std::shared_ptr<FlightMetricsRecord> rec) {
+        records.push_back(RecordSnapshot{rec->m_recordSeq, rec->m_isFast, rec->m_metrics});
+    });
+}
+
+} // namespace jpi_edm::test